@@ -0,0 +1,38 @@
+#include <chrono>
+#include <iostream>
+
+#include <fl/memory/epoch.h>
+
+namespace
+{
+  auto per_op(std::chrono::steady_clock::duration d, int count) -> double {
+    return std::chrono::duration<double, std::nano>(d).count() / count;
+  }
+
+  void epoch_retire_and_reclaim() {
+    constexpr auto count = 1'000'000;
+    fl::epoch::synchronize();
+    auto const start = std::chrono::steady_clock::now();
+    for(auto i = 0; i < count; ++i)
+      fl::epoch::retire(new int(i), [](void* p) { delete static_cast<int*>(p); });
+    auto const retired = std::chrono::steady_clock::now();
+    fl::epoch::synchronize();
+    auto const reclaimed = std::chrono::steady_clock::now();
+    std::cout << "epoch retire: " << per_op(retired - start, count) << " ns/op, "
+              << "reclaim: " << per_op(reclaimed - retired, count) << " ns/op\n";
+  }
+
+  void epoch_guard() {
+    constexpr auto count = 10'000'000;
+    auto const start = std::chrono::steady_clock::now();
+    for(auto i = 0; i < count; ++i)
+      auto const g = fl::epoch::guard();
+    std::cout << "epoch guard: " << per_op(std::chrono::steady_clock::now() - start, count) << " ns/op\n";
+  }
+} // namespace
+
+auto main() -> int {
+  epoch_retire_and_reclaim();
+  epoch_guard();
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <fl/platform/crash.h>
+#include <fl/platform/stacktrace.h>
+
+auto main(int argc, char** argv) -> int {
+  if(argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <report.flcrash> [debug-directory...]\n";
+    return 2;
+  }
+  auto file = std::ifstream(argv[1], std::ios::binary);
+  if(not file) {
+    std::cerr << "failed to open " << argv[1] << "\n";
+    return 1;
+  }
+  auto bytes = std::vector<std::byte>();
+  for(auto it = std::istreambuf_iterator<char>(file); it != std::istreambuf_iterator<char>(); ++it)
+    bytes.push_back(static_cast<std::byte>(*it));
+  auto const report = fl::platform::crash_report::parse(bytes);
+  if(not report) {
+    std::cerr << argv[1] << " is not a crash report\n";
+    return 1;
+  }
+  auto symbolizer = fl::platform::offline_symbolizer(report->modules, std::vector<std::string>(argv + 2, argv + argc));
+  std::cout << fl::platform::to_string(*report, symbolizer.symbolize(report->frames));
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fl/platform/stacktrace.h>
+
+namespace
+{
+  auto parse_address(std::string_view text, fl::uptr& address) -> bool {
+    if(text.starts_with("0x") or text.starts_with("0X"))
+      text.remove_prefix(2);
+    auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), address, 16);
+    return error == std::errc() and end == text.data() + text.size();
+  }
+
+  auto read_records(std::istream& input, std::string_view name, std::vector<fl::platform::module_address>& records) -> bool {
+    auto valid = true;
+    auto line = std::string();
+    for(auto number = 1; std::getline(input, line); ++number) {
+      if(line.empty() or line.starts_with('#'))
+        continue;
+      auto fields = std::istringstream(line);
+      auto id = std::string();
+      auto address = std::string();
+      auto record = fl::platform::module_address();
+      fields >> id >> address >> record.path;
+      auto const parsed = fl::platform::build_id::parse(id);
+      if(not parsed or not parse_address(address, record.address)) {
+        std::cerr << name << ":" << number << ": expected '<build-id> <hex address> [path]'\n";
+        valid = false;
+        continue;
+      }
+      record.id = *parsed;
+      records.push_back(std::move(record));
+    }
+    return valid;
+  }
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+  auto debug_directories = std::vector<std::string>();
+  auto inputs = std::vector<std::string>();
+  for(auto i = 1; i < argc; ++i) {
+    auto const argument = std::string_view(argv[i]);
+    if(argument == "-d" and i + 1 < argc)
+      debug_directories.emplace_back(argv[++i]);
+    else if(argument == "-h" or argument == "--help") {
+      std::cout << "usage: " << argv[0] << " [-d debug-directory]... [records-file]...\n"
+                << "reads '<build-id> <hex address> [path]' records from the files or the standard input\n";
+      return 0;
+    } else
+      inputs.emplace_back(argument);
+  }
+
+  auto records = std::vector<fl::platform::module_address>();
+  auto valid = true;
+  if(inputs.empty())
+    valid = read_records(std::cin, "<stdin>", records);
+  for(auto const& input : inputs) {
+    auto file = std::ifstream(input);
+    if(not file) {
+      std::cerr << "failed to open " << input << "\n";
+      return 1;
+    }
+    valid = read_records(file, input, records) and valid;
+  }
+  std::cout << fl::platform::to_string(fl::platform::symbolize_offline(records, std::move(debug_directories)));
+  return valid ? 0 : 1;
+}
\ No newline at end of file
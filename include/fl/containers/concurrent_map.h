@@ -0,0 +1,395 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "../concepts/threading.h"
+#include "../memory/cache_padded.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  /**
+   * @brief Concurrent hash map, split into independently locked shards.
+   * @details Every key is mapped to one of <i>N</i> shards by its hash. Each shard is an
+   * open-addressing hash table with linear probing and backward-shift deletion, protected by its own
+   * reader-writer lock. Operations on keys from different shards never contend; lookups in the same
+   * shard proceed in parallel under a shared lock.
+   *
+   * The map never hands out references to stored values: lookups return copies, and in-place
+   * modifications are done through visitors that run while the shard lock is held.
+   * Visitors must not access the same map, otherwise they may deadlock.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto map = fl::concurrent_map<std::string, int>();
+   *    map.insert_or_assign("requests", 0);
+   *    map.visit("requests", [](int& value) { ++value; });  // exclusive access
+   *    auto const value = map.find("requests");             // std::optional<int>(1)
+   *    map.erase("requests");
+   * @endcode
+   * @tparam K Key type.
+   * @tparam V Value type.
+   * @tparam Hash Hash function type.
+   * @tparam KeyEqual Key equality comparator type.
+   * @tparam Mutex Lock type of a single shard. Must satisfy @ref concepts::shared_mutex.
+   */
+  template <
+    typename K,
+    typename V,
+    typename Hash = std::hash<K>,
+    typename KeyEqual = std::equal_to<K>,
+    concepts::shared_mutex Mutex = std::shared_mutex
+  >
+  class concurrent_map : pin
+  {
+   public:
+    using key_type = K;
+    using mapped_type = V;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using mutex_type = Mutex;
+
+    /**
+     * @brief Creates an empty map.
+     * @param shards Number of shards. Rounded up to a power of two. Defaults to four shards per hardware thread.
+     * @param hash Hash function.
+     * @param equal Key equality comparator.
+     */
+    explicit concurrent_map(
+      usize shards = default_shard_count(),
+      Hash hash = Hash(),
+      KeyEqual equal = KeyEqual()
+    )
+      : shard_count_(std::bit_ceil(std::max(shards, usize(1))))
+      , shards_(std::make_unique<shard[]>(this->shard_count_)) // NOLINT(*-avoid-c-arrays)
+      , hash_(std::move(hash))
+      , equal_(std::move(equal))
+    {}
+
+    ~concurrent_map() = default;
+
+    /**
+     * @brief Returns a copy of the value associated with the key.
+     * @param key Key to look up.
+     * @return Copy of the value or <code>std::nullopt</code> if the key is not present.
+     */
+    [[nodiscard]] std::optional<V> find(K const& key) const requires std::copy_constructible<V> {
+      auto result = std::optional<V>();
+      this->visit(key, [&result](V const& value) { result.emplace(value); });
+      return result;
+    }
+
+    /**
+     * @brief Returns <code>true</code> if the key is present.
+     * @param key Key to look up.
+     */
+    [[nodiscard]] bool contains(K const& key) const {
+      return this->visit(key, [](V const&) {});
+    }
+
+    /**
+     * @brief Inserts a new value or replaces the existing one.
+     * @param key Key.
+     * @param value Value.
+     * @return <code>true</code> if the key was inserted, <code>false</code> if an existing value was replaced.
+     */
+    template <typename KK, typename VV>
+    requires std::constructible_from<K, KK&&> and std::constructible_from<V, VV&&>
+    bool insert_or_assign(KK&& key, VV&& value) {
+      auto const h = this->hash(key);
+      auto& s = this->shard_for(h);
+      auto const lock = std::unique_lock(s.mutex);
+      if(auto const i = this->lookup(s, key, h); i != npos) {
+        s.slots[i]->kv.second = std::forward<VV>(value);
+        return false;
+      }
+      this->insert_new(s, h, std::forward<KK>(key), std::forward<VV>(value));
+      return true;
+    }
+
+    /**
+     * @brief Inserts a new value if the key is not present.
+     * @param key Key.
+     * @param args Arguments to construct the value from.
+     * @return <code>true</code> if the key was inserted.
+     */
+    template <typename KK, typename... Args>
+    requires std::constructible_from<K, KK&&> and std::constructible_from<V, Args&&...>
+    bool try_emplace(KK&& key, Args&&... args) {
+      auto const h = this->hash(key);
+      auto& s = this->shard_for(h);
+      auto const lock = std::unique_lock(s.mutex);
+      if(this->lookup(s, key, h) != npos)
+        return false;
+      this->insert_new(s, h, std::forward<KK>(key), std::forward<Args>(args)...);
+      return true;
+    }
+
+    /**
+     * @brief Removes the key.
+     * @param key Key to remove.
+     * @return <code>true</code> if the key was present.
+     */
+    bool erase(K const& key) {
+      auto const h = this->hash(key);
+      auto& s = this->shard_for(h);
+      auto const lock = std::unique_lock(s.mutex);
+      auto const i = this->lookup(s, key, h);
+      if(i == npos)
+        return false;
+      this->remove(s, i);
+      return true;
+    }
+
+    /**
+     * @brief Invokes the visitor with a constant reference to the value, under the shared lock.
+     * @param key Key to look up.
+     * @param visitor Callable accepting <code>V const&</code>.
+     * @return <code>true</code> if the key was found and the visitor was invoked.
+     */
+    template <std::invocable<V const&> F>
+    bool visit(K const& key, F&& visitor) const {
+      auto const h = this->hash(key);
+      auto& s = this->shard_for(h);
+      auto const lock = std::shared_lock(s.mutex);
+      auto const i = this->lookup(s, key, h);
+      if(i == npos)
+        return false;
+      std::invoke(std::forward<F>(visitor), std::as_const(s.slots[i]->kv.second));
+      return true;
+    }
+
+    /**
+     * @brief Invokes the visitor with a mutable reference to the value, under the exclusive lock.
+     * @param key Key to look up.
+     * @param visitor Callable accepting <code>V&</code>.
+     * @return <code>true</code> if the key was found and the visitor was invoked.
+     */
+    template <std::invocable<V&> F>
+    bool visit(K const& key, F&& visitor) {
+      auto const h = this->hash(key);
+      auto& s = this->shard_for(h);
+      auto const lock = std::unique_lock(s.mutex);
+      auto const i = this->lookup(s, key, h);
+      if(i == npos)
+        return false;
+      std::invoke(std::forward<F>(visitor), s.slots[i]->kv.second);
+      return true;
+    }
+
+    /**
+     * @brief Atomically updates the value, inserting it first if the key is not present.
+     * @param key Key.
+     * @param visitor Callable accepting <code>V&</code>.
+     * @param args Arguments to construct the value from, if the key is not present.
+     * @return <code>true</code> if the key was inserted.
+     */
+    template <typename KK, std::invocable<V&> F, typename... Args>
+    requires std::constructible_from<K, KK&&> and std::constructible_from<V, Args&&...>
+    bool upsert(KK&& key, F&& visitor, Args&&... args) {
+      auto const h = this->hash(key);
+      auto& s = this->shard_for(h);
+      auto const lock = std::unique_lock(s.mutex);
+      auto i = this->lookup(s, key, h);
+      auto const inserted = i == npos;
+      if(inserted)
+        i = this->insert_new(s, h, std::forward<KK>(key), std::forward<Args>(args)...);
+      std::invoke(std::forward<F>(visitor), s.slots[i]->kv.second);
+      return inserted;
+    }
+
+    /**
+     * @brief Removes the key if the predicate returns <code>true</code> for its value.
+     * @param key Key.
+     * @param predicate Callable accepting <code>V&</code> and returning <code>bool</code>.
+     * @return <code>true</code> if the key was removed.
+     */
+    template <std::predicate<V&> F>
+    bool erase_if(K const& key, F&& predicate) {
+      auto const h = this->hash(key);
+      auto& s = this->shard_for(h);
+      auto const lock = std::unique_lock(s.mutex);
+      auto const i = this->lookup(s, key, h);
+      if(i == npos or not std::invoke(std::forward<F>(predicate), s.slots[i]->kv.second))
+        return false;
+      this->remove(s, i);
+      return true;
+    }
+
+    /**
+     * @brief Invokes the visitor for every element, one shard at a time, under the shared lock.
+     * @details Not a snapshot: elements of other shards can change while the iteration is in progress.
+     * @param visitor Callable accepting <code>K const&</code> and <code>V const&</code>.
+     */
+    template <std::invocable<K const&, V const&> F>
+    void for_each(F&& visitor) const {
+      for(auto i = usize(0); i < this->shard_count_; ++i) {
+        auto& s = this->shards_[i];
+        auto const lock = std::shared_lock(s.mutex);
+        for(auto const& e : s.slots)
+          if(e)
+            std::invoke(visitor, e->kv.first, std::as_const(e->kv.second));
+      }
+    }
+
+    /**
+     * @brief Removes all elements.
+     */
+    void clear() {
+      for(auto i = usize(0); i < this->shard_count_; ++i) {
+        auto& s = this->shards_[i];
+        auto const lock = std::unique_lock(s.mutex);
+        s.slots.clear();
+        s.size = 0;
+      }
+    }
+
+    /**
+     * @brief Returns number of elements.
+     * @details Not a snapshot: shards are counted one at a time.
+     */
+    [[nodiscard]] usize size() const {
+      auto total = usize(0);
+      for(auto i = usize(0); i < this->shard_count_; ++i) {
+        auto& s = this->shards_[i];
+        auto const lock = std::shared_lock(s.mutex);
+        total += s.size;
+      }
+      return total;
+    }
+
+    /**
+     * @brief Returns <code>true</code> if the map has no elements.
+     */
+    [[nodiscard]] bool empty() const { return this->size() == 0; }
+
+    /**
+     * @brief Returns number of shards.
+     */
+    [[nodiscard]] usize shard_count() const noexcept { return this->shard_count_; }
+
+   private:
+    struct entry
+    {
+      usize hash;
+      std::pair<K, V> kv;
+    };
+
+    struct alignas(cache_line_size) shard
+    {
+      mutable Mutex mutex;
+      std::vector<std::optional<entry>> slots;
+      usize size = 0;
+    };
+
+    static constexpr usize initial_capacity = 8;
+    static constexpr usize npos = ~usize(0);
+
+    [[nodiscard]] static usize default_shard_count() {
+      return std::max(std::thread::hardware_concurrency(), 1U) * usize(4);
+    }
+
+    /**
+     * Standard library hashes are often identity for integers, so the result is mixed
+     * (64-bit finalizer of MurmurHash3) to spread both shard and slot bits.
+     */
+    template <typename Q>
+    [[nodiscard]] usize hash(Q const& key) const {
+      auto h = static_cast<u64>(std::invoke(this->hash_, key));
+      h ^= h >> 33U;
+      h *= 0xFF51AFD7ED558CCDULL;
+      h ^= h >> 33U;
+      h *= 0xC4CEB9FE1A85EC53ULL;
+      h ^= h >> 33U;
+      return static_cast<usize>(h);
+    }
+
+    [[nodiscard]] shard& shard_for(usize h) const noexcept {
+      // high bits select the shard, low bits select the slot inside the shard
+      return this->shards_[(h >> (sizeof(usize) * 4)) & (this->shard_count_ - 1)];
+    }
+
+    template <typename Q>
+    [[nodiscard]] usize lookup(shard const& s, Q const& key, usize h) const {
+      if(s.slots.empty())
+        return npos;
+      auto const mask = s.slots.size() - 1;
+      for(auto i = h & mask;; i = (i + 1) & mask) {
+        auto const& slot = s.slots[i];
+        if(not slot)
+          return npos;
+        if(slot->hash == h and std::invoke(this->equal_, slot->kv.first, key))
+          return i;
+      }
+    }
+
+    template <typename KK, typename... Args>
+    usize insert_new(shard& s, usize h, KK&& key, Args&&... args) {
+      if((s.size + 1) * 4 > s.slots.size() * 3)
+        this->grow(s);
+      auto const mask = s.slots.size() - 1;
+      auto i = h & mask;
+      while(s.slots[i])
+        i = (i + 1) & mask;
+      s.slots[i].emplace(entry {
+        .hash = h,
+        .kv = std::pair<K, V>(
+          std::piecewise_construct,
+          std::forward_as_tuple(std::forward<KK>(key)),
+          std::forward_as_tuple(std::forward<Args>(args)...)
+        )
+      });
+      ++s.size;
+      return i;
+    }
+
+    void grow(shard& s) {
+      auto old = std::exchange(s.slots, std::vector<std::optional<entry>>(std::max(s.slots.size() * 2, initial_capacity)));
+      auto const mask = s.slots.size() - 1;
+      for(auto& e : old) {
+        if(not e)
+          continue;
+        auto i = e->hash & mask;
+        while(s.slots[i])
+          i = (i + 1) & mask;
+        s.slots[i].emplace(std::move(*e));
+      }
+    }
+
+    /**
+     * Backward-shift deletion: elements following the removed one are moved back if that brings
+     * them closer to their home slot, so that probe sequences never contain holes and no tombstones are needed.
+     */
+    void remove(shard& s, usize index) {
+      auto const mask = s.slots.size() - 1;
+      auto hole = index;
+      s.slots[hole].reset();
+      for(auto i = (hole + 1) & mask; s.slots[i]; i = (i + 1) & mask) {
+        auto const home = s.slots[i]->hash & mask;
+        if(((i - home) & mask) >= ((i - hole) & mask)) {
+          s.slots[hole] = std::move(s.slots[i]);
+          s.slots[i].reset();
+          hole = i;
+        }
+      }
+      --s.size;
+    }
+
+    usize shard_count_;
+    std::unique_ptr<shard[]> shards_; // NOLINT(*-avoid-c-arrays)
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] KeyEqual equal_;
+  };
+} // namespace fl
\ No newline at end of file
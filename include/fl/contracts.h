@@ -1,12 +1,20 @@
 #pragma once
 
 #include <source_location>
+#include <span>
 #include <string>
 #include <string_view>
 #include <format>
+#include <algorithm>
+#include <array>
+#include <concepts>
 #include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "global/definitions.h"
 #include "global/export.h"
+#include "types/stdint.h"
 
 /**
  * @brief Contract-programming related functions and classes.
@@ -27,18 +35,24 @@ namespace fl::contracts
   /**
    * @brief Contract violation data holder.
    * @details Contains information about a contract violation.
+   *
+   * Reporting a violation does not allocate: the message is a view of the caller's message, which
+   * stays valid for the duration of the handler call. Handlers that need the message afterwards
+   * must copy it. The stack trace is captured unsymbolized; it can be resolved later with
+   * <code>fl::platform::symbolize</code>.
    * @see contract_violation_handler
    */
   struct contract_violation
   {
-    contract_type type;            ///< Violated contract type.
-    std::string message;           ///< Violation message.
-    std::source_location location; ///< Violation location in source code.
+    contract_type type;               ///< Violated contract type.
+    std::string_view message;         ///< Violation message. Valid only during the handler call.
+    std::source_location location;    ///< Violation location in source code.
+    std::span<uptr const> frames = {}; ///< Raw return addresses of the violating thread, innermost first. Valid only during the handler call.
   };
 
   /**
    * @brief Contract violation handler type.
-   * @note Handler function must be <code>[[noreturn]]</code>. The behavior is undefined if it does not terminate the program.
+   * @note Handler function must not return: it should either terminate the program or throw. If it returns, the program is terminated.
    */
   using contract_violation_handler = std::function<void(contract_violation const&)>;
 
@@ -46,8 +60,12 @@ namespace fl::contracts
    * @brief Default contract violation handler.
    * @details Default implementation of the contract violation handler.
    *
-   * Prints the violation to the standard error stream and terminates the program.
-   * If it is possible, colors the violation message in red.
+   * Prints the violation to the standard error stream and aborts the program.
+   * If the standard error stream is a terminal, colors the violation message in red.
+   *
+   * The output is assembled in a stack buffer and written with <code>write(2)</code>, so the
+   * handler neither allocates nor takes locks and is async-signal-safe. It can report violations
+   * detected when memory is exhausted, or from signal handlers.
    *
    * Example output:
    *
@@ -69,8 +87,9 @@ namespace fl::contracts
   void default_contract_violation_handler(contract_violation const& violation);
 
   /**
-   * @brief Returns the current global contract violation handler.
-   * @return Mutable reference to the global contract violation handler.
+   * @brief Returns a copy of the current global contract violation handler.
+   * @details Thread-safe. To replace the handler, use @ref set_violation_handler.
+   * @return Copy of the global contract violation handler.
    * @see default_contract_violation_handler
    * @see set_violation_handler
    */
@@ -78,12 +97,15 @@ namespace fl::contracts
   #ifndef FL_DOC
   ___fl_api___
   #endif // FL_DOC
-  contract_violation_handler& violation_handler();
+  contract_violation_handler violation_handler();
 
   /**
    * @brief Sets the global contract violation handler and returns the old one.
-   * @note Handler function must be <code>[[noreturn]]</code>. The behavior is undefined if it does not terminate the program.
-   * @param handler Contract violation handler.
+   * @details Thread-safe: handlers can be replaced while other threads report violations. The
+   * handler is published through an atomic pointer, so reporting a violation neither copies the
+   * handler nor takes a lock. A replaced handler is destroyed once no thread can be running it.
+   * @note Handler function must be <code>[[noreturn]]</code>. If it returns, the program is terminated.
+   * @param handler Contract violation handler. Empty handler restores @ref default_contract_violation_handler.
    * @return Old global contract violation handler.
    * @see violation_handler
    * @see default_contract_violation_handler
@@ -93,6 +115,123 @@ namespace fl::contracts
   #endif // FL_DOC
   contract_violation_handler set_violation_handler(contract_violation_handler handler);
 
+  /**
+   * @brief Violation counter of a single call site, recorded with @ref contract_semantic::observe.
+   */
+  struct observed_violation
+  {
+    contract_type type = contract_type::invariant; ///< Violated contract type.
+    std::source_location location = {};            ///< Location of the check.
+    u64 count = 0;                                 ///< Number of violations.
+  };
+
+  /**
+   * @brief Message of one of the first observed violations.
+   */
+  struct violation_sample
+  {
+    contract_type type = contract_type::invariant; ///< Violated contract type.
+    std::source_location location = {};            ///< Location of the check.
+    std::string message = {};                      ///< Violation message, truncated to a fixed length.
+  };
+
+  /**
+   * @brief Snapshot of violations recorded with @ref contract_semantic::observe.
+   */
+  struct violation_statistics
+  {
+    std::vector<observed_violation> sites = {}; ///< Counters per call site, most violated first.
+    std::vector<violation_sample> samples = {}; ///< Messages of the first violations, in order of occurrence.
+    u64 untracked = 0;                          ///< Violations not attributed to a site, because the site table was full.
+  };
+
+  /**
+   * @brief Returns a snapshot of observed violations.
+   * @details Thread-safe and lock-free with respect to concurrent observers. Counters are read
+   * individually, so a snapshot taken while violations are observed is not atomic as a whole.
+   *
+   * Observed violations are also written to the standard error stream at exit.
+   * @return Counters per call site and message samples.
+   * @see dump_observed_violations
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  violation_statistics observed_violations();
+
+  /**
+   * @brief Writes observed violations to the standard error stream.
+   * @details Called automatically at exit if any violation was observed. Does not allocate.
+   * @see observed_violations
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void dump_observed_violations();
+
+  /**
+   * @brief Last enforced contract violation, kept in static storage.
+   * @details Recorded before the violation handler is called, so it outlives a handler which
+   * aborts the program. Strings are truncated to fit and zero-terminated.
+   * @see last_violation
+   */
+  struct violation_record
+  {
+    /// Capacity of each string, including the terminating zero.
+    static constexpr usize text_capacity = 256;
+
+    contract_type type = contract_type::invariant; ///< Violated contract type.
+    u32 line = 0;                                  ///< Line of the check.
+    u32 column = 0;                                ///< Column of the check.
+    std::array<char, text_capacity> file = {};     ///< File of the check.
+    std::array<char, text_capacity> function = {}; ///< Function containing the check.
+    std::array<char, text_capacity> message = {};  ///< Violation message.
+  };
+
+  /**
+   * @brief Returns the last violation reported with @ref contract_semantic::enforce.
+   * @details Async-signal-safe; intended for crash reports. A violation reported while another
+   * is being recorded is not recorded.
+   * @return Pointer to static storage, or <code>nullptr</code> if no violation was reported.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  violation_record const* last_violation() noexcept;
+
+  /**
+   * @brief Default rate of sampled checks: one in <tt>100</tt> calls of each call site is checked.
+   * @see set_sampling_rate
+   */
+  inline constexpr auto default_sampling_rate = u32(100);
+
+  /**
+   * @brief Returns the rate of sampled checks.
+   * @details Thread-safe.
+   * @return <tt>N</tt>, if one in <tt>N</tt> calls of each sampled check is evaluated, or <tt>0</tt> if sampled checks are disabled.
+   * @see set_sampling_rate
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  u32 sampling_rate() noexcept;
+
+  /**
+   * @brief Sets the rate of sampled checks at runtime.
+   * @details Thread-safe. Sampled checks (see @ref checks::sampled_invariant) are evaluated on one in
+   * <tt>rate</tt> calls of each call site, counted per thread. Each site picks up the new rate after its
+   * current countdown expires.
+   * @param rate <tt>N</tt> to evaluate one in <tt>N</tt> calls, <tt>1</tt> to evaluate every call, or <tt>0</tt> to disable sampled checks.
+   * @see sampling_rate
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void set_sampling_rate(u32 rate) noexcept;
+
   /**
    * @brief Contracts implementation details.
    */
@@ -118,6 +257,8 @@ namespace fl::contracts
 
     /**
      * @brief Invokes the global contract violation handler (see @ref violation_handler) with the violation data from current location in the source code.
+     * @details Marked cold and never inlined: a check compiles to a test and a call, keeping hot
+     * code compact.
      * @param type Type of violated contract.
      * @param message Violation message.
      * @param location Violation location in source code. Defaults to current location.
@@ -125,6 +266,8 @@ namespace fl::contracts
      */
     [[noreturn]]
     #ifndef FL_DOC
+    ___cold___
+    ___noinline___
     ___fl_api___
     #endif // FL_DOC
     void violate(
@@ -132,180 +275,1135 @@ namespace fl::contracts
       std::string_view message,
       std::source_location location = std::source_location::current()
     );
+
+    /**
+     * @brief Records an observed violation instead of reporting it.
+     * @details Used by checks with @ref contract_semantic::observe. Increments the counter of the
+     * violated site in a fixed-size lock-free table and keeps the message if it is one of the first
+     * violations of the process. The violation handler is not invoked, and the function returns.
+     * @param type Type of violated contract.
+     * @param message Violation message.
+     * @param location Violation location in source code. Defaults to current location.
+     * @see observed_violations
+     */
+    #ifndef FL_DOC
+    ___cold___
+    ___noinline___
+    ___fl_api___
+    #endif // FL_DOC
+    void observe(
+      contract_type type,
+      std::string_view message,
+      std::source_location location = std::source_location::current()
+    );
   } // namespace detail
 
+  /**
+   * @brief Contract checking level.
+   * @details Every check has a required level. A check is compiled in only if its required level is
+   * not greater than the level of the checks it is issued through (see @ref checks), and is
+   * compiled out completely otherwise: neither the expression nor the message is evaluated.
+   *
+   * The global level is selected at compile time with @ref FL_CONTRACT_LEVEL.
+   */
+  enum class contract_level : signed char
+  {
+    off = 0,    ///< No checks are compiled in.
+    normal = 1, ///< <i>Default</i> level. Cheap checks, which stay enabled in release builds.
+    audit = 2   ///< Expensive checks, such as O(n) validation. Enabled only in special builds.
+  };
+
+  /**
+   * @brief Global contract checking level, selected with @ref FL_CONTRACT_LEVEL.
+   * @see checks
+   */
+  inline constexpr auto global_level = static_cast<contract_level>(FL_CONTRACT_LEVEL);
+
+  /**
+   * @brief What a failed check does.
+   * @details Selected at compile time with @ref FL_CONTRACT_SEMANTIC, or per subsystem through @ref checks.
+   */
+  enum class contract_semantic : signed char
+  {
+    enforce = 0, ///< Invokes the violation handler, which does not return.
+    observe = 1  ///< Counts the violation per call site and continues. See @ref observed_violations.
+  };
+
+  /**
+   * @brief Global contract semantic, selected with @ref FL_CONTRACT_SEMANTIC.
+   * @see checks
+   */
+  inline constexpr auto global_semantic = static_cast<contract_semantic>(FL_CONTRACT_SEMANTIC);
+
+  namespace detail
+  {
+    /**
+     * @brief Checked expression: either a value convertible to <code>bool</code>, or a callable returning it.
+     * @details Callables are invoked only if the check is enabled, so expensive expressions cost
+     * nothing when their level is compiled out.
+     */
+    template <typename T>
+    concept contract_expression = std::is_invocable_r_v<bool, T> or std::convertible_to<T, bool>;
+
+    /**
+     * @brief Evaluates a checked expression.
+     * @param expression Value or callable.
+     * @return Value of the expression.
+     */
+    template <contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    [[nodiscard]] constexpr bool holds(T&& expression) {
+      if constexpr(std::is_invocable_r_v<bool, T>)
+        return std::invoke(std::forward<T>(expression));
+      else
+        return static_cast<bool>(std::forward<T>(expression));
+    }
+
+    /**
+     * @brief Arguments of a formatted contract message.
+     * @details At least one argument, which is not a source location: a literal message with an
+     * explicit location selects the plain overload instead.
+     */
+    template <typename... Args>
+    concept format_arguments = sizeof...(Args) > 0
+      and not (sizeof...(Args) == 1 and (std::same_as<std::remove_cvref_t<Args>, std::source_location> and ...));
+
+    /**
+     * @brief Format string of a contract message together with the location of the check.
+     * @details Implicitly constructed from a string literal at the call site, which captures the
+     * location before the variadic arguments. The format string is checked at compile time.
+     * @tparam Args Types of the format arguments.
+     */
+    template <typename... Args>
+    struct formatted_message
+    {
+      /**
+       * @brief Constructs the message from a format string.
+       * @param format Format string, checked against <tt>Args</tt> at compile time.
+       * @param location Location of the check. Defaults to current location.
+       */
+      template <typename S>
+      requires std::convertible_to<S const&, std::string_view>
+      consteval formatted_message( // NOLINT(*-explicit-constructor)
+        S const& format,
+        std::source_location location = std::source_location::current()
+      )
+        : format(format)
+        , location(location)
+      {}
+
+      std::format_string<Args...> format; ///< Format string.
+      std::source_location location;      ///< Location of the check.
+    };
+
+    /**
+     * @brief Maximum length of a formatted violation message. Longer messages are truncated.
+     */
+    inline constexpr auto formatted_message_capacity = usize(512);
+
+    /**
+     * @brief Formats a violation message into a buffer.
+     * @details Messages longer than the buffer are truncated and end with <code>"..."</code>.
+     * @param buffer Destination buffer.
+     * @param message Format string and location of the check.
+     * @param args Format arguments.
+     * @return View of the formatted message in <tt>buffer</tt>.
+     */
+    template <typename... Args>
+    [[nodiscard]] std::string_view format_message(
+      std::array<char, formatted_message_capacity>& buffer,
+      formatted_message<std::type_identity_t<Args>...> message,
+      Args&&... args
+    ) {
+      auto const result = std::format_to_n(buffer.data(), buffer.size(), message.format, std::forward<Args>(args)...);
+      auto const size = std::min(static_cast<usize>(result.size), buffer.size());
+      if(static_cast<usize>(result.size) > buffer.size())
+        std::ranges::fill(buffer.end() - 3, buffer.end(), '.');
+      return { buffer.data(), size };
+    }
+
+    /**
+     * @brief Formats the violation message and invokes the global contract violation handler.
+     * @details The message is formatted into a stack buffer, so reporting still does not allocate,
+     * unless a formatter of an argument does. Messages longer than @ref formatted_message_capacity are
+     * truncated and end with <code>"..."</code>.
+     * @param type Type of violated contract.
+     * @param message Format string and location of the check.
+     * @param args Format arguments.
+     * @see violate
+     */
+    template <typename... Args>
+    [[noreturn]]
+    #ifndef FL_DOC
+    ___cold___
+    ___noinline___
+    #endif // FL_DOC
+    void violate_formatted(contract_type type, formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      auto buffer = std::array<char, formatted_message_capacity>();
+      violate(type, format_message<Args...>(buffer, message, std::forward<Args>(args)...), message.location);
+    }
+
+    /**
+     * @brief Formats the violation message and records an observed violation.
+     * @param type Type of violated contract.
+     * @param message Format string and location of the check.
+     * @param args Format arguments.
+     * @see observe
+     */
+    template <typename... Args>
+    #ifndef FL_DOC
+    ___cold___
+    ___noinline___
+    #endif // FL_DOC
+    void observe_formatted(contract_type type, formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      auto buffer = std::array<char, formatted_message_capacity>();
+      observe(type, format_message<Args...>(buffer, message, std::forward<Args>(args)...), message.location);
+    }
+
+    /**
+     * @brief Number of per-thread countdowns of sampled checks. Call sites are mapped onto them by location.
+     */
+    inline constexpr auto sampling_slots = usize(256);
+
+    /**
+     * @brief Countdown of a disabled site before it rereads the sampling rate.
+     */
+    inline constexpr auto disabled_sampling_countdown = u32(1'024);
+
+    /**
+     * @brief Per-thread countdowns of sampled checks.
+     */
+    inline thread_local std::array<u32, sampling_slots> sampling_countdowns {}; // NOLINT(*-avoid-non-const-global-variables)
+
+    /**
+     * @brief Reloads an expired countdown from the global sampling rate.
+     * @param countdown Expired countdown of the call site.
+     * @return <code>true</code> if the check should be evaluated.
+     */
+    #ifndef FL_DOC
+    ___noinline___
+    #endif // FL_DOC
+    inline bool reload_sampling_countdown(u32& countdown) noexcept {
+      auto const rate = sampling_rate();
+      countdown = rate == 0 ? disabled_sampling_countdown : rate - 1;
+      return rate != 0;
+    }
+
+    /**
+     * @brief Maps a sampled check onto its countdown.
+     * @details Mixes the file name pointer with the line and the column, so that checks at the same
+     * line and column of different files do not share a countdown.
+     * @param location Location of the check.
+     * @return Index into @ref sampling_countdowns.
+     */
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    inline usize sampling_slot(std::source_location const& location) noexcept {
+      auto hash = u64(14'695'981'039'346'656'037ULL);
+      auto const mix = [&hash](u64 value) {
+        hash ^= value;
+        hash *= 1'099'511'628'211ULL;
+      };
+      mix(reinterpret_cast<uptr>(location.file_name())); // NOLINT(*-reinterpret-cast)
+      mix(location.line());
+      mix(location.column());
+      // low bits of the product depend only on low bits of the inputs
+      return static_cast<usize>(hash >> 32U) % sampling_slots;
+    }
+
+    /**
+     * @brief Decides whether this call of a sampled check is evaluated.
+     * @details Costs a thread-local decrement and a few arithmetic instructions on calls which are skipped.
+     * @param location Location of the check.
+     * @return <code>true</code> on one in @ref sampling_rate calls of the site.
+     */
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    inline bool sample(std::source_location const& location) noexcept {
+      auto& countdown = sampling_countdowns[sampling_slot(location)];
+      if(countdown != 0) [[likely]] {
+        --countdown;
+        return false;
+      }
+      return reload_sampling_countdown(countdown);
+    }
+  } // namespace detail
+
+  /**
+   * @brief Contract checks issued at the given level.
+   * @details Checks of the <i>normal</i> level (@ref invariant, @ref precondition and @ref postcondition)
+   * are enabled if <tt>Level</tt> is at least @ref contract_level::normal.
+   * Checks of the <i>audit</i> level (<code>audit_*</code> functions) are enabled only if <tt>Level</tt>
+   * is @ref contract_level::audit. Disabled checks compile to nothing. Sampled checks
+   * (<code>sampled_*</code> functions) are normal checks evaluated on one in @ref sampling_rate calls.
+   * The <code>broken_*</code> functions are not checks: they always report and never return.
+   *
+   * The free functions in this namespace issue checks at @ref global_level. A subsystem or a
+   * translation unit overrides the global level by issuing its checks through its own alias.
+   * Each level is a distinct type, so translation units with different levels do not violate the
+   * one definition rule.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *  namespace geometry {
+   *  #if defined(GEOMETRY_AUDIT)
+   *    using contracts = fl::contracts::checks<fl::contracts::contract_level::audit>;
+   *  #else
+   *    using contracts = fl::contracts::checks<fl::contracts::global_level>;
+   *  #endif
+   *
+   *    void triangulate(polygon const& p) {
+   *      contracts::precondition(p.size() >= 3, "polygon must have at least three vertices");
+   *      contracts::audit_precondition([&] { return p.is_simple(); }, "polygon must be simple");
+   *      ...
+   *    }
+   *  } // namespace geometry
+   * @endcode
+   *
+   * With @ref contract_semantic::observe, failed checks are counted and execution continues, which
+   * allows measuring how often a check fails under real traffic, e.g. during a canary rollout.
+   * @tparam Level Level of the checks.
+   * @tparam Semantic What a failed check does. Defaults to @ref global_semantic.
+   * @see contract_level
+   * @see contract_semantic
+   * @see FL_CONTRACT_LEVEL
+   */
+  template <contract_level Level, contract_semantic Semantic = global_semantic>
+  struct checks
+  {
+    /// Level of the checks.
+    static constexpr contract_level level = Level;
+
+    /// What a failed check does.
+    static constexpr contract_semantic semantic = Semantic;
+
+    /// <code>true</code> if checks of the <tt>Required</tt> level are compiled in.
+    template <contract_level Required>
+    static constexpr bool enabled = Required != contract_level::off and Required <= Level;
+
+    /**
+     * @brief Checks if a given <i>invariant</i> expression is true and invokes the violation handler if it is not.
+     * @param expression Invariant expression or a callable returning it.
+     * @param message Violation message. Defaults to <code>"Invariant violated"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     */
+    template <detail::contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void invariant(
+      T&& expression,
+      std::string_view message = "Invariant violated",
+      std::source_location location = std::source_location::current()
+    ) {
+      checks::check<contract_level::normal>(contract_type::invariant, std::forward<T>(expression), message, location);
+    }
+
+    /**
+     * @brief Formatted overload of @ref invariant: the message is formatted only if the check fails.
+     * @param expression Invariant expression or a callable returning it.
+     * @param message Format string of the violation message, checked at compile time.
+     * @param args Format arguments, captured by reference.
+     */
+    template <detail::contract_expression T, typename... Args>
+    requires detail::format_arguments<Args...>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void invariant(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      checks::check_formatted<contract_level::normal>(contract_type::invariant, std::forward<T>(expression), message, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Checks if a given <i>precondition</i> expression is true and invokes the violation handler if it is not.
+     * @param expression Precondition expression or a callable returning it.
+     * @param message Violation message. Defaults to <code>"Precondition violated"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     */
+    template <detail::contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void precondition(
+      T&& expression,
+      std::string_view message = "Precondition violated",
+      std::source_location location = std::source_location::current()
+    ) {
+      checks::check<contract_level::normal>(contract_type::precondition, std::forward<T>(expression), message, location);
+    }
+
+    /**
+     * @brief Formatted overload of @ref precondition: the message is formatted only if the check fails.
+     * @param expression Precondition expression or a callable returning it.
+     * @param message Format string of the violation message, checked at compile time.
+     * @param args Format arguments, captured by reference.
+     */
+    template <detail::contract_expression T, typename... Args>
+    requires detail::format_arguments<Args...>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void precondition(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      checks::check_formatted<contract_level::normal>(contract_type::precondition, std::forward<T>(expression), message, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Checks if a given <i>postcondition</i> expression is true and invokes the violation handler if it is not.
+     * @param expression Postcondition expression or a callable returning it.
+     * @param message Violation message. Defaults to <code>"Postcondition violated"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     */
+    template <detail::contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void postcondition(
+      T&& expression,
+      std::string_view message = "Postcondition violated",
+      std::source_location location = std::source_location::current()
+    ) {
+      checks::check<contract_level::normal>(contract_type::postcondition, std::forward<T>(expression), message, location);
+    }
+
+    /**
+     * @brief Formatted overload of @ref postcondition: the message is formatted only if the check fails.
+     * @param expression Postcondition expression or a callable returning it.
+     * @param message Format string of the violation message, checked at compile time.
+     * @param args Format arguments, captured by reference.
+     */
+    template <detail::contract_expression T, typename... Args>
+    requires detail::format_arguments<Args...>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void postcondition(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      checks::check_formatted<contract_level::normal>(contract_type::postcondition, std::forward<T>(expression), message, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Audit-level @ref invariant.
+     * @details Pass expensive expressions as callables: they are not evaluated unless audit checks are enabled.
+     * @param expression Invariant expression or a callable returning it.
+     * @param message Violation message. Defaults to <code>"Invariant violated"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     */
+    template <detail::contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void audit_invariant(
+      T&& expression,
+      std::string_view message = "Invariant violated",
+      std::source_location location = std::source_location::current()
+    ) {
+      checks::check<contract_level::audit>(contract_type::invariant, std::forward<T>(expression), message, location);
+    }
+
+    /**
+     * @brief Formatted overload of @ref audit_invariant: the message is formatted only if the check fails.
+     * @param expression Invariant expression or a callable returning it.
+     * @param message Format string of the violation message, checked at compile time.
+     * @param args Format arguments, captured by reference.
+     */
+    template <detail::contract_expression T, typename... Args>
+    requires detail::format_arguments<Args...>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void audit_invariant(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      checks::check_formatted<contract_level::audit>(contract_type::invariant, std::forward<T>(expression), message, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Audit-level @ref precondition.
+     * @details Pass expensive expressions as callables: they are not evaluated unless audit checks are enabled.
+     * @param expression Precondition expression or a callable returning it.
+     * @param message Violation message. Defaults to <code>"Precondition violated"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     */
+    template <detail::contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void audit_precondition(
+      T&& expression,
+      std::string_view message = "Precondition violated",
+      std::source_location location = std::source_location::current()
+    ) {
+      checks::check<contract_level::audit>(contract_type::precondition, std::forward<T>(expression), message, location);
+    }
+
+    /**
+     * @brief Formatted overload of @ref audit_precondition: the message is formatted only if the check fails.
+     * @param expression Precondition expression or a callable returning it.
+     * @param message Format string of the violation message, checked at compile time.
+     * @param args Format arguments, captured by reference.
+     */
+    template <detail::contract_expression T, typename... Args>
+    requires detail::format_arguments<Args...>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void audit_precondition(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      checks::check_formatted<contract_level::audit>(contract_type::precondition, std::forward<T>(expression), message, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Audit-level @ref postcondition.
+     * @details Pass expensive expressions as callables: they are not evaluated unless audit checks are enabled.
+     * @param expression Postcondition expression or a callable returning it.
+     * @param message Violation message. Defaults to <code>"Postcondition violated"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     */
+    template <detail::contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void audit_postcondition(
+      T&& expression,
+      std::string_view message = "Postcondition violated",
+      std::source_location location = std::source_location::current()
+    ) {
+      checks::check<contract_level::audit>(contract_type::postcondition, std::forward<T>(expression), message, location);
+    }
+
+    /**
+     * @brief Formatted overload of @ref audit_postcondition: the message is formatted only if the check fails.
+     * @param expression Postcondition expression or a callable returning it.
+     * @param message Format string of the violation message, checked at compile time.
+     * @param args Format arguments, captured by reference.
+     */
+    template <detail::contract_expression T, typename... Args>
+    requires detail::format_arguments<Args...>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void audit_postcondition(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      checks::check_formatted<contract_level::audit>(contract_type::postcondition, std::forward<T>(expression), message, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Sampled @ref invariant: evaluated on one in @ref sampling_rate calls of the call site.
+     * @details Intended for checks which are too expensive to run on every call of hot code in
+     * production. Countdowns are kept per thread, so skipped calls do not touch shared memory.
+     * @param expression Invariant expression or a callable returning it.
+     * @param message Violation message. Defaults to <code>"Invariant violated"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     * @see set_sampling_rate
+     */
+    template <detail::contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static void sampled_invariant(
+      T&& expression,
+      std::string_view message = "Invariant violated",
+      std::source_location location = std::source_location::current()
+    ) {
+      if constexpr(enabled<contract_level::normal>) {
+        if(detail::sample(location))
+          checks::check<contract_level::normal>(contract_type::invariant, std::forward<T>(expression), message, location);
+      }
+    }
+
+    /**
+     * @brief Sampled @ref precondition: evaluated on one in @ref sampling_rate calls of the call site.
+     * @details Intended for checks which are too expensive to run on every call of hot code in
+     * production. Countdowns are kept per thread, so skipped calls do not touch shared memory.
+     * @param expression Precondition expression or a callable returning it.
+     * @param message Violation message. Defaults to <code>"Precondition violated"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     * @see set_sampling_rate
+     */
+    template <detail::contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static void sampled_precondition(
+      T&& expression,
+      std::string_view message = "Precondition violated",
+      std::source_location location = std::source_location::current()
+    ) {
+      if constexpr(enabled<contract_level::normal>) {
+        if(detail::sample(location))
+          checks::check<contract_level::normal>(contract_type::precondition, std::forward<T>(expression), message, location);
+      }
+    }
+
+    /**
+     * @brief Sampled @ref postcondition: evaluated on one in @ref sampling_rate calls of the call site.
+     * @details Intended for checks which are too expensive to run on every call of hot code in
+     * production. Countdowns are kept per thread, so skipped calls do not touch shared memory.
+     * @param expression Postcondition expression or a callable returning it.
+     * @param message Violation message. Defaults to <code>"Postcondition violated"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     * @see set_sampling_rate
+     */
+    template <detail::contract_expression T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static void sampled_postcondition(
+      T&& expression,
+      std::string_view message = "Postcondition violated",
+      std::source_location location = std::source_location::current()
+    ) {
+      if constexpr(enabled<contract_level::normal>) {
+        if(detail::sample(location))
+          checks::check<contract_level::normal>(contract_type::postcondition, std::forward<T>(expression), message, location);
+      }
+    }
+
+    /**
+     * @brief Reports a broken invariant and does not return.
+     * @details Invokes the violation handler whatever the level and the semantic: code after the call
+     * is unreachable, so execution must not continue past it.
+     * @param message Violation message. Defaults to <code>"Broken invariant"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     */
+    [[noreturn]]
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static void broken_invariant(
+      std::string_view message = "Broken invariant",
+      std::source_location location = std::source_location::current()
+    ) {
+      detail::violate(contract_type::invariant, message, location);
+    }
+
+    /**
+     * @brief Formatted overload of @ref broken_invariant.
+     * @param message Format string of the violation message, checked at compile time.
+     * @param args Format arguments.
+     */
+    template <typename... Args>
+    requires detail::format_arguments<Args...>
+    [[noreturn]]
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static void broken_invariant(detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      detail::violate_formatted<Args...>(contract_type::invariant, message, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Reports a broken precondition and does not return.
+     * @details Invokes the violation handler whatever the level and the semantic: code after the call
+     * is unreachable, so execution must not continue past it.
+     * @param message Violation message. Defaults to <code>"Broken precondition"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     */
+    [[noreturn]]
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static void broken_precondition(
+      std::string_view message = "Broken precondition",
+      std::source_location location = std::source_location::current()
+    ) {
+      detail::violate(contract_type::precondition, message, location);
+    }
+
+    /**
+     * @brief Formatted overload of @ref broken_precondition.
+     * @param message Format string of the violation message, checked at compile time.
+     * @param args Format arguments.
+     */
+    template <typename... Args>
+    requires detail::format_arguments<Args...>
+    [[noreturn]]
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static void broken_precondition(detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      detail::violate_formatted<Args...>(contract_type::precondition, message, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Reports a broken postcondition and does not return.
+     * @details Invokes the violation handler whatever the level and the semantic: code after the call
+     * is unreachable, so execution must not continue past it.
+     * @param message Violation message. Defaults to <code>"Broken postcondition"</code>.
+     * @param location Violation location in source code. Defaults to current location.
+     */
+    [[noreturn]]
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static void broken_postcondition(
+      std::string_view message = "Broken postcondition",
+      std::source_location location = std::source_location::current()
+    ) {
+      detail::violate(contract_type::postcondition, message, location);
+    }
+
+    /**
+     * @brief Formatted overload of @ref broken_postcondition.
+     * @param message Format string of the violation message, checked at compile time.
+     * @param args Format arguments.
+     */
+    template <typename... Args>
+    requires detail::format_arguments<Args...>
+    [[noreturn]]
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static void broken_postcondition(detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+      detail::violate_formatted<Args...>(contract_type::postcondition, message, std::forward<Args>(args)...);
+    }
+
+   private:
+    template <contract_level Required, typename T>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void check(
+      contract_type type,
+      T&& expression,
+      std::string_view message,
+      std::source_location location
+    ) {
+      if constexpr(enabled<Required>) {
+        if(not detail::holds(std::forward<T>(expression))) [[unlikely]] {
+          if constexpr(Semantic == contract_semantic::observe)
+            detail::observe(type, message, location);
+          else
+            detail::violate(type, message, location);
+        }
+      }
+    }
+
+    template <contract_level Required, typename T, typename... Args>
+    #ifndef FL_DOC
+    ___inline___
+    #endif // FL_DOC
+    static constexpr void check_formatted(
+      contract_type type,
+      T&& expression,
+      detail::formatted_message<std::type_identity_t<Args>...> message,
+      Args&&... args
+    ) {
+      if constexpr(enabled<Required>) {
+        if(not detail::holds(std::forward<T>(expression))) [[unlikely]] {
+          if constexpr(Semantic == contract_semantic::observe)
+            detail::observe_formatted<Args...>(type, message, std::forward<Args>(args)...);
+          else
+            detail::violate_formatted<Args...>(type, message, std::forward<Args>(args)...);
+        }
+      }
+    }
+  };
+
   /**
    * @brief Checks if a given <i>invariant</i> expression is true and throws a contract violation if it is not.
    * @details If the expression is false, the contract violation is thrown with the given message and location.
-   * @note The expression is only evaluated in debug mode. In release mode this function is a no-op.
-   * @param expression Invariant expression.
+   * @note Checked at @ref global_level, which keeps this check enabled in release builds by default.
+   * @param expression Invariant expression or a callable returning it.
    * @param message Violation message. Defaults to <code>"Invariant violated"</code>.
+   * @param location Violation location in source code. Defaults to current location.
    * @see broken_invariant
+   * @see audit_invariant
    * @see precondition
    * @see postcondition
    */
+  template <detail::contract_expression T>
   #ifndef FL_DOC
   ___inline___
-  ___fl_release_consteval___
   #endif // FL_DOC
-  void invariant(
-    #ifndef FL_DOC
-    ___fl_release_unused___
-    #endif // FL_DOC
-    bool expression,
-    #ifndef FL_DOC
-    ___fl_release_unused___
-    #endif // FL_DOC
+  constexpr void invariant(
+    T&& expression,
     std::string_view message = "Invariant violated",
-    #ifndef FL_DOC
-    ___fl_release_unused___ std::source_location location = std::source_location::current()
-    #endif // FL_DOC
+    std::source_location location = std::source_location::current()
   ) {
-    ___fl_debug_only___(if(not expression) detail::violate(contract_type::invariant, message, location));
+    checks<global_level>::invariant(std::forward<T>(expression), message, location);
+  }
+
+  /**
+   * @brief Formatted overload of @ref invariant: the message is formatted only if the check fails.
+   * @param expression Invariant expression or a callable returning it.
+   * @param message Format string of the violation message, checked at compile time.
+   * @param args Format arguments.
+   */
+  template <detail::contract_expression T, typename... Args>
+  requires detail::format_arguments<Args...>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  constexpr void invariant(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+    checks<global_level>::invariant(std::forward<T>(expression), message, std::forward<Args>(args)...);
   }
 
   /**
    * @brief Checks if a given <i>precondition</i> expression is true and throws a contract violation if it is not.
    * @details If the expression is false, the contract violation is thrown with the given message and location.
-   * @note The expression is only evaluated in debug mode. In release mode this function is a no-op.
-   * @param expression Precondition expression.
+   * @note Checked at @ref global_level, which keeps this check enabled in release builds by default.
+   * @param expression Precondition expression or a callable returning it.
    * @param message Violation message. Defaults to <code>"Precondition violated"</code>.
    * @param location Violation location in source code. Defaults to current location.
    * @see broken_precondition
+   * @see audit_precondition
    * @see invariant
    * @see postcondition
    */
+  template <detail::contract_expression T>
   #ifndef FL_DOC
   ___inline___
-  ___fl_release_consteval___
   #endif // FL_DOC
-  void precondition(
-    #ifndef FL_DOC
-    ___fl_release_unused___
-    #endif // FL_DOC
-    bool expression,
-    #ifndef FL_DOC
-    ___fl_release_unused___
-    #endif // FL_DOC
+  constexpr void precondition(
+    T&& expression,
     std::string_view message = "Precondition violated",
-    #ifndef FL_DOC
-    ___fl_release_unused___ std::source_location location = std::source_location::current()
-    #endif // FL_DOC
+    std::source_location location = std::source_location::current()
   ) {
-    ___fl_debug_only___(if(not expression) detail::violate(contract_type::precondition, message, location));
+    checks<global_level>::precondition(std::forward<T>(expression), message, location);
+  }
+
+  /**
+   * @brief Formatted overload of @ref precondition: the message is formatted only if the check fails.
+   * @details Arguments are captured by reference and formatted in the violation path only, so
+   * descriptive messages cost nothing while the check passes.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *  fl::contracts::precondition(index < size, "index {} out of range [0, {})", index, size);
+   * @endcode
+   * @param expression Precondition expression or a callable returning it.
+   * @param message Format string of the violation message, checked at compile time.
+   * @param args Format arguments.
+   */
+  template <detail::contract_expression T, typename... Args>
+  requires detail::format_arguments<Args...>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  constexpr void precondition(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+    checks<global_level>::precondition(std::forward<T>(expression), message, std::forward<Args>(args)...);
   }
 
   /**
    * @brief Checks if a given <i>postcondition</i> expression is true and throws a contract violation if it is not.
    * @details If the expression is false, the contract violation is thrown with the given message and location.
-   * @note The expression is only evaluated in debug mode. In release mode this function is a no-op.
-   * @param expression Postcondition expression.
+   * @note Checked at @ref global_level, which keeps this check enabled in release builds by default.
+   * @param expression Postcondition expression or a callable returning it.
    * @param message Violation message. Defaults to <code>"Postcondition violated"</code>.
+   * @param location Violation location in source code. Defaults to current location.
    * @see broken_postcondition
+   * @see audit_postcondition
    * @see invariant
    * @see precondition
    */
+  template <detail::contract_expression T>
   #ifndef FL_DOC
   ___inline___
-  ___fl_release_consteval___
   #endif // FL_DOC
-  void postcondition(
-    #ifndef FL_DOC
-    ___fl_release_unused___
-    #endif // FL_DOC
-    bool expression,
-    #ifndef FL_DOC
-    ___fl_release_unused___
-    #endif // FL_DOC
+  constexpr void postcondition(
+    T&& expression,
     std::string_view message = "Postcondition violated",
-    #ifndef FL_DOC
-    ___fl_release_unused___ std::source_location location = std::source_location::current()
-    #endif // FL_DOC
+    std::source_location location = std::source_location::current()
   ) {
-    ___fl_debug_only___(if(not expression) detail::violate(contract_type::postcondition, message, location));
+    checks<global_level>::postcondition(std::forward<T>(expression), message, location);
+  }
+
+  /**
+   * @brief Formatted overload of @ref postcondition: the message is formatted only if the check fails.
+   * @param expression Postcondition expression or a callable returning it.
+   * @param message Format string of the violation message, checked at compile time.
+   * @param args Format arguments.
+   */
+  template <detail::contract_expression T, typename... Args>
+  requires detail::format_arguments<Args...>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  constexpr void postcondition(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+    checks<global_level>::postcondition(std::forward<T>(expression), message, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Checks an expensive <i>invariant</i> if audit checks are enabled.
+   * @details Pass the expression as a callable: it is not evaluated unless @ref global_level is
+   * @ref contract_level::audit.
+   * @param expression Invariant expression or a callable returning it.
+   * @param message Violation message. Defaults to <code>"Invariant violated"</code>.
+   * @param location Violation location in source code. Defaults to current location.
+   * @see invariant
+   */
+  template <detail::contract_expression T>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  constexpr void audit_invariant(
+    T&& expression,
+    std::string_view message = "Invariant violated",
+    std::source_location location = std::source_location::current()
+  ) {
+    checks<global_level>::audit_invariant(std::forward<T>(expression), message, location);
+  }
+
+  /**
+   * @brief Formatted overload of @ref audit_invariant: the message is formatted only if the check fails.
+   * @param expression Invariant expression or a callable returning it.
+   * @param message Format string of the violation message, checked at compile time.
+   * @param args Format arguments.
+   */
+  template <detail::contract_expression T, typename... Args>
+  requires detail::format_arguments<Args...>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  constexpr void audit_invariant(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+    checks<global_level>::audit_invariant(std::forward<T>(expression), message, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Checks an expensive <i>precondition</i> if audit checks are enabled.
+   * @details Pass the expression as a callable: it is not evaluated unless @ref global_level is
+   * @ref contract_level::audit.
+   * @param expression Precondition expression or a callable returning it.
+   * @param message Violation message. Defaults to <code>"Precondition violated"</code>.
+   * @param location Violation location in source code. Defaults to current location.
+   * @see precondition
+   */
+  template <detail::contract_expression T>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  constexpr void audit_precondition(
+    T&& expression,
+    std::string_view message = "Precondition violated",
+    std::source_location location = std::source_location::current()
+  ) {
+    checks<global_level>::audit_precondition(std::forward<T>(expression), message, location);
+  }
+
+  /**
+   * @brief Formatted overload of @ref audit_precondition: the message is formatted only if the check fails.
+   * @param expression Precondition expression or a callable returning it.
+   * @param message Format string of the violation message, checked at compile time.
+   * @param args Format arguments.
+   */
+  template <detail::contract_expression T, typename... Args>
+  requires detail::format_arguments<Args...>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  constexpr void audit_precondition(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+    checks<global_level>::audit_precondition(std::forward<T>(expression), message, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Checks an expensive <i>postcondition</i> if audit checks are enabled.
+   * @details Pass the expression as a callable: it is not evaluated unless @ref global_level is
+   * @ref contract_level::audit.
+   * @param expression Postcondition expression or a callable returning it.
+   * @param message Violation message. Defaults to <code>"Postcondition violated"</code>.
+   * @param location Violation location in source code. Defaults to current location.
+   * @see postcondition
+   */
+  template <detail::contract_expression T>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  constexpr void audit_postcondition(
+    T&& expression,
+    std::string_view message = "Postcondition violated",
+    std::source_location location = std::source_location::current()
+  ) {
+    checks<global_level>::audit_postcondition(std::forward<T>(expression), message, location);
+  }
+
+  /**
+   * @brief Formatted overload of @ref audit_postcondition: the message is formatted only if the check fails.
+   * @param expression Postcondition expression or a callable returning it.
+   * @param message Format string of the violation message, checked at compile time.
+   * @param args Format arguments.
+   */
+  template <detail::contract_expression T, typename... Args>
+  requires detail::format_arguments<Args...>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  constexpr void audit_postcondition(T&& expression, detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+    checks<global_level>::audit_postcondition(std::forward<T>(expression), message, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Checks a <i>invariant</i> on one in @ref sampling_rate calls of the call site.
+   * @details The rate is global and can be changed at runtime with @ref set_sampling_rate.
+   * @param expression Invariant expression or a callable returning it.
+   * @param message Violation message. Defaults to <code>"Invariant violated"</code>.
+   * @param location Violation location in source code. Defaults to current location.
+   * @see invariant
+   */
+  template <detail::contract_expression T>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  inline void sampled_invariant(
+    T&& expression,
+    std::string_view message = "Invariant violated",
+    std::source_location location = std::source_location::current()
+  ) {
+    checks<global_level>::sampled_invariant(std::forward<T>(expression), message, location);
+  }
+
+  /**
+   * @brief Checks a <i>precondition</i> on one in @ref sampling_rate calls of the call site.
+   * @details The rate is global and can be changed at runtime with @ref set_sampling_rate.
+   * @param expression Precondition expression or a callable returning it.
+   * @param message Violation message. Defaults to <code>"Precondition violated"</code>.
+   * @param location Violation location in source code. Defaults to current location.
+   * @see precondition
+   */
+  template <detail::contract_expression T>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  inline void sampled_precondition(
+    T&& expression,
+    std::string_view message = "Precondition violated",
+    std::source_location location = std::source_location::current()
+  ) {
+    checks<global_level>::sampled_precondition(std::forward<T>(expression), message, location);
+  }
+
+  /**
+   * @brief Checks a <i>postcondition</i> on one in @ref sampling_rate calls of the call site.
+   * @details The rate is global and can be changed at runtime with @ref set_sampling_rate.
+   * @param expression Postcondition expression or a callable returning it.
+   * @param message Violation message. Defaults to <code>"Postcondition violated"</code>.
+   * @param location Violation location in source code. Defaults to current location.
+   * @see postcondition
+   */
+  template <detail::contract_expression T>
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  inline void sampled_postcondition(
+    T&& expression,
+    std::string_view message = "Postcondition violated",
+    std::source_location location = std::source_location::current()
+  ) {
+    checks<global_level>::sampled_postcondition(std::forward<T>(expression), message, location);
   }
 
   /**
    * @brief Invokes the global contract violation handler (see @ref violation_handler) with a broken invariant violation.
-   * @details If the expression is false, the contract violation is thrown with the given message and location.
-   * @note The expression is only evaluated in debug mode. In release mode this function is a no-op.
+   * @note Never returns, even if contracts are turned off or observed.
    * @param message Violation message. Defaults to <code>"Broken invariant"</code>.
+   * @param location Violation location in source code. Defaults to current location.
    * @see invariant
    */
+  [[noreturn]]
   #ifndef FL_DOC
   ___inline___
-  ___fl_release_consteval___
   #endif // FL_DOC
-  void broken_invariant(
-    #ifndef FL_DOC
-    ___fl_release_unused___
-    #endif // FL_DOC
+  inline void broken_invariant(
     std::string_view message = "Broken invariant",
-    #ifndef FL_DOC
-    ___fl_release_unused___ std::source_location location = std::source_location::current()
-    #endif // FL_DOC
+    std::source_location location = std::source_location::current()
   ) {
-    ___fl_debug_only___(detail::violate(contract_type::invariant, message, location));
+    checks<global_level>::broken_invariant(message, location);
+  }
+
+  /**
+   * @brief Formatted overload of @ref broken_invariant.
+   * @param message Format string of the violation message, checked at compile time.
+   * @param args Format arguments.
+   */
+  template <typename... Args>
+  requires detail::format_arguments<Args...>
+  [[noreturn]]
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  void broken_invariant(detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+    checks<global_level>::broken_invariant(message, std::forward<Args>(args)...);
   }
 
   /**
    * @brief Invokes the global contract violation handler (see @ref violation_handler) with a broken precondition violation.
+   * @note Never returns, even if contracts are turned off or observed.
    * @param message Violation message. Defaults to <code>"Broken precondition"</code>.
+   * @param location Violation location in source code. Defaults to current location.
    * @see precondition
    */
+  [[noreturn]]
   #ifndef FL_DOC
   ___inline___
-  ___fl_release_consteval___
   #endif // FL_DOC
-  void broken_precondition(
-    #ifndef FL_DOC
-    ___fl_release_unused___
-    #endif // FL_DOC
+  inline void broken_precondition(
     std::string_view message = "Broken precondition",
-    #ifndef FL_DOC
-    ___fl_release_unused___
-   std::source_location location = std::source_location::current()
-    #endif // FL_DOC
+    std::source_location location = std::source_location::current()
   ) {
-    ___fl_debug_only___(detail::violate(contract_type::precondition, message, location));
+    checks<global_level>::broken_precondition(message, location);
+  }
+
+  /**
+   * @brief Formatted overload of @ref broken_precondition.
+   * @param message Format string of the violation message, checked at compile time.
+   * @param args Format arguments.
+   */
+  template <typename... Args>
+  requires detail::format_arguments<Args...>
+  [[noreturn]]
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  void broken_precondition(detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+    checks<global_level>::broken_precondition(message, std::forward<Args>(args)...);
   }
 
   /**
    * @brief Invokes the global contract violation handler (see @ref violation_handler) with a broken postcondition violation.
+   * @note Never returns, even if contracts are turned off or observed.
    * @param message Violation message. Defaults to <code>"Broken postcondition"</code>.
+   * @param location Violation location in source code. Defaults to current location.
    * @see postcondition
    */
+  [[noreturn]]
   #ifndef FL_DOC
   ___inline___
-  ___fl_release_consteval___
   #endif // FL_DOC
-  void broken_postcondition(
-    #ifndef FL_DOC
-    ___fl_release_unused___
-    #endif // FL_DOC
+  inline void broken_postcondition(
     std::string_view message = "Broken postcondition",
-    #ifndef FL_DOC
-    ___fl_release_unused___ std::source_location location = std::source_location::current()
-    #endif // FL_DOC
+    std::source_location location = std::source_location::current()
   ) {
-    ___fl_debug_only___(detail::violate(contract_type::postcondition, message, location));
+    checks<global_level>::broken_postcondition(message, location);
+  }
+
+  /**
+   * @brief Formatted overload of @ref broken_postcondition.
+   * @param message Format string of the violation message, checked at compile time.
+   * @param args Format arguments.
+   */
+  template <typename... Args>
+  requires detail::format_arguments<Args...>
+  [[noreturn]]
+  #ifndef FL_DOC
+  ___inline___
+  #endif // FL_DOC
+  void broken_postcondition(detail::formatted_message<std::type_identity_t<Args>...> message, Args&&... args) {
+    checks<global_level>::broken_postcondition(message, std::forward<Args>(args)...);
   }
 
   /**
    * @brief Invokes the global contract violation handler (see @ref violation_handler) with a broken invariant violation.
    * @details Useful for marking a function as <i>unimplemented</i>.
-   * @note The expression is only evaluated in debug mode. In release mode this function is a no-op.
+   * @note Never returns, even if contracts are turned off or observed.
+   * @param location Violation location in source code. Defaults to current location.
    * @see invariant
    */
+  [[noreturn]]
   #ifndef FL_DOC
   ___inline___
-  ___fl_release_consteval___
   #endif // FL_DOC
-  void not_implemented(
-    #ifndef FL_DOC
-    ___fl_release_unused___ std::source_location location = std::source_location::current()
-    #endif // FL_DOC
-  ) {
-    ___fl_debug_only___(detail::violate(contract_type::invariant, "Reached unimplemented code", location));
+  inline void not_implemented(std::source_location location = std::source_location::current()) {
+    checks<global_level>::broken_invariant("Reached unimplemented code", location);
   }
-} // namespace fl::contracts
+} // namespace fl::contracts
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "../contracts.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  template <typename Signature, usize Capacity = 48>
+  class inplace_function;
+
+  /**
+   * @brief Move-only type-erased callable with fixed inline storage.
+   * @details Behaves like <code>std::move_only_function</code>, but never allocates: the callable is
+   * stored inside the object itself. Callables that do not fit into <code>Capacity</code> bytes
+   * are rejected at compile time.
+   *
+   * Useful for storing many small callbacks in preallocated memory (timers, queues, channels).
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto counter = 0;
+   *    auto f = fl::inplace_function<void(int)>([&counter](int x) { counter += x; });
+   *    f(5); // counter == 5
+   * @endcode
+   * @tparam R Return type.
+   * @tparam Args Argument types.
+   * @tparam Capacity Size of the inline storage in bytes.
+   */
+  template <typename R, typename... Args, usize Capacity>
+  class inplace_function<R(Args...), Capacity>
+  {
+    struct vtable
+    {
+      R (*invoke)(void*, Args&&...);
+      void (*move)(void* dst, void* src) noexcept;
+      void (*destroy)(void*) noexcept;
+    };
+
+    template <typename F>
+    static constexpr vtable vtable_for = {
+      .invoke = [](void* self, Args&&... args) -> R {
+        return std::invoke(*static_cast<F*>(self), std::forward<Args>(args)...);
+      },
+      .move = [](void* dst, void* src) noexcept {
+        ::new(dst) F(std::move(*static_cast<F*>(src)));
+        static_cast<F*>(src)->~F();
+      },
+      .destroy = [](void* self) noexcept { static_cast<F*>(self)->~F(); }
+    };
+
+   public:
+    /**
+     * @brief Size of the inline storage in bytes.
+     */
+    static constexpr usize capacity = Capacity;
+
+    /**
+     * @brief Creates an empty function.
+     */
+    inplace_function() noexcept = default;
+
+    /**
+     * @brief Creates an empty function.
+     */
+    inplace_function(std::nullptr_t) noexcept {} // NOLINT(*-explicit-constructor)
+
+    /**
+     * @brief Creates a function from the given callable.
+     * @tparam F Callable type. Must be nothrow move constructible and fit into the inline storage.
+     * @param f Callable.
+     */
+    template <typename F>
+    requires (not std::is_same_v<std::remove_cvref_t<F>, inplace_function>)
+      and std::is_invocable_r_v<R, std::decay_t<F>&, Args...>
+    inplace_function(F&& f) // NOLINT(*-explicit-constructor, *-forwarding-reference-overload)
+      : vtable_(&vtable_for<std::decay_t<F>>)
+    {
+      using callable = std::decay_t<F>;
+      static_assert(sizeof(callable) <= Capacity, "callable does not fit into inplace_function storage");
+      static_assert(alignof(callable) <= alignof(std::max_align_t), "callable is over-aligned");
+      static_assert(std::is_nothrow_move_constructible_v<callable>, "callable must be nothrow move constructible");
+      ::new(static_cast<void*>(&this->storage_)) callable(std::forward<F>(f));
+    }
+
+    /**
+     * @brief Moves the callable from another function, leaving it empty.
+     */
+    inplace_function(inplace_function&& other) noexcept
+      : vtable_(std::exchange(other.vtable_, nullptr))
+    {
+      if(this->vtable_ != nullptr)
+        this->vtable_->move(&this->storage_, &other.storage_);
+    }
+
+    /**
+     * @brief Moves the callable from another function, leaving it empty.
+     */
+    inplace_function& operator=(inplace_function&& other) noexcept {
+      if(this != &other) {
+        this->reset();
+        this->vtable_ = std::exchange(other.vtable_, nullptr);
+        if(this->vtable_ != nullptr)
+          this->vtable_->move(&this->storage_, &other.storage_);
+      }
+      return *this;
+    }
+
+    inplace_function(inplace_function const&) = delete;
+    inplace_function& operator=(inplace_function const&) = delete;
+
+    /**
+     * @brief Destroys the stored callable.
+     */
+    ~inplace_function() { this->reset(); }
+
+    /**
+     * @brief Destroys the stored callable, leaving the function empty.
+     */
+    void reset() noexcept {
+      if(this->vtable_ != nullptr)
+        std::exchange(this->vtable_, nullptr)->destroy(&this->storage_);
+    }
+
+    /**
+     * @brief Returns <code>true</code> if the function holds a callable.
+     */
+    [[nodiscard]] explicit operator bool() const noexcept { return this->vtable_ != nullptr; }
+
+    /**
+     * @brief Invokes the stored callable.
+     * @note Invoking an empty function is a precondition violation.
+     */
+    R operator()(Args... args) {
+      if(this->vtable_ == nullptr)
+        contracts::broken_precondition("invoking empty inplace_function");
+      return this->vtable_->invoke(&this->storage_, std::forward<Args>(args)...);
+    }
+
+   private:
+    vtable const* vtable_ = nullptr;
+    alignas(std::max_align_t) std::byte storage_[Capacity]; // NOLINT(*-avoid-c-arrays, *-member-init)
+  };
+} // namespace fl
\ No newline at end of file
@@ -39,6 +39,44 @@
  */
 # define FL_NO_DEBUG
 
+/**
+ * @ingroup macros
+ * @brief Global contract checking level: <code>0</code> (off), <code>1</code> (default) or <code>2</code> (audit).
+ * @details Selects which contract checks are compiled in, see <code>fl::contracts::contract_level</code>.
+ * Defaults to <code>1</code> in both debug and release builds, so cheap checks stay enabled in
+ * release. Set with the <code>FLOPPY_CONTRACT_LEVEL</code> CMake option; the value must be the
+ * same in the whole program.
+ */
+# define FL_CONTRACT_LEVEL 1
+
+/**
+ * @ingroup macros
+ * @brief Global contract semantic: <code>0</code> (enforce) or <code>1</code> (observe).
+ * @details Selects what failed contract checks do, see <code>fl::contracts::contract_semantic</code>.
+ * Defaults to <code>0</code>: violations invoke the violation handler. With <code>1</code>, violations
+ * are counted per call site and the program continues. Set with the <code>FLOPPY_CONTRACT_SEMANTIC</code>
+ * CMake option.
+ */
+# define FL_CONTRACT_SEMANTIC 0
+
+/**
+ * @ingroup macros
+ * @brief Lowest log level compiled in: <code>0</code> (trace) to <code>6</code> (off), see <code>fl::log::level</code>.
+ * @details Log calls of lower levels are removed at compile time, see <code>fl::log::compiled_level</code>.
+ * Defaults to <code>0</code> with @ref FL_DEBUG and to <code>2</code> (info) with @ref FL_NO_DEBUG,
+ * which is also the default runtime level. Set with the <code>FLOPPY_LOG_LEVEL</code> CMake option.
+ */
+# define FL_LOG_LEVEL 0
+
+/**
+ * @ingroup macros
+ * @brief Flag defined if the code is compiled with <b>frame pointers</b>.
+ * @details Set with the <code>FLOPPY_FRAME_POINTERS</code> CMake option, which also adds
+ * <code>-fno-omit-frame-pointer</code> to the compile options. Stack traces are then captured by
+ * walking the frame pointer chain instead of reading unwind tables.
+ */
+# define FL_FRAME_POINTERS
+
 /**
  * @ingroup macros
  * @brief Attribute macro intended for <b>no inlining</b> functions.
@@ -75,6 +113,22 @@
  * @see ___noinline___
  */
 # define ___inline___
+
+/**
+ * @ingroup macros
+ * @brief Attribute macro intended for marking <b>rarely executed</b> functions.
+ * @details Tells the compiler that the function is unlikely to be called, so calls to it are
+ * moved out of hot code paths and the function itself is optimized for size. Intended for error
+ * reporting paths, such as contract violations.
+ *
+ * Example usage:
+ *
+ * @code {.cpp}
+ *  ___cold___ ___noinline___ void report_error(std::string_view message);
+ * @endcode
+ * @see ___noinline___
+ */
+# define ___cold___
 #else // DOXYGEN_GENERATING_OUTPUT
 # if defined(QT_CORE_LIB) || __has_include("qtglobal.h") || __has_include("qcoreapplication.h") || defined(DOXYGEN_GENERATING_OUTPUT)
 #  define FL_QT_CORE
@@ -87,13 +141,28 @@
 # else
 #  define FL_DEBUG
 # endif
+# if !defined(FL_CONTRACT_LEVEL)
+#  define FL_CONTRACT_LEVEL 1
+# endif
+# if !defined(FL_CONTRACT_SEMANTIC)
+#  define FL_CONTRACT_SEMANTIC 0
+# endif
+# if !defined(FL_LOG_LEVEL)
+#  if defined(FL_DEBUG)
+#   define FL_LOG_LEVEL 0
+#  else
+#   define FL_LOG_LEVEL 2
+#  endif
+# endif
 // NOLINTBEGIN(*-reserved-identifier, *-identifier-naming, *-macro-usage)
 # if defined(FL_COMPILER_MSVC)
 #   define ___noinline___ __declspec(noinline)
 #   define ___inline___ __forceinline
+#   define ___cold___
 # else
 #   define ___noinline___ __attribute__((noinline))
 #   define ___inline___ __attribute__((always_inline))
+#   define ___cold___ __attribute__((cold))
 # endif
 # if defined(FL_DEBUG)
 #   define ___fl_debug_only___(...) __VA_ARGS__
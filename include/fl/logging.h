@@ -0,0 +1,815 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <memory>
+#include <source_location>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "global/definitions.h"
+#include "global/export.h"
+#include "types/stdint.h"
+
+/**
+ * @brief Logging facade with an optional asynchronous backend.
+ * @details Log calls do not format their message. They copy the raw bytes of their arguments and
+ * a reference to their @ref fl::log::call_site "call site", and the message is formatted when the
+ * record is written to the current @ref fl::log::sink "sink". By default records are written
+ * synchronously to the sinks of the default <b>spdlog</b> logger.
+ *
+ * After @ref fl::log::start_async, each thread pushes its records into its own lock-free ring and
+ * a single background thread drains all rings, merges their records by timestamp, formats them
+ * and writes them to the sink in batches, so log calls neither format nor wait for the sink or the
+ * disk.
+ *
+ * Log arguments must be trivially copyable, or convertible to <code>std::string_view</code>, in
+ * which case the characters are copied. Arguments can also be callables without parameters, which
+ * are invoked only if the record is logged.
+ *
+ * Calls below @ref fl::log::compiled_level are removed at compile time, and calls above it check
+ * the runtime level before they evaluate lazy arguments.
+ *
+ * Noisy call sites can be limited with @ref fl::log::log_every, @ref fl::log::log_rate and
+ * @ref fl::log::once. The next logged record of a limited site reports how many were suppressed.
+ *
+ * Structured key-value fields, created with @ref fl::kv, follow the format arguments. They are
+ * encoded in binary like the arguments, and sinks read them with @ref fl::log::visit_fields
+ * instead of parsing the message, e.g. @ref fl::log::json_lines_sink.
+ * @code {.cpp}
+ * fl::log::start_async({ .overflow = fl::log::overflow_policy::drop_oldest });
+ * fl::log::info("listening on port {}", port);
+ * fl::log::debug("routing table: {}", [&] { return table.dump(); }); // dumped only if debug is enabled
+ * fl::log::stop_async();
+ * @endcode
+ */
+namespace fl::log
+{
+  /**
+   * @brief Severity of a log record.
+   */
+  enum class level : u8
+  {
+    trace,    ///< Detailed tracing.
+    debug,    ///< Debugging information.
+    info,     ///< Normal operation.
+    warn,     ///< Unexpected, but handled situation.
+    err,      ///< Failed operation.
+    critical, ///< Failure which affects the whole program.
+    off       ///< Disables logging when used as the minimum level.
+  };
+
+  /**
+   * @brief Lowest level compiled in, selected with @ref FL_LOG_LEVEL.
+   * @details Log calls of lower levels compile to nothing. Their lazy arguments are never invoked,
+   * but other argument expressions are still evaluated, as with any function call.
+   */
+  inline constexpr auto compiled_level = static_cast<level>(FL_LOG_LEVEL);
+
+  /**
+   * @brief Formats a message from encoded arguments.
+   * @param format Format string of the call site.
+   * @param arguments Arguments encoded by the log call.
+   * @param message Destination of the message.
+   * @return Size of the message, at most the size of the destination.
+   */
+  using decoder = usize (*)(std::string_view format, std::span<std::byte const> arguments, std::span<char> message);
+
+  /**
+   * @brief Value of a structured field.
+   * @details Booleans, integers, enumerations, floating-point numbers and strings keep their type.
+   * Other values are passed as formatted text.
+   */
+  using field_value = std::variant<bool, i64, u64, double, std::string_view>;
+
+  /**
+   * @brief Type-erased callback for the structured fields of a record.
+   * @see visit_fields
+   */
+  struct field_visitor
+  {
+    void* context = nullptr;                                                                ///< State of the callback.
+    void (*visit)(void* context, std::string_view key, field_value const& value) = nullptr; ///< Callback.
+  };
+
+  /**
+   * @brief Passes the structured fields in encoded arguments to a visitor, in argument order.
+   */
+  using field_decoder = void (*)(std::span<std::byte const> arguments, field_visitor visitor);
+
+  /**
+   * @brief Static description of a log call.
+   * @details The format string and the location refer to static storage, so records need to copy
+   * only this descriptor and the encoded arguments.
+   */
+  struct call_site
+  {
+    std::string_view format = {};        ///< Format string.
+    std::source_location location = {};  ///< Location of the log call.
+    decoder decode = nullptr;            ///< Formats the encoded arguments of the call.
+    field_decoder fields = nullptr;      ///< Visits the structured fields of the call. Null if it has none.
+  };
+
+  /**
+   * @brief Structured key-value field of a log call, created with @ref fl::kv.
+   * @details Fields follow the format arguments of a log call. They are encoded with the arguments
+   * and are not part of the formatted message.
+   * @tparam T Type of the value. Strings are referenced as <code>std::string_view</code> until the
+   * log call copies them.
+   */
+  template <typename T>
+  struct field
+  {
+    std::string_view key = {}; ///< Key.
+    T value = {};              ///< Value.
+  };
+
+  /**
+   * @brief Log record as seen by a @ref sink.
+   */
+  struct record
+  {
+    level severity = level::info;                    ///< Severity.
+    std::chrono::system_clock::time_point time = {}; ///< Time of the log call.
+    u64 thread = 0;                                  ///< Sequential ID of the logging thread.
+    std::source_location location = {};              ///< Location of the log call.
+    std::string_view message = {};                   ///< Formatted message. Valid only during the sink call.
+    call_site const* site = nullptr;                 ///< Call site. Valid only during the sink call.
+    std::span<std::byte const> arguments = {};       ///< Encoded arguments. Valid only during the sink call.
+    u64 suppressed = 0;                              ///< Records of a limited call site suppressed before this one.
+  };
+
+  /**
+   * @brief Destination of log records.
+   * @details Called with batches of records ordered by time. Calls are serialized.
+   */
+  using sink = std::function<void(std::span<record const>)>;
+
+  /**
+   * @brief What a log call does when the ring of its thread is full.
+   * @see async_options
+   */
+  enum class overflow_policy : u8
+  {
+    block,       ///< Waits until the background thread makes room. Nothing is lost.
+    drop_newest, ///< Discards the new record. The log call never waits.
+    drop_oldest  ///< Overwrites the oldest unread record. The log call never waits.
+  };
+
+  /**
+   * @brief Settings of the asynchronous backend.
+   * @see start_async
+   */
+  struct async_options
+  {
+    /// Number of records each thread can buffer. Rounded up to a power of two.
+    usize capacity = 1'024;
+
+    /// Behavior of log calls when the ring of their thread is full.
+    overflow_policy overflow = overflow_policy::block;
+
+    /// Longest time a record waits in a ring before it is written.
+    std::chrono::milliseconds flush_interval = std::chrono::milliseconds(10);
+  };
+
+  /**
+   * @brief Counters of the asynchronous backend, accumulated since the program started.
+   */
+  struct async_statistics
+  {
+    u64 written = 0;        ///< Records passed to the sink.
+    u64 dropped_newest = 0; ///< Records discarded with @ref overflow_policy::drop_newest.
+    u64 dropped_oldest = 0; ///< Records overwritten with @ref overflow_policy::drop_oldest.
+    u64 blocked = 0;        ///< Log calls which waited with @ref overflow_policy::block.
+  };
+
+  /**
+   * @brief Longest formatted message. Longer messages are truncated and end with <code>"..."</code>.
+   */
+  inline constexpr auto max_message_size = usize(224);
+
+  /**
+   * @brief Largest size of the encoded arguments of a log call.
+   * @details Strings are shortened so that all arguments fit. Larger fixed-size arguments fail to compile.
+   */
+  inline constexpr auto max_argument_size = usize(184);
+
+  /**
+   * @brief Replaces the sink.
+   * @details An empty sink restores the default one, which writes to the sinks of the default
+   * <b>spdlog</b> logger.
+   * @param destination New sink.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void set_sink(sink destination);
+
+  /**
+   * @brief Sets the minimum level of records which are logged.
+   * @param minimum Minimum level. @ref level::off disables logging.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void set_level(level minimum) noexcept;
+
+  /**
+   * @brief Returns the minimum level of records which are logged. Defaults to @ref level::info.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  level current_level() noexcept;
+
+  /**
+   * @brief Starts the asynchronous backend.
+   * @details Threads get their rings on their first log call. Restarting with other options
+   * replaces the rings once the old ones are drained.
+   * @param options Ring capacity, overflow policy and flush interval.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void start_async(async_options const& options = {});
+
+  /**
+   * @brief Writes all buffered records and stops the background thread.
+   * @details Log calls become synchronous again. Records logged concurrently with this call may
+   * stay buffered until the backend is started again.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void stop_async();
+
+  /**
+   * @brief Waits until the records logged by this thread before the call are written to the sink.
+   * @details Does nothing if the asynchronous backend is not running.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void flush();
+
+  /**
+   * @brief Returns the counters of the asynchronous backend.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  async_statistics statistics() noexcept;
+
+  /**
+   * @brief Returns a sink which writes records as JSON lines.
+   * @details Each record becomes one JSON object with the time in nanoseconds since the Unix epoch,
+   * the level, the thread, the source file and line, the message, the number of suppressed records
+   * if any, and the structured fields as members. Records of a batch are encoded into a buffer which
+   * is reused between batches, and written with a single call.
+   * @code {.cpp}
+   * fl::log::set_sink(fl::log::json_lines_sink(stdout));
+   * fl::log::info("request done", fl::kv("latency_us", us), fl::kv("bytes", n));
+   * // {"time":1760000000000000000,"level":"info",...,"message":"request done","latency_us":42,"bytes":512}
+   * @endcode
+   * @param file Destination, flushed after each batch. Must outlive the sink.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  sink json_lines_sink(std::FILE* file);
+
+  namespace detail
+  {
+    /**
+     * @brief Format string of a log call together with its location.
+     * @details Implicitly constructed from a string literal at the call site, which captures the
+     * location before the variadic arguments. The format string is checked at compile time.
+     * @tparam Args Types of the format arguments.
+     */
+    template <typename... Args>
+    struct format_with_location
+    {
+      /**
+       * @brief Constructs the format string.
+       * @param format Format string, checked against <tt>Args</tt> at compile time.
+       * @param location Location of the log call. Defaults to current location.
+       */
+      template <typename S>
+      requires std::convertible_to<S const&, std::string_view>
+      consteval format_with_location( // NOLINT(*-explicit-constructor)
+        S const& format,
+        std::source_location location = std::source_location::current()
+      )
+        : format(format)
+        , location(location) {
+        static_cast<void>(std::format_string<Args...>(format));
+      }
+
+      std::string_view format;       ///< Format string.
+      std::source_location location; ///< Location of the log call.
+    };
+
+    /**
+     * @brief Log argument which is invoked to get the logged value, only if the record is logged.
+     */
+    template <typename T>
+    concept lazy_argument = std::invocable<T&> and not std::is_void_v<std::invoke_result_t<T&>>;
+
+    /**
+     * @brief Logged type of an argument: the result type of lazy arguments.
+     */
+    template <typename T>
+    struct evaluated
+    {
+      using type = T;
+    };
+
+    template <lazy_argument T>
+    struct evaluated<T>
+    {
+      using type = std::invoke_result_t<T&>;
+    };
+
+    template <typename T>
+    using evaluated_t = typename evaluated<T>::type;
+
+    /**
+     * @brief Returns the logged value of an argument, invoking lazy arguments.
+     */
+    template <typename T>
+    auto evaluate(T& argument) -> decltype(auto) {
+      if constexpr(lazy_argument<T>)
+        return std::invoke(argument);
+      else
+        return (argument);
+    }
+
+    template <typename T>
+    inline constexpr bool is_field = false;
+
+    template <typename T>
+    inline constexpr bool is_field<field<T>> = true;
+
+    /**
+     * @brief Builds the format string type of a log call from its format arguments, skipping fields.
+     */
+    template <typename Format, typename... Args>
+    struct format_for_arguments
+    {
+      using type = Format;
+    };
+
+    template <typename... Done, typename T, typename... Rest>
+    struct format_for_arguments<format_with_location<Done...>, T, Rest...>
+      : std::conditional_t<
+          is_field<std::remove_cvref_t<T>>,
+          format_for_arguments<format_with_location<Done...>, Rest...>,
+          format_for_arguments<format_with_location<Done..., evaluated_t<T>>, Rest...>
+        >
+    {};
+
+    /**
+     * @brief Format string of a log call with the given arguments.
+     */
+    template <typename... Args>
+    using format_for = typename format_for_arguments<format_with_location<>, Args...>::type;
+
+    /**
+     * @brief Log argument which is copied as characters.
+     */
+    template <typename T>
+    concept string_argument = std::convertible_to<T const&, std::string_view>;
+
+    /**
+     * @brief Encoding of a log argument.
+     * @details Trivially copyable arguments are copied as they are.
+     */
+    template <typename T>
+    struct argument_traits
+    {
+      static_assert(
+        std::is_trivially_copyable_v<T>,
+        "log arguments must be trivially copyable or convertible to std::string_view"
+      );
+
+      using decoded_type = T;
+      static constexpr auto fixed_size = sizeof(T);
+
+      static auto encode(std::byte*& position, usize&, T const& value) noexcept -> void {
+        std::memcpy(position, std::addressof(value), sizeof(T));
+        position += sizeof(T);
+      }
+
+      static auto decode(std::byte const*& position) noexcept -> T {
+        auto raw = std::array<std::byte, sizeof(T)>();
+        std::memcpy(raw.data(), position, sizeof(T));
+        position += sizeof(T);
+        return std::bit_cast<T>(raw);
+      }
+    };
+
+    /**
+     * @brief Encoding of a string argument: size as <tt>u32</tt>, followed by the characters.
+     * @details Decoded as <code>std::string_view</code> into the encoded bytes. Shortened strings
+     * end with <code>"..."</code>.
+     */
+    template <string_argument T>
+    struct argument_traits<T>
+    {
+      using decoded_type = std::string_view;
+      static constexpr auto fixed_size = sizeof(u32);
+
+      static auto encode(std::byte*& position, usize& available, T const& value) noexcept -> void {
+        auto view = std::string_view();
+        if constexpr(std::is_pointer_v<T>) {
+          if(value != nullptr)
+            view = value;
+        } else
+          view = value;
+        auto const size = static_cast<u32>(std::min(view.size(), available));
+        available -= size;
+        std::memcpy(position, &size, sizeof(size));
+        if(size != 0)
+          std::memcpy(position + sizeof(size), view.data(), size);
+        if(size < view.size() and size >= 3)
+          std::memset(position + sizeof(size) + size - 3, '.', 3);
+        position += sizeof(size) + size;
+      }
+
+      static auto decode(std::byte const*& position) noexcept -> std::string_view {
+        auto size = u32(0);
+        std::memcpy(&size, position, sizeof(size));
+        auto const* const characters = reinterpret_cast<char const*>(position + sizeof(size)); // NOLINT(*-reinterpret-cast)
+        position += sizeof(size) + size;
+        return { characters, size };
+      }
+    };
+
+    /**
+     * @brief Encoding of a structured field: the key as a string, followed by the value.
+     */
+    template <typename T>
+    struct argument_traits<field<T>>
+    {
+      using key_traits = argument_traits<std::string_view>;
+      using value_traits = argument_traits<T>;
+      using decoded_type = field<typename value_traits::decoded_type>;
+      static constexpr auto fixed_size = key_traits::fixed_size + value_traits::fixed_size;
+
+      static auto encode(std::byte*& position, usize& available, field<T> const& value) noexcept -> void {
+        key_traits::encode(position, available, value.key);
+        value_traits::encode(position, available, value.value);
+      }
+
+      static auto decode(std::byte const*& position) noexcept -> decoded_type {
+        auto const key = key_traits::decode(position);
+        return { .key = key, .value = value_traits::decode(position) };
+      }
+    };
+
+    /**
+     * @brief Formats type-erased arguments, truncating the message to the destination.
+     * @return Size of the message.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    usize format_message(std::string_view format, std::format_args arguments, std::span<char> message) noexcept;
+
+    /**
+     * @brief Converts a decoded field value, formatting other types into <tt>text</tt>.
+     */
+    template <typename T>
+    auto to_field_value(T const& value, std::span<char> text) -> field_value {
+      if constexpr(std::same_as<T, bool> or std::same_as<T, std::string_view>)
+        return value;
+      else if constexpr(std::same_as<T, char>)
+        return std::string_view(&value, 1);
+      else if constexpr(std::is_enum_v<T>)
+        return to_field_value(static_cast<std::underlying_type_t<T>>(value), text);
+      else if constexpr(std::signed_integral<T>)
+        return static_cast<i64>(value);
+      else if constexpr(std::unsigned_integral<T>)
+        return static_cast<u64>(value);
+      else if constexpr(std::floating_point<T>)
+        return static_cast<double>(value);
+      else
+        return std::string_view(text.data(), format_message("{}", std::make_format_args(value), text));
+    }
+
+    template <typename T>
+    auto visit_field(T const&, field_visitor) -> void {}
+
+    template <typename T>
+    auto visit_field(field<T> const& f, field_visitor visitor) -> void {
+      auto text = std::array<char, 64>();
+      visitor.visit(visitor.context, f.key, to_field_value(f.value, text));
+    }
+
+    /**
+     * @brief Encoding of the arguments of a log call.
+     * @details Fixed-size parts are reserved first; strings share the rest of
+     * @ref max_argument_size in argument order. Structured fields follow the format arguments.
+     */
+    template <typename... Args>
+    struct argument_list
+    {
+      static constexpr auto reserved = (argument_traits<Args>::fixed_size + ... + usize(0));
+      static_assert(reserved <= max_argument_size, "log arguments do not fit into a record");
+
+      /// Number of format arguments.
+      static constexpr auto positional = (usize(not is_field<Args>) + ... + usize(0));
+      static constexpr auto has_fields = positional != sizeof...(Args);
+      static_assert(
+        []<usize... I>(std::index_sequence<I...>) {
+          return (not is_field<std::tuple_element_t<I, std::tuple<Args...>>> and ...);
+        }(std::make_index_sequence<positional>()),
+        "structured fields must follow the format arguments"
+      );
+
+      static auto encode(std::span<std::byte, max_argument_size> bytes, Args const&... args) noexcept -> usize {
+        auto* position = bytes.data();
+        [[maybe_unused]] auto available = max_argument_size - reserved;
+        (argument_traits<Args>::encode(position, available, args), ...);
+        return static_cast<usize>(position - bytes.data());
+      }
+
+      static auto decode(std::string_view format, std::span<std::byte const> arguments, std::span<char> message) -> usize {
+        auto values = argument_list::decode_values(arguments);
+        return [&]<usize... I>(std::index_sequence<I...>) {
+          return format_message(format, std::make_format_args(std::get<I>(values)...), message);
+        }(std::make_index_sequence<positional>());
+      }
+
+      static auto visit(std::span<std::byte const> arguments, field_visitor visitor) -> void {
+        auto const values = argument_list::decode_values(arguments);
+        std::apply([&](auto const&... v) { (visit_field(v, visitor), ...); }, values);
+      }
+
+     private:
+      static auto decode_values(std::span<std::byte const> arguments) {
+        [[maybe_unused]] auto const* position = arguments.data();
+        // braced initialization decodes the arguments in order
+        return std::tuple<typename argument_traits<Args>::decoded_type...> {
+          argument_traits<Args>::decode(position)...
+        };
+      }
+    };
+
+    /**
+     * @brief Passes an encoded record to the asynchronous backend or the sink.
+     * @param severity Severity.
+     * @param site Call site.
+     * @param arguments Encoded arguments, at most @ref max_argument_size bytes.
+     * @param suppressed Records of the call site suppressed before this one.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void write(level severity, call_site const& site, std::span<std::byte const> arguments, u64 suppressed = 0);
+
+    /**
+     * @brief Encodes the arguments of a log call into a stack buffer and writes the record.
+     */
+    template <typename... Args>
+    void encode_and_write(level severity, std::string_view format, std::source_location const& location, u64 suppressed, Args const&... args) {
+      using list = argument_list<Args...>;
+      std::array<std::byte, max_argument_size> bytes; // NOLINT(*-member-init)
+      auto const size = list::encode(bytes, args...);
+      auto const site = call_site {
+        .format = format,
+        .location = location,
+        .decode = &list::decode,
+        .fields = list::has_fields ? &list::visit : nullptr
+      };
+      write(severity, site, std::span(bytes.data(), size), suppressed);
+    }
+
+    /**
+     * @brief Kind of limit of a call site.
+     */
+    enum class limit : u8
+    {
+      every, ///< Every n-th call is logged.
+      rate,  ///< Calls are logged at a steady rate, with bursts of up to one second.
+      once   ///< Only the first call is logged.
+    };
+
+    /**
+     * @brief Outcome of a limited call.
+     */
+    struct admission
+    {
+      bool logged = false; ///< The call is logged.
+      u64 suppressed = 0;  ///< Calls of the site suppressed since the last logged one.
+    };
+
+    /**
+     * @brief Updates the lock-free state of a limited call site.
+     * @details Call sites are tracked in a fixed table. If it is full, calls of new sites are not limited.
+     * @param kind Kind of limit. A call site must always use the same kind.
+     * @param parameter <tt>n</tt> for @ref limit::every, nanoseconds between records for @ref limit::rate.
+     * @param location Location of the call, which identifies the site.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    admission admit(limit kind, u64 parameter, std::source_location const& location) noexcept;
+
+    /**
+     * @brief Logs a message of a limited call site if the severity and the limit allow it.
+     */
+    template <typename... Args>
+    void log_limited(level severity, limit kind, u64 parameter, format_for<Args...> const& format, Args&... args) {
+      if(severity < compiled_level or severity < current_level())
+        return;
+      auto const admitted = admit(kind, parameter, format.location);
+      if(not admitted.logged)
+        return;
+      encode_and_write<std::remove_cvref_t<evaluated_t<Args>>...>(
+        severity,
+        format.format,
+        format.location,
+        admitted.suppressed,
+        evaluate(args)...
+      );
+    }
+  } // namespace detail
+
+  /**
+   * @brief Logs a formatted message.
+   * @details Lazy arguments are invoked only if the severity is not filtered out.
+   * @param severity Severity of the record.
+   * @param format Format string, checked at compile time.
+   * @param args Format arguments, or callables returning them.
+   */
+  template <typename... Args>
+  void log(level severity, detail::format_for<Args...> format, Args&&... args) {
+    if(severity < compiled_level or severity < current_level())
+      return;
+    detail::encode_and_write<std::remove_cvref_t<detail::evaluated_t<Args>>...>(
+      severity,
+      format.format,
+      format.location,
+      0,
+      detail::evaluate(args)...
+    );
+  }
+
+  /**
+   * @brief Logs every <tt>n</tt>-th call of the call site, starting with the first one.
+   * @details The state of the call site is lock-free. Calls filtered out by the level are not counted.
+   * @param severity Severity of the record.
+   * @param n Ratio of calls to logged records. Zero logs every call.
+   * @param format Format string, checked at compile time.
+   * @param args Format arguments, or callables returning them, invoked only if the call is logged.
+   */
+  template <typename... Args>
+  void log_every(level severity, u64 n, detail::format_for<Args...> format, Args&&... args) {
+    detail::log_limited<Args...>(severity, detail::limit::every, n, format, args...);
+  }
+
+  /**
+   * @brief Logs at most <tt>per_second</tt> calls of the call site per second.
+   * @details Records are spaced evenly, with bursts of up to one second worth of records. The state
+   * of the call site is lock-free. Calls filtered out by the level are not counted.
+   * @param severity Severity of the record.
+   * @param per_second Rate of logged records. May be below one.
+   * @param format Format string, checked at compile time.
+   * @param args Format arguments, or callables returning them, invoked only if the call is logged.
+   */
+  template <typename... Args>
+  void log_rate(level severity, double per_second, detail::format_for<Args...> format, Args&&... args) {
+    auto const interval = per_second > 0.0 ? static_cast<u64>(1e9 / per_second) : ~u64(0);
+    detail::log_limited<Args...>(severity, detail::limit::rate, interval, format, args...);
+  }
+
+  /**
+   * @brief Logs only the first call of the call site.
+   * @param severity Severity of the record.
+   * @param format Format string, checked at compile time.
+   * @param args Format arguments, or callables returning them, invoked only if the call is logged.
+   */
+  template <typename... Args>
+  void once(level severity, detail::format_for<Args...> format, Args&&... args) {
+    detail::log_limited<Args...>(severity, detail::limit::once, 0, format, args...);
+  }
+
+  /// Logs every <tt>n</tt>-th call of the call site with @ref level::warn. See @ref log_every.
+  template <typename... Args>
+  void warn_every(u64 n, detail::format_for<Args...> format, Args&&... args) {
+    if constexpr(level::warn >= compiled_level)
+      log_every<Args...>(level::warn, n, format, std::forward<Args>(args)...);
+  }
+
+  /// Logs at most <tt>per_second</tt> calls of the call site per second with @ref level::info. See @ref log_rate.
+  template <typename... Args>
+  void info_rate(double per_second, detail::format_for<Args...> format, Args&&... args) {
+    if constexpr(level::info >= compiled_level)
+      log_rate<Args...>(level::info, per_second, format, std::forward<Args>(args)...);
+  }
+
+  /// Logs a formatted message with @ref level::trace. Removed at compile time below @ref compiled_level.
+  template <typename... Args>
+  void trace(detail::format_for<Args...> format, Args&&... args) {
+    if constexpr(level::trace >= compiled_level)
+      log<Args...>(level::trace, format, std::forward<Args>(args)...);
+  }
+
+  /// Logs a formatted message with @ref level::debug. Removed at compile time below @ref compiled_level.
+  template <typename... Args>
+  void debug(detail::format_for<Args...> format, Args&&... args) {
+    if constexpr(level::debug >= compiled_level)
+      log<Args...>(level::debug, format, std::forward<Args>(args)...);
+  }
+
+  /// Logs a formatted message with @ref level::info. Removed at compile time below @ref compiled_level.
+  template <typename... Args>
+  void info(detail::format_for<Args...> format, Args&&... args) {
+    if constexpr(level::info >= compiled_level)
+      log<Args...>(level::info, format, std::forward<Args>(args)...);
+  }
+
+  /// Logs a formatted message with @ref level::warn. Removed at compile time below @ref compiled_level.
+  template <typename... Args>
+  void warn(detail::format_for<Args...> format, Args&&... args) {
+    if constexpr(level::warn >= compiled_level)
+      log<Args...>(level::warn, format, std::forward<Args>(args)...);
+  }
+
+  /// Logs a formatted message with @ref level::err. Removed at compile time below @ref compiled_level.
+  template <typename... Args>
+  void error(detail::format_for<Args...> format, Args&&... args) {
+    if constexpr(level::err >= compiled_level)
+      log<Args...>(level::err, format, std::forward<Args>(args)...);
+  }
+
+  /// Logs a formatted message with @ref level::critical. Removed at compile time below @ref compiled_level.
+  template <typename... Args>
+  void critical(detail::format_for<Args...> format, Args&&... args) {
+    if constexpr(level::critical >= compiled_level)
+      log<Args...>(level::critical, format, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Passes the structured fields of a record to a visitor, in argument order.
+   * @param r Record received by a sink.
+   * @param visitor Callable with <code>(std::string_view key, field_value const& value)</code>.
+   * Strings are valid only during the call.
+   */
+  template <typename F>
+  requires std::invocable<F&, std::string_view, field_value const&>
+  void visit_fields(record const& r, F&& visitor) {
+    if(r.site == nullptr or r.site->fields == nullptr)
+      return;
+    r.site->fields(r.arguments, {
+      .context = const_cast<void*>(static_cast<void const*>(std::addressof(visitor))), // NOLINT(*-const-cast)
+      .visit = [](void* context, std::string_view key, field_value const& value) {
+        (*static_cast<std::remove_reference_t<F>*>(context))(key, value);
+      }
+    });
+  }
+} // namespace fl::log
+
+namespace fl
+{
+  /**
+   * @brief Creates a structured key-value field of a log call.
+   * @details The key and the value are copied into the record, without building strings.
+   * @code {.cpp}
+   * fl::log::info("request done", fl::kv("latency_us", us), fl::kv("bytes", n));
+   * @endcode
+   * @param key Key.
+   * @param value Value: trivially copyable, or convertible to <code>std::string_view</code>.
+   * @see log::visit_fields
+   */
+  template <typename T>
+  [[nodiscard]] constexpr auto kv(std::string_view key, T const& value) noexcept {
+    if constexpr(log::detail::string_argument<T>) {
+      auto view = std::string_view();
+      if constexpr(std::is_pointer_v<T>) {
+        if(value != nullptr)
+          view = value;
+      } else
+        view = value;
+      return log::field<std::string_view> { .key = key, .value = view };
+    } else
+      return log::field<T> { .key = key, .value = value };
+  }
+} // namespace fl
\ No newline at end of file
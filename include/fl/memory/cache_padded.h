@@ -0,0 +1,74 @@
+#pragma once
+
+#include <utility>
+#include "../types/stdint.h"
+
+namespace fl
+{
+  /**
+   * @brief Assumed size of the cache line in bytes.
+   * @details Used to separate data that is frequently written by different threads.
+   *
+   * <code>std::hardware_destructive_interference_size</code> is not used here, because its value
+   * is not guaranteed to be stable across compiler flags and GCC warns about using it in headers.
+   * @see cache_padded
+   */
+  inline constexpr usize cache_line_size = 64;
+
+  /**
+   * @brief Pads and aligns a value to the length of a cache line.
+   * @details Prevents <i>false sharing</i> between values that are written by different threads:
+   * two adjacent <code>cache_padded</code> values will never share a cache line.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    struct counters
+   *    {
+   *      fl::cache_padded<std::atomic<fl::u64>> produced;
+   *      fl::cache_padded<std::atomic<fl::u64>> consumed;
+   *    };
+   * @endcode
+   * @tparam T Type of the padded value.
+   * @sa https://docs.rs/crossbeam-utils/latest/crossbeam_utils/struct.CachePadded.html
+   */
+  template <typename T>
+  struct alignas(cache_line_size) cache_padded
+  {
+    T value; ///< Padded value.
+
+    /**
+     * @brief Creates a padded value with default-constructed underlying value.
+     */
+    cache_padded() = default;
+
+    /**
+     * @brief Creates a padded value with underlying value constructed from the given arguments.
+     * @param args Arguments to pass to the constructor of <code>T</code>.
+     */
+    template <typename... Args>
+    explicit cache_padded(std::in_place_t, Args&&... args)
+      : value(std::forward<Args>(args)...)
+    {}
+
+    /**
+     * @brief Returns pointer to the underlying value.
+     */
+    [[nodiscard]] T* operator->() noexcept { return &this->value; }
+
+    /**
+     * @brief Returns pointer to the underlying value.
+     */
+    [[nodiscard]] T const* operator->() const noexcept { return &this->value; }
+
+    /**
+     * @brief Returns reference to the underlying value.
+     */
+    [[nodiscard]] T& operator*() noexcept { return this->value; }
+
+    /**
+     * @brief Returns reference to the underlying value.
+     */
+    [[nodiscard]] T const& operator*() const noexcept { return this->value; }
+  };
+} // namespace fl
\ No newline at end of file
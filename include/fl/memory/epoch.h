@@ -0,0 +1,172 @@
+#pragma once
+
+#include <concepts>
+#include "box.h"
+#include "owner.h"
+#include "../global/export.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+/**
+ * @brief Epoch-based memory reclamation.
+ * @details Allows lock-free data structures to defer destruction of unlinked nodes until no thread
+ * can possibly hold a reference to them.
+ *
+ * Every thread that reads shared nodes must do so inside a critical section, represented by
+ * @ref guard. Nodes that were unlinked from the shared structure are passed to @ref retire instead
+ * of being deleted directly. Retired nodes are collected in per-thread lists, tagged with the
+ * global epoch, and destroyed in batches once the global epoch has advanced twice past their tag:
+ * at this point every thread has left the critical section in which it could have observed them.
+ *
+ * Example usage:
+ *
+ * @code {.cpp}
+ *    std::atomic<node*> head;
+ *
+ *    auto read() -> int {
+ *      auto const g = fl::epoch::guard();
+ *      return head.load(std::memory_order_acquire)->value; // node can not be freed here
+ *    }
+ *
+ *    auto replace(fl::box<node> n) -> void {
+ *      auto* old = head.exchange(n.leak(), std::memory_order_acq_rel);
+ *      fl::epoch::retire<node>(old); // will be deleted later
+ *    }
+ * @endcode
+ * @sa https://www.cl.cam.ac.uk/techreports/UCAM-CL-TR-579.pdf
+ */
+namespace fl::epoch
+{
+  /**
+   * @brief Type-erased deleter function for retired pointers.
+   */
+  using deleter_function = void (*)(void*);
+
+  /**
+   * @brief Reclamation statistics.
+   * @see stats
+   */
+  struct statistics
+  {
+    u64 epoch;     ///< Current global epoch.
+    u64 retired;   ///< Total number of retired pointers.
+    u64 reclaimed; ///< Total number of destroyed pointers.
+    usize threads; ///< Number of currently registered threads.
+  };
+
+  /**
+   * @brief RAII critical section.
+   * @details While at least one guard is alive in the current thread, no pointer retired after
+   * the outermost guard was created will be destroyed. Guards can be nested.
+   *
+   * Guards are cheap: creating the outermost guard costs one store and one full fence,
+   * nested guards cost an increment of a thread-local counter.
+   * @note Guard must be destroyed in the same thread it was created in.
+   */
+  class guard : pin
+  {
+   public:
+    /**
+     * @brief Enters the critical section.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    guard() noexcept;
+
+    /**
+     * @brief Leaves the critical section.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    ~guard() noexcept;
+  };
+
+  /**
+   * @brief Returns <code>true</code> if current thread is inside a critical section.
+   * @see guard
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  bool pinned() noexcept;
+
+  /**
+   * @brief Defers destruction of the given pointer.
+   * @details Pointer is added to the retire list of the current thread. When the list grows above
+   * the batch size (see @ref set_batch_size), thread attempts to advance the global epoch and
+   * destroys every batch that became safe to reclaim.
+   * @param ptr Pointer to retire. Must be already unreachable for threads that enter new critical sections.
+   * @param deleter Function that will be invoked on <code>ptr</code> exactly once.
+   * @see synchronize
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void retire(void* ptr, deleter_function deleter);
+
+  /**
+   * @brief Defers destruction of the given owning pointer.
+   * @details Pointer will be destroyed with <code>delete</code>.
+   * @tparam T Type of the pointed object.
+   * @param ptr Owning pointer to retire.
+   */
+  template <std::destructible T>
+  void retire(owner<T*> ptr) {
+    retire(static_cast<void*>(ptr), [](void* p) { delete static_cast<T*>(p); }); // NOLINT(*-owning-memory)
+  }
+
+  /**
+   * @brief Defers destruction of the object owned by the given box.
+   * @tparam T Type of the boxed object.
+   * @param b Box to consume.
+   */
+  template <std::destructible T>
+  void retire(box<T>&& b) { // NOLINT(*-rvalue-reference-param-not-moved)
+    retire<T>(b.leak());
+  }
+
+  /**
+   * @brief Attempts to advance the global epoch and reclaim retired pointers of the current thread.
+   * @details Never blocks. Will not advance the epoch if any thread is still pinned in an older epoch.
+   * @return <code>true</code> if the global epoch was advanced.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  bool try_reclaim();
+
+  /**
+   * @brief Destroys every pointer retired before this call by the current thread and by exited threads.
+   * @details Blocks until all threads have left critical sections which they entered before this
+   * call. Useful in tests and during shutdown.
+   * @note Must not be called from inside a critical section (see @ref guard), otherwise it will
+   * deadlock. This is checked as a precondition.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void synchronize();
+
+  /**
+   * @brief Sets the number of retired pointers, after which thread attempts to reclaim memory.
+   * @details Larger batches amortize the cost of scanning other threads, smaller batches reduce
+   * memory overhead. Default value is <code>128</code>.
+   * @param size Batch size. Must be greater than zero.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void set_batch_size(usize size);
+
+  /**
+   * @brief Returns reclamation statistics.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  statistics stats() noexcept;
+} // namespace fl::epoch
\ No newline at end of file
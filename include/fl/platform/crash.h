@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../contracts.h"
+#include "../global/definitions.h"
+#include "../global/export.h"
+#include "../types/stdint.h"
+#include "stacktrace.h"
+
+namespace fl::platform
+{
+  /**
+   * @brief Processor architecture of a crash report, which defines the meaning of its registers.
+   * @see crash_report::register_names
+   */
+  enum class crash_architecture : u32
+  {
+    unknown = 0, ///< Registers were not recorded.
+    x86_64 = 1,  ///< <tt>gregs</tt> of the signal context, in <tt>REG_*</tt> order.
+    aarch64 = 2  ///< <tt>x0</tt>–<tt>x30</tt>, <tt>sp</tt>, <tt>pc</tt> and <tt>pstate</tt>.
+  };
+
+  /**
+   * @brief Settings of the crash handler.
+   * @see install_crash_handler
+   */
+  struct crash_handler_options
+  {
+    /// Directory of crash reports. A report is named <tt>crash-<pid>.flcrash</tt>.
+    std::string directory = ".";
+
+    /// Size of the signal stack of the installing thread, so stack overflows of that thread are reported.
+    usize alternate_stack_size = usize(1) << 16;
+  };
+
+  /**
+   * @brief Contract violation recorded in a crash report.
+   * @see contracts::last_violation
+   */
+  struct crash_violation
+  {
+    contracts::contract_type type = contracts::contract_type::invariant; ///< Violated contract type.
+    u32 line = 0;                                                        ///< Line of the check.
+    u32 column = 0;                                                      ///< Column of the check.
+    std::string file = {};                                               ///< File of the check.
+    std::string function = {};                                           ///< Function containing the check.
+    std::string message = {};                                            ///< Violation message.
+  };
+
+  /**
+   * @brief Binary crash report written by the crash handler, decoded.
+   * @details Reports contain raw addresses only. Symbolize them offline with
+   * @ref offline_symbolizer, using the recorded modules and their build-IDs.
+   * @code {.cpp}
+   * auto const report = fl::platform::crash_report::parse(bytes).value();
+   * auto symbolizer = fl::platform::offline_symbolizer(report.modules);
+   * std::cout << fl::platform::to_string(report, symbolizer.symbolize(report.frames));
+   * @endcode
+   * @see install_crash_handler
+   */
+  struct crash_report
+  {
+    i32 signal = 0;                                                 ///< Signal number.
+    i32 code = 0;                                                   ///< <tt>si_code</tt> of the signal.
+    uptr fault_address = 0;                                         ///< <tt>si_addr</tt> of the signal.
+    u64 process = 0;                                                ///< Process ID.
+    u64 thread = 0;                                                 ///< Thread ID of the crashed thread.
+    u64 time = 0;                                                   ///< Time of the crash, in nanoseconds since the Unix epoch.
+    crash_architecture architecture = crash_architecture::unknown;  ///< Architecture of the registers.
+    std::vector<u64> registers = {};                                ///< Registers of the crashed thread.
+    std::vector<uptr> frames = {};                                  ///< Raw stack trace of the crashed thread, innermost first.
+    std::vector<module_info> modules = {};                          ///< Modules loaded in the process.
+    std::optional<crash_violation> violation = std::nullopt;        ///< Last enforced contract violation, if any.
+
+    /**
+     * @brief Decodes a binary crash report.
+     * @details Records of unknown types are skipped.
+     * @param data Contents of a report file.
+     * @return Decoded report, or <code>std::nullopt</code> if the data is not a valid report.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    static std::optional<crash_report> parse(std::span<std::byte const> data);
+
+    /**
+     * @brief Returns the names of the registers of an architecture, in the order of @ref registers.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    static std::span<std::string_view const> register_names(crash_architecture architecture) noexcept;
+  };
+
+  /**
+   * @brief Installs the crash handler for <tt>SIGSEGV</tt>, <tt>SIGABRT</tt>, <tt>SIGBUS</tt> and <tt>SIGFPE</tt>.
+   * @details On a crash, the handler writes a compact binary report with the signal, the registers
+   * and the raw stack trace of the crashed thread, the loaded modules with their build-IDs and the
+   * last enforced contract violation. The handler is async-signal-safe: it uses only preallocated
+   * memory and system calls, without <code>malloc</code> or <tt>stdio</tt>. A one-line notice with
+   * the report path is written to the standard error stream.
+   *
+   * The previous handlers are restored after the report is written and the signal is delivered to
+   * them again, so core dumps and other crash reporters keep working. If several threads crash at
+   * once, only the first one is reported.
+   *
+   * The module map is captured on installation. Call @ref refresh_crash_modules after loading
+   * libraries with <code>dlopen</code>. The raw stack trace is reliable only with
+   * @ref FL_FRAME_POINTERS; see @ref raw_stacktrace::capture_from_signal.
+   *
+   * Reinstalling replaces the options. Linux only.
+   * @param options Report directory and signal stack size.
+   * @throws std::runtime_error if the handler can not be installed, or the platform is not supported.
+   * @see crash_report
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void install_crash_handler(crash_handler_options const& options = {});
+
+  /**
+   * @brief Restores the signal handlers replaced by @ref install_crash_handler.
+   * @details Does nothing if the crash handler is not installed.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void uninstall_crash_handler() noexcept;
+
+  /**
+   * @brief Captures the module map written to crash reports again.
+   * @details Call after loading or unloading libraries. Does nothing if the crash handler is not installed.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  void refresh_crash_modules();
+
+  /**
+   * @brief Formats a crash report.
+   * @param report Decoded crash report.
+   * @param trace Symbolized frames of the report. If empty, raw addresses are written.
+   * @return Human-readable report.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  std::string to_string(crash_report const& report, stacktrace const& trace = {});
+} // namespace fl::platform
\ No newline at end of file
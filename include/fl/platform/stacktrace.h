@@ -0,0 +1,472 @@
+#pragma once
+
+#include <array>
+#include <future>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../global/definitions.h"
+#include "../global/export.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl::platform
+{
+  /**
+   * @brief Build-ID of a loaded module, as stored in its <tt>NT_GNU_BUILD_ID</tt> note.
+   * @details Identifies the exact binary a raw address belongs to, so addresses can be symbolized
+   * later, on another host, against the matching debug files.
+   */
+  struct build_id
+  {
+    /// Maximum size of a build-ID in bytes.
+    static constexpr usize max_size = 32;
+
+    std::array<u8, max_size> bytes = {}; ///< Build-ID bytes. Bytes past <tt>size</tt> are zero.
+    u8 size = 0;                          ///< Number of used bytes.
+
+    /**
+     * @brief Parses a build-ID from its hexadecimal representation.
+     * @param hex Hexadecimal digits, two per byte.
+     * @return Parsed build-ID, or <code>std::nullopt</code> if the string is not a valid build-ID.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    static std::optional<build_id> parse(std::string_view hex);
+
+    /**
+     * @brief Returns the used bytes.
+     */
+    [[nodiscard]] std::span<u8 const> view() const noexcept { return { this->bytes.data(), this->size }; }
+
+    /**
+     * @brief Returns <code>true</code> if the module has no build-ID.
+     */
+    [[nodiscard]] bool empty() const noexcept { return this->size == 0; }
+
+    /**
+     * @brief Returns the hexadecimal representation, as printed by <tt>readelf -n</tt>.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    std::string to_string() const;
+
+    [[nodiscard]] bool operator==(build_id const&) const = default;
+  };
+
+  /**
+   * @brief Module (executable or shared library) loaded into the process.
+   * @see module_map
+   */
+  struct module_info
+  {
+    std::string path = {}; ///< Path of the module file.
+    uptr bias = 0;         ///< Load bias: difference between run-time addresses and addresses in the file.
+    uptr begin = 0;        ///< First run-time address of the loaded segments.
+    uptr end = 0;          ///< Past-the-end run-time address of the loaded segments.
+    build_id id = {};      ///< Build-ID of the module. Empty if the module has none.
+
+    /**
+     * @brief Returns <code>true</code> if the run-time address belongs to the module.
+     */
+    [[nodiscard]] bool contains(uptr address) const noexcept { return address >= this->begin and address < this->end; }
+
+    /**
+     * @brief Converts a run-time address to an address in the module file.
+     */
+    [[nodiscard]] uptr file_address(uptr address) const noexcept { return address - this->bias; }
+  };
+
+  /**
+   * @brief Snapshot of the modules loaded into the process.
+   * @details Maps raw addresses to modules and their build-IDs. On platforms other than Linux the
+   * map is empty.
+   */
+  class module_map
+  {
+   public:
+    module_map() = default;
+
+    /**
+     * @brief Captures the modules currently loaded into the process.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    static module_map capture();
+
+    /**
+     * @brief Returns loaded modules, sorted by address.
+     */
+    [[nodiscard]] std::span<module_info const> modules() const noexcept { return this->modules_; }
+
+    /**
+     * @brief Finds the module containing a run-time address.
+     * @param address Run-time address.
+     * @return Module, or <code>nullptr</code> if the address does not belong to any module.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    module_info const* find(uptr address) const noexcept;
+
+   private:
+    std::vector<module_info> modules_;
+  };
+
+  /**
+   * @brief Unsymbolized stack trace: return addresses of the calling thread.
+   * @details Capturing stores only the addresses into a fixed-size buffer. It does not allocate,
+   * does not touch debug information and does not take locks once the unwinder is initialized, so
+   * traces can be captured on hot error paths and symbolized later with @ref symbolize or
+   * @ref symbolize_async, or offline from the addresses and the @ref module_map of the process.
+   *
+   * If @ref FL_FRAME_POINTERS is defined, the trace is captured by walking the frame pointer chain,
+   * which takes a few nanoseconds per frame, but stops at the first function compiled without frame
+   * pointers. Otherwise the unwinder of the compiler runtime is used, which reads the unwind tables
+   * and costs several hundred nanoseconds per frame.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *  auto const trace = fl::platform::raw_stacktrace::capture();
+   *  ...
+   *  auto future = fl::platform::symbolize_async(trace);
+   *  log(fl::platform::to_string(future.get()));
+   * @endcode
+   */
+  class raw_stacktrace
+  {
+   public:
+    /// Maximum number of captured frames.
+    static constexpr usize capacity = 64;
+
+    raw_stacktrace() = default;
+
+    /**
+     * @brief Captures the stack trace of the calling thread.
+     * @param skip Number of innermost frames to omit, not counting this function.
+     * @return Captured trace. The innermost frame is the caller of this function.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___noinline___
+    ___fl_api___
+    #endif // FL_DOC
+    static raw_stacktrace capture(usize skip = 0) noexcept;
+
+    /**
+     * @brief Captures the stack trace of the code interrupted by a signal.
+     * @details Intended for signal handlers installed with <code>SA_SIGINFO</code>. The innermost
+     * frame is the interrupted instruction, which is not a return address: it is stored as its
+     * address plus one, so every frame of the trace can be looked up the same way.
+     *
+     * Async-signal-safe if @ref FL_FRAME_POINTERS is defined. Otherwise the unwinder of the compiler
+     * runtime is used, which may take the dynamic loader lock.
+     * @param context Third argument of the signal handler (<code>ucontext_t*</code>).
+     * @return Captured trace. Contains only the interrupted instruction if the unwinder can not
+     * step through the signal frame. Empty on unsupported platforms.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___noinline___
+    ___fl_api___
+    #endif // FL_DOC
+    static raw_stacktrace capture_from_signal(void const* context) noexcept;
+
+    /**
+     * @brief Returns captured return addresses, innermost first.
+     */
+    [[nodiscard]] std::span<uptr const> frames() const noexcept { return { this->frames_.data(), this->size_ }; }
+
+    /**
+     * @brief Returns number of captured frames.
+     */
+    [[nodiscard]] usize size() const noexcept { return this->size_; }
+
+    /**
+     * @brief Returns <code>true</code> if no frames were captured.
+     */
+    [[nodiscard]] bool empty() const noexcept { return this->size_ == 0; }
+
+   private:
+    std::array<uptr, capacity> frames_ {};
+    usize size_ = 0;
+  };
+
+  /**
+   * @brief Symbolized stack frame.
+   */
+  struct stacktrace_frame
+  {
+    uptr address = 0;          ///< Return address.
+    std::string function = {}; ///< Demangled function name. Empty if unknown.
+    std::string file = {};     ///< Source file. Empty if unknown.
+    u32 line = 0;              ///< Source line. Zero if unknown.
+    std::string module = {};   ///< Path of the module containing the address. Empty if unknown.
+  };
+
+  /**
+   * @brief Symbolized stack trace, innermost frame first.
+   */
+  using stacktrace = std::vector<stacktrace_frame>;
+
+  /**
+   * @brief Symbol cache counters, returned by @ref symbolizer::statistics.
+   */
+  struct symbolizer_statistics
+  {
+    u64 hits = 0;       ///< Frames resolved from the cache.
+    u64 misses = 0;     ///< Frames resolved from debug information.
+    u64 refreshes = 0;  ///< Number of times the session was rebuilt because modules were loaded or unloaded.
+    usize size = 0;     ///< Number of cached addresses.
+    usize capacity = 0; ///< Maximum number of cached addresses.
+  };
+
+  /**
+   * @brief Process-wide symbolizer with a persistent debug information session and an address cache.
+   * @details On Linux, keeps one <tt>libdwfl</tt> session for the process, so modules and their
+   * debug information are opened once instead of for every stack trace. The session is rebuilt only
+   * when modules are loaded or unloaded (<code>dlopen</code>, <code>dlclose</code>), which is
+   * detected from the loader's module counters before every symbolization.
+   *
+   * Resolved addresses are kept in a concurrent cache in front of the session, so repeated frames,
+   * typical for error storms, are resolved without touching debug information. The cache is bounded:
+   * when it is full, it is cleared and refilled. It is also cleared when the session is rebuilt,
+   * because unloaded modules may free their addresses for others.
+   *
+   * Lookups in the cache run in parallel; resolving missing addresses is serialized, because
+   * <tt>libdwfl</tt> sessions are not thread-safe. On other platforms only the addresses are filled in.
+   * @see symbolize
+   * @see symbolize_async
+   */
+  class symbolizer : pin
+  {
+   public:
+    /// Default maximum number of cached addresses.
+    static constexpr usize default_capacity = 4'096;
+
+    /**
+     * @brief Creates a symbolizer with an empty cache.
+     * @param capacity Maximum number of cached addresses.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    explicit symbolizer(usize capacity = default_capacity);
+
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    ~symbolizer();
+
+    /**
+     * @brief Returns the process-wide symbolizer.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    static symbolizer& instance();
+
+    /**
+     * @brief Resolves a raw stack trace to functions, source files and lines.
+     * @details Thread-safe.
+     * @param trace Raw stack trace captured in this process.
+     * @return Symbolized stack trace.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    stacktrace symbolize(raw_stacktrace const& trace);
+
+    /**
+     * @brief Resolves return addresses to functions, source files and lines.
+     * @details Thread-safe. Useful for addresses collected from many traces, e.g. by a profiler.
+     * @param addresses Return addresses, as stored in @ref raw_stacktrace.
+     * @return Symbolized frames, one per address.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    stacktrace symbolize(std::span<uptr const> addresses);
+
+    /**
+     * @brief Resolves a raw stack trace on the background thread of this symbolizer.
+     * @details Requests are processed in order by a single thread, started on first use, so the
+     * calling thread does not stall on debug information.
+     * @param trace Raw stack trace captured in this process.
+     * @return Future of the symbolized stack trace.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    std::future<stacktrace> symbolize_async(raw_stacktrace const& trace);
+
+    /**
+     * @brief Resolves and caches the given addresses ahead of time.
+     * @details Intended for frames known to be hot, e.g. return addresses of error reporting functions.
+     * @param addresses Return addresses, as stored in @ref raw_stacktrace.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void warm_up(std::span<uptr const> addresses);
+
+    /**
+     * @brief Returns cache counters.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    symbolizer_statistics statistics() const;
+
+   private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+  };
+
+  /**
+   * @brief Symbolizes addresses captured in another process, possibly on another host.
+   * @details Loads the modules of the captured process from local files, at the addresses they were
+   * loaded at in the captured process. The file of a module is looked up by build-ID in the
+   * <tt>.build-id</tt> trees of the debug directories (<tt>xx/yyyy</tt>, then
+   * <tt>xx/yyyy.debug</tt>), then at its captured path. Files whose build-ID differs from the
+   * captured one are skipped, so a rebuilt binary never yields wrong symbols. Each module is opened
+   * on its first lookup, once.
+   *
+   * Not thread-safe. On platforms other than Linux only the addresses are filled in.
+   * @code {.cpp}
+   * auto symbolizer = fl::platform::offline_symbolizer(report.modules, { "/srv/debug" });
+   * std::cout << fl::platform::to_string(symbolizer.symbolize(report.frames));
+   * @endcode
+   * @see module_map
+   */
+  class offline_symbolizer : pin
+  {
+   public:
+    /**
+     * @brief Creates a symbolizer for the modules of a captured process.
+     * @param modules Modules of the captured process, e.g. from @ref module_map.
+     * @param debug_directories Directories with debug files, searched before the default ones.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    explicit offline_symbolizer(std::vector<module_info> modules, std::vector<std::string> debug_directories = {});
+
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    ~offline_symbolizer();
+
+    /**
+     * @brief Resolves return addresses captured in the other process.
+     * @param addresses Return addresses, as stored in @ref raw_stacktrace.
+     * @return Symbolized frames, one per address. Frames outside of known modules, or in modules
+     * without a matching local file, keep only their address and module path.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    stacktrace symbolize(std::span<uptr const> addresses);
+
+   private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+  };
+
+  /**
+   * @brief Return address identified by the build-ID of its module, independent of the load address.
+   * @details Compact form for logging raw stack traces in production, so they can be symbolized in
+   * batch on another host with @ref symbolize_offline or the <tt>floppy-symbolize</tt> tool, which
+   * reads one record per line as <tt>&lt;build-id&gt; &lt;hex address&gt; [path]</tt>.
+   * @see module_addresses
+   */
+  struct module_address
+  {
+    build_id id = {};       ///< Build-ID of the module.
+    uptr address = 0;       ///< Return address in the module file, as used by @ref raw_stacktrace.
+    std::string path = {};  ///< Path of the module in the captured process. Optional.
+  };
+
+  /**
+   * @brief Converts the frames of a raw stack trace to module-relative addresses.
+   * @param trace Raw stack trace captured in this process.
+   * @param modules Modules of this process, captured after the modules of the trace were loaded.
+   * @return One record per frame. Frames outside of known modules keep their run-time address and
+   * have an empty build-ID.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  std::vector<module_address> module_addresses(raw_stacktrace const& trace, module_map const& modules);
+
+  /**
+   * @brief Resolves module-relative addresses against local files, in batch.
+   * @details Records are grouped by build-ID and sorted by address, so the debug information of each
+   * module is opened and scanned once, however the records are interleaved. Module files are looked
+   * up as described for @ref offline_symbolizer; the module path of a record is used as the last
+   * candidate.
+   * @param addresses Records to resolve.
+   * @param debug_directories Directories with debug files, searched before the default ones.
+   * @return Symbolized frames in the order of the records. Addresses stay module-relative.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  stacktrace symbolize_offline(std::span<module_address const> addresses, std::vector<std::string> debug_directories = {});
+
+  /**
+   * @brief Resolves a raw stack trace to functions, source files and lines.
+   * @details Uses the process-wide @ref symbolizer. On Linux, resolves with <tt>libdwfl</tt> from
+   * <b>elfutils</b>. On other platforms only the addresses are filled in.
+   * @param trace Raw stack trace captured in this process.
+   * @return Symbolized stack trace.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  stacktrace symbolize(raw_stacktrace const& trace);
+
+  /**
+   * @brief Resolves a raw stack trace on a background thread.
+   * @details Uses the process-wide @ref symbolizer, whose single background thread processes
+   * requests in order, so the calling thread does not stall on debug information.
+   * @param trace Raw stack trace captured in this process.
+   * @return Future of the symbolized stack trace.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  std::future<stacktrace> symbolize_async(raw_stacktrace const& trace);
+
+  /**
+   * @brief Formats a symbolized stack trace, one frame per line.
+   * @param trace Symbolized stack trace.
+   * @return Formatted stack trace.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  std::string to_string(stacktrace const& trace);
+} // namespace fl::platform
\ No newline at end of file
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../global/definitions.h"
+#include "../global/export.h"
+#include "../types/stdint.h"
+
+/**
+ * @brief Platform-specific utilities: processor topology, thread affinity and naming.
+ * @ingroup platform
+ */
+namespace fl::platform
+{
+  /**
+   * @brief Logical processor description.
+   * @see topology
+   */
+  struct logical_cpu
+  {
+    usize id;        ///< Logical processor index, as used by the operating system.
+    usize core;      ///< Physical core index, unique within the package.
+    usize package;   ///< Physical package (socket) index.
+    usize numa_node; ///< NUMA node index.
+  };
+
+  /**
+   * @brief Worker placement, returned by @ref topology::place_workers.
+   */
+  struct worker_placement
+  {
+    usize worker;      ///< Global worker index.
+    usize cpu;         ///< Logical processor the worker should be pinned to.
+    usize numa_node;   ///< NUMA node of the processor.
+    usize local_index; ///< Index of the worker among the workers of the same NUMA node.
+  };
+
+  /**
+   * @brief Processor topology of the machine.
+   * @details Describes online logical processors, their physical cores, packages and NUMA nodes.
+   *
+   * On Linux, topology is read from <tt>sysfs</tt>. On other platforms (or if <tt>sysfs</tt> is not
+   * available) every logical processor reported by <code>std::thread::hardware_concurrency</code>
+   * is treated as a separate core of a single package and a single NUMA node.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto const& topo = fl::platform::topology::current();
+   *    auto workers = std::vector<std::jthread>();
+   *    for(auto const& p : topo.place_workers(16)) {
+   *      auto& t = workers.emplace_back([p] { work(p.numa_node, p.local_index); });
+   *      fl::platform::pin_thread(t, p.cpu);
+   *    }
+   * @endcode
+   */
+  class topology
+  {
+   public:
+    /**
+     * @brief Returns the topology of the current machine.
+     * @details Topology is detected once and cached for the lifetime of the process.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    static topology const& current();
+
+    /**
+     * @brief Detects the topology of the current machine.
+     * @details Unlike @ref current, always performs detection.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    static topology detect();
+
+    /**
+     * @brief Reads the topology from the given <tt>sysfs</tt> directory.
+     * @details Directory must have the layout of <tt>/sys/devices/system</tt>, i.e. contain
+     * <tt>cpu/online</tt>, <tt>cpu/cpuN/topology</tt> and optionally <tt>node/nodeN/cpulist</tt>.
+     * Missing files are treated as zero indices.
+     * @param root Path to the <tt>sysfs</tt> system devices directory.
+     * @throws std::runtime_error if the list of online processors can not be read.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    static topology from_sysfs(std::filesystem::path const& root = "/sys/devices/system");
+
+    /**
+     * @brief Returns online logical processors, sorted by id.
+     */
+    [[nodiscard]] std::span<logical_cpu const> cpus() const noexcept { return this->cpus_; }
+
+    /**
+     * @brief Returns number of distinct physical cores.
+     */
+    [[nodiscard]] usize cores() const noexcept { return this->cores_; }
+
+    /**
+     * @brief Returns number of distinct packages (sockets).
+     */
+    [[nodiscard]] usize packages() const noexcept { return this->packages_; }
+
+    /**
+     * @brief Returns number of NUMA nodes with at least one online processor.
+     */
+    [[nodiscard]] usize numa_nodes() const noexcept { return this->nodes_.size(); }
+
+    /**
+     * @brief Returns ids of logical processors of the given NUMA node.
+     * @details Processors are ordered so that the first processor of every physical core comes
+     * before any hyper-threading sibling.
+     * @param node NUMA node index, as returned by @ref numa_nodes.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    std::span<usize const> cpus_of_node(usize node) const;
+
+    /**
+     * @brief Distributes workers across NUMA nodes.
+     * @details Workers are assigned to nodes in round-robin order. Inside a node, workers are
+     * spread across processors so that distinct physical cores are used before hyper-threading siblings.
+     * @param count Number of workers.
+     * @return Placement of each worker.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    std::vector<worker_placement> place_workers(usize count) const;
+
+   private:
+    explicit topology(std::vector<logical_cpu> cpus);
+
+    std::vector<logical_cpu> cpus_;
+    std::vector<std::vector<usize>> nodes_;
+    usize cores_ = 0;
+    usize packages_ = 0;
+  };
+
+  /**
+   * @brief Pins the current thread to the given logical processor.
+   * @param cpu Logical processor id.
+   * @return <code>true</code> on success, <code>false</code> if affinity can not be changed on this platform.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  bool pin_current_thread(usize cpu);
+
+  /**
+   * @brief Restricts the current thread to the given set of logical processors.
+   * @param cpus Logical processor ids.
+   * @return <code>true</code> on success, <code>false</code> if affinity can not be changed on this platform.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  bool pin_current_thread(std::span<usize const> cpus);
+
+  /**
+   * @brief Pins the given thread to the given logical processor.
+   * @param thread Thread to pin. Must be joinable.
+   * @param cpu Logical processor id.
+   * @return <code>true</code> on success, <code>false</code> if affinity can not be changed on this platform.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  bool pin_thread(std::jthread& thread, usize cpu);
+
+  /**
+   * @brief Sets the name of the current thread, as seen by debuggers and profilers.
+   * @note On Linux, names longer than 15 characters are truncated.
+   * @param name New thread name.
+   * @return <code>true</code> on success.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  bool set_current_thread_name(std::string_view name);
+
+  /**
+   * @brief Sets the name of the given thread, as seen by debuggers and profilers.
+   * @note On Linux, names longer than 15 characters are truncated.
+   * @param thread Thread to name. Must be joinable.
+   * @param name New thread name.
+   * @return <code>true</code> on success.
+   */
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  bool set_thread_name(std::jthread& thread, std::string_view name);
+
+  /**
+   * @brief Returns the logical processor the current thread is running on.
+   * @details Value can change at any moment, unless the thread is pinned. Returns <code>0</code>
+   * if the platform does not support this query.
+   */
+  [[nodiscard]]
+  #ifndef FL_DOC
+  ___fl_api___
+  #endif // FL_DOC
+  usize current_cpu() noexcept;
+} // namespace fl::platform
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include "global/definitions.h"
+#include "global/export.h"
+#include "traits/pin.h"
+#include "types/stdint.h"
+
+namespace fl
+{
+  /**
+   * @brief Settings of a @ref profiler session.
+   */
+  struct profiler_options
+  {
+    /// Samples per second of consumed CPU time. An odd rate avoids lockstep with periodic work.
+    u32 frequency = 99;
+
+    /// Maximum number of threads which can record samples. Samples of further threads are dropped.
+    usize max_threads = 64;
+
+    /// Size of the buffer of each thread, in machine words. A sample takes its depth plus one word.
+    usize buffer_size = usize(1) << 16;
+  };
+
+  /**
+   * @brief In-process sampling CPU profiler.
+   * @details Samples all threads of the process with a <tt>SIGPROF</tt> timer on the process CPU-time
+   * clock, so busy threads are sampled in proportion to the CPU time they consume. The signal handler
+   * captures the raw stack trace of the interrupted code and appends it to a buffer owned by the
+   * interrupted thread. Buffers are preallocated when the profiler starts; the handler neither
+   * allocates nor locks. Samples which do not fit are dropped and counted.
+   *
+   * Symbolization happens only when the result is requested, in the
+   * <a href="https://github.com/brendangregg/FlameGraph">folded stack</a> format read by flame graph
+   * tools.
+   *
+   * Only one profiler can run at a time. Build with @ref FL_FRAME_POINTERS for reliable and cheap
+   * sampling: without frame pointers, the handler falls back to the unwinder of the compiler
+   * runtime, which is not async-signal-safe.
+   *
+   * @note Linux only. @ref start throws on other platforms.
+   * @code {.cpp}
+   * auto profiler = fl::profiler({ .frequency = 999 });
+   * profiler.start();
+   * run_workload();
+   * profiler.stop();
+   * auto file = std::ofstream("profile.folded");
+   * profiler.write_folded(file); // flamegraph.pl profile.folded > profile.svg
+   * @endcode
+   * @see platform::raw_stacktrace::capture_from_signal
+   */
+  class profiler : pin
+  {
+   public:
+    /**
+     * @brief Creates a stopped profiler.
+     * @param options Sampling frequency and buffer sizes.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    explicit profiler(profiler_options options = {});
+
+    /**
+     * @brief Stops the profiler if it is running.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    ~profiler();
+
+    /**
+     * @brief Starts sampling.
+     * @details Discards the samples of the previous session.
+     * @throws std::runtime_error if another profiler is running, if the timer or the signal handler
+     * can not be installed, or if the platform is not supported.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void start();
+
+    /**
+     * @brief Stops sampling.
+     * @details Returns after the signal handler has finished with the buffers. Does nothing if the
+     * profiler is not running.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void stop() noexcept;
+
+    /**
+     * @brief Returns <code>true</code> between @ref start and @ref stop.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    bool running() const noexcept;
+
+    /**
+     * @brief Returns the number of recorded samples.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    u64 samples() const noexcept;
+
+    /**
+     * @brief Returns the number of samples dropped because a buffer was full or there were more
+     * threads than buffers.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    u64 dropped() const noexcept;
+
+    /**
+     * @brief Writes the recorded samples as folded stacks.
+     * @details One line per distinct stack: frames from the outermost to the innermost, separated
+     * by <tt>;</tt>, followed by a space and the number of samples. Frames which can not be
+     * symbolized are written as hexadecimal addresses. May be called while the profiler is running;
+     * samples recorded meanwhile may be missing.
+     * @param stream Output stream.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void write_folded(std::ostream& stream) const;
+
+    /**
+     * @brief Returns the recorded samples as folded stacks.
+     * @see write_folded
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    std::string folded() const;
+
+   private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+  };
+} // namespace fl
\ No newline at end of file
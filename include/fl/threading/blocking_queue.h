@@ -0,0 +1,293 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <utility>
+#include "event_count.h"
+#include "mpmc_queue.h"
+#include "spsc_queue.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  namespace concepts
+  {
+    /**
+     * @brief Bounded non-blocking queue concept.
+     * @details Satisfied by @ref fl::spsc_queue and @ref fl::mpmc_queue.
+     * @tparam Q Type to check.
+     */
+    template <typename Q>
+    concept bounded_queue = requires(Q q, typename Q::value_type v, std::span<typename Q::value_type> s) {
+      { q.try_push(std::move(v)) } -> std::same_as<bool>;
+      { q.try_push_n(s) } -> std::same_as<usize>;
+      { q.try_pop() } -> std::same_as<std::optional<typename Q::value_type>>;
+      { q.size() } -> std::same_as<usize>;
+      { q.capacity() } -> std::same_as<usize>;
+    };
+  } // namespace concepts
+
+  /**
+   * @brief Blocking front-end for a bounded lock-free queue.
+   * @details Adds operations which sleep while the queue is full or empty. Sleeping is built on
+   * @ref event_count (a futex on Linux), so the fast path of every operation is the
+   * lock-free operation of the underlying queue plus a fence and a load.
+   *
+   * The queue can be closed: after @ref close, pushes fail and pops drain the remaining elements
+   * and then return <code>std::nullopt</code>. Elements pushed concurrently with @ref close may
+   * either be drained or stay in the queue until its destruction.
+   *
+   * Threading restrictions of the underlying queue apply: e.g. <code>blocking_spsc_queue</code>
+   * still allows a single producer and a single consumer.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto queue = fl::blocking_mpmc_queue<int>(64);
+   *    auto consumer = std::jthread([&] {
+   *      while(auto const v = queue.pop())
+   *        std::cout << *v << '\n';
+   *    });
+   *    for(auto i = 0; i < 10; ++i)
+   *      queue.push(i);
+   *    queue.close();
+   * @endcode
+   * @tparam Queue Underlying queue type.
+   * @see blocking_spsc_queue
+   * @see blocking_mpmc_queue
+   */
+  template <concepts::bounded_queue Queue>
+  class blocking_queue : pin
+  {
+   public:
+    using value_type = typename Queue::value_type;
+
+    /**
+     * @brief Creates an empty queue.
+     * @param capacity Minimal capacity of the queue. Rounded up to a power of two.
+     */
+    explicit blocking_queue(usize capacity)
+      : queue_(capacity)
+    {}
+
+    ~blocking_queue() = default;
+
+    /**
+     * @brief Pushes an element, blocking while the queue is full.
+     * @param value Value to push.
+     * @return <code>true</code> if the element was pushed, <code>false</code> if the queue is closed.
+     */
+    bool push(value_type value) {
+      while(true) {
+        if(this->try_push(std::move(value)))
+          return true;
+        if(this->closed())
+          return false;
+        auto const key = this->not_full_.prepare_wait();
+        if(this->try_push(std::move(value))) {
+          this->not_full_.cancel_wait();
+          return true;
+        }
+        if(this->closed()) {
+          this->not_full_.cancel_wait();
+          return false;
+        }
+        this->not_full_.wait(key);
+      }
+    }
+
+    /**
+     * @brief Pushes all elements of the span, blocking while the queue is full.
+     * @param values Values to push. Pushed values are left in moved-from state.
+     * @return Number of pushed values. Less than <code>values.size()</code> only if the queue was closed.
+     */
+    usize push_n(std::span<value_type> values) {
+      auto pushed = usize(0);
+      while(pushed < values.size() and not this->closed()) {
+        pushed += this->try_push_n(values.subspan(pushed));
+        if(pushed == values.size())
+          break;
+        auto const key = this->not_full_.prepare_wait();
+        auto const count = this->try_push_n(values.subspan(pushed));
+        if(count != 0 or this->closed()) {
+          this->not_full_.cancel_wait();
+          pushed += count;
+          continue;
+        }
+        this->not_full_.wait(key);
+      }
+      return pushed;
+    }
+
+    /**
+     * @brief Pops an element, blocking while the queue is empty.
+     * @return Popped element or <code>std::nullopt</code> if the queue is closed and drained.
+     */
+    [[nodiscard]] std::optional<value_type> pop() {
+      while(true) {
+        if(auto value = this->try_pop())
+          return value;
+        auto const key = this->not_empty_.prepare_wait();
+        auto const closed = this->closed();
+        if(auto value = this->try_pop()) {
+          this->not_empty_.cancel_wait();
+          return value;
+        }
+        if(closed) {
+          this->not_empty_.cancel_wait();
+          return std::nullopt;
+        }
+        this->not_empty_.wait(key);
+      }
+    }
+
+    /**
+     * @brief Pops up to <code>max</code> elements, blocking while the queue is empty.
+     * @param out Output iterator to move popped elements to.
+     * @param max Maximal number of elements to pop.
+     * @return Number of popped elements. Zero only if the queue is closed and drained, or <code>max</code> is zero.
+     */
+    template <std::output_iterator<value_type> O>
+    usize pop_n(O out, usize max) {
+      while(max != 0) {
+        if(auto const count = this->try_pop_n(out, max); count != 0)
+          return count;
+        auto const key = this->not_empty_.prepare_wait();
+        auto const closed = this->closed();
+        if(auto const count = this->try_pop_n(out, max); count != 0) {
+          this->not_empty_.cancel_wait();
+          return count;
+        }
+        if(closed) {
+          this->not_empty_.cancel_wait();
+          return 0;
+        }
+        this->not_empty_.wait(key);
+      }
+      return 0;
+    }
+
+    /**
+     * @brief Pushes an element without blocking.
+     * @param value Value to push. Left intact on failure.
+     * @return <code>true</code> if the element was pushed, <code>false</code> if the queue is full or closed.
+     */
+    bool try_push(value_type&& value) {
+      if(this->closed() or not this->queue_.try_push(std::move(value)))
+        return false;
+      this->not_empty_.notify_one();
+      return true;
+    }
+
+    /**
+     * @brief Pushes an element without blocking.
+     * @param value Value to push.
+     * @return <code>true</code> if the element was pushed, <code>false</code> if the queue is full or closed.
+     */
+    bool try_push(value_type const& value) {
+      if(this->closed() or not this->queue_.try_push(value))
+        return false;
+      this->not_empty_.notify_one();
+      return true;
+    }
+
+    /**
+     * @brief Pushes a prefix of the span without blocking.
+     * @param values Values to push. Pushed values are left in moved-from state.
+     * @return Number of pushed values.
+     */
+    usize try_push_n(std::span<value_type> values) {
+      if(this->closed())
+        return 0;
+      auto const count = this->queue_.try_push_n(values);
+      if(count == 1)
+        this->not_empty_.notify_one();
+      else if(count > 1)
+        this->not_empty_.notify_all();
+      return count;
+    }
+
+    /**
+     * @brief Pops an element without blocking.
+     * @return Popped element or <code>std::nullopt</code> if the queue is empty.
+     */
+    [[nodiscard]] std::optional<value_type> try_pop() {
+      auto value = this->queue_.try_pop();
+      if(value)
+        this->not_full_.notify_one();
+      return value;
+    }
+
+    /**
+     * @brief Pops up to <code>max</code> elements without blocking.
+     * @param out Output iterator to move popped elements to.
+     * @param max Maximal number of elements to pop.
+     * @return Number of popped elements.
+     */
+    template <std::output_iterator<value_type> O>
+    usize try_pop_n(O out, usize max) {
+      auto const count = this->queue_.try_pop_n(out, max);
+      if(count == 1)
+        this->not_full_.notify_one();
+      else if(count > 1)
+        this->not_full_.notify_all();
+      return count;
+    }
+
+    /**
+     * @brief Closes the queue and wakes up all blocked threads.
+     * @details Subsequent pushes fail. Pops return remaining elements and then <code>std::nullopt</code>.
+     */
+    void close() noexcept {
+      this->closed_.store(true, std::memory_order_release);
+      this->not_empty_.notify_all();
+      this->not_full_.notify_all();
+    }
+
+    /**
+     * @brief Returns <code>true</code> if the queue was closed.
+     */
+    [[nodiscard]] bool closed() const noexcept { return this->closed_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Returns approximate number of elements in the queue.
+     */
+    [[nodiscard]] usize size() const noexcept { return this->queue_.size(); }
+
+    /**
+     * @brief Returns <code>true</code> if the queue appears empty.
+     */
+    [[nodiscard]] bool empty() const noexcept { return this->queue_.size() == 0; }
+
+    /**
+     * @brief Returns the maximal number of elements the queue can hold.
+     */
+    [[nodiscard]] usize capacity() const noexcept { return this->queue_.capacity(); }
+
+   private:
+    Queue queue_;
+    std::atomic<bool> closed_ = false;
+    event_count not_empty_;
+    event_count not_full_;
+  };
+
+  /**
+   * @brief Blocking single-producer single-consumer queue.
+   * @see blocking_queue
+   * @see spsc_queue
+   */
+  template <typename T>
+  using blocking_spsc_queue = blocking_queue<spsc_queue<T>>;
+
+  /**
+   * @brief Blocking multi-producer multi-consumer queue.
+   * @see blocking_queue
+   * @see mpmc_queue
+   */
+  template <typename T>
+  using blocking_mpmc_queue = blocking_queue<mpmc_queue<T>>;
+} // namespace fl
\ No newline at end of file
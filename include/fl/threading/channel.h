@@ -0,0 +1,515 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  template <typename T>
+  requires std::is_nothrow_move_constructible_v<T>
+  class channel;
+
+  /**
+   * @brief Result of a non-blocking receive attempt.
+   */
+  enum class channel_status : u8
+  {
+    received, ///< A value was received.
+    empty,    ///< No value is available right now.
+    closed    ///< Channel is closed and drained.
+  };
+
+  namespace detail
+  {
+    /**
+     * @brief Thread parked on a channel operation.
+     * @details Waking always happens under the channel mutex and parked threads re-acquire the
+     * mutex before returning, so the waiter (which lives on the parked thread's stack) outlives
+     * the notification.
+     */
+    struct channel_waiter
+    {
+      static constexpr u32 waiting = 0;
+      static constexpr u32 done = 1;
+      static constexpr u32 closed = 2;
+
+      std::atomic<u32> state = waiting;
+
+      void park() noexcept {
+        for(auto s = this->state.load(std::memory_order_acquire); s == waiting; s = this->state.load(std::memory_order_acquire))
+          this->state.wait(waiting, std::memory_order_acquire);
+      }
+
+      void wake(u32 s) noexcept {
+        this->state.store(s, std::memory_order_release);
+        this->state.notify_one();
+      }
+
+      /**
+       * @brief Wakes the waiter unless it has already been woken.
+       * @return <code>true</code> if this call woke the waiter.
+       */
+      [[nodiscard]] bool claim(u32 s) noexcept {
+        auto expected = waiting;
+        if(not this->state.compare_exchange_strong(expected, s, std::memory_order_release, std::memory_order_relaxed))
+          return false;
+        this->state.notify_one();
+        return true;
+      }
+    };
+
+    /**
+     * @brief Subscription of a @ref fl::select call to one of its channels.
+     */
+    struct channel_selector
+    {
+      channel_waiter* waiter = nullptr;
+      channel_selector* prev = nullptr;
+      channel_selector* next = nullptr;
+    };
+
+    /**
+     * @brief Intrusive FIFO of parked threads.
+     */
+    template <typename Node>
+    struct channel_wait_queue
+    {
+      Node* head = nullptr;
+      Node* tail = nullptr;
+
+      void push(Node* node) noexcept {
+        node->next = nullptr;
+        (this->tail ? this->tail->next : this->head) = node;
+        this->tail = node;
+      }
+
+      [[nodiscard]] Node* pop() noexcept {
+        auto* const node = this->head;
+        if(node) {
+          this->head = node->next;
+          if(not this->head)
+            this->tail = nullptr;
+        }
+        return node;
+      }
+    };
+
+    /**
+     * @brief Gives @ref fl::select access to the internals of channels.
+     */
+    struct channel_access
+    {
+      template <typename T>
+      [[nodiscard]] static channel_status try_recv(channel<T>& ch, std::optional<T>& out) {
+        auto const lock = std::lock_guard(ch.mutex_);
+        return ch.take(out);
+      }
+
+      template <typename T>
+      static void subscribe(channel<T>& ch, channel_selector& selector) {
+        auto const lock = std::lock_guard(ch.mutex_);
+        selector.prev = nullptr;
+        selector.next = ch.selectors_;
+        if(ch.selectors_)
+          ch.selectors_->prev = &selector;
+        ch.selectors_ = &selector;
+      }
+
+      /**
+       * Removes the subscription. If the channel is still ready, the wakeup is passed on to
+       * another select call, in case this one was woken by the channel and fired another case.
+       */
+      template <typename T>
+      static void unsubscribe(channel<T>& ch, channel_selector& selector) {
+        auto const lock = std::lock_guard(ch.mutex_);
+        (selector.prev ? selector.prev->next : ch.selectors_) = selector.next;
+        if(selector.next)
+          selector.next->prev = selector.prev;
+        if(ch.size_ != 0 or ch.senders_.head)
+          ch.notify_selector();
+      }
+    };
+  } // namespace detail
+
+  /**
+   * @brief Go-style channel for passing values between threads.
+   * @details A channel with positive capacity is <i>buffered</i>: senders block only while the
+   * buffer is full. A channel with zero capacity is a <i>rendezvous</i> channel: every send blocks
+   * until a receiver takes the value directly from the sender.
+   *
+   * The buffer is allocated once, at construction. Values handed over between parked threads
+   * are moved directly from the sender's stack to the receiver's stack, so no operation allocates.
+   *
+   * Blocked threads sleep on a futex (<code>std::atomic::wait</code>) and are woken only when
+   * their operation has been completed for them, so a send wakes at most one receiver. A send
+   * that nobody receives directly wakes at most one @ref select call.
+   * Waiting on several channels at once is done with @ref select.
+   *
+   * Closing the channel wakes all blocked threads. Receivers drain buffered values first and then
+   * get <code>std::nullopt</code>; senders fail.
+   *
+   * Destroying a channel with blocked threads is undefined behavior.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto ch = fl::channel<std::string>(16);
+   *    auto producer = std::jthread([&] {
+   *      for(auto i = 0; i < 10; ++i)
+   *        ch.send(std::to_string(i));
+   *      ch.close();
+   *    });
+   *    while(auto const v = ch.recv())
+   *      std::cout << *v << '\n';
+   * @endcode
+   * @tparam T Type of values. Must be nothrow move constructible.
+   * @see select
+   */
+  template <typename T>
+  requires std::is_nothrow_move_constructible_v<T>
+  class channel : pin
+  {
+   public:
+    using value_type = T;
+
+    /**
+     * @brief Creates an open channel.
+     * @param capacity Number of values the channel can buffer. Zero creates a rendezvous channel.
+     */
+    explicit channel(usize capacity = 0)
+      : buffer_(capacity)
+    {}
+
+    ~channel() = default;
+
+    /**
+     * @brief Sends a value, blocking until it is buffered or taken by a receiver.
+     * @param value Value to send.
+     * @return <code>true</code> if the value was sent, <code>false</code> if the channel is closed.
+     */
+    bool send(T value) {
+      auto lock = std::unique_lock(this->mutex_);
+      if(this->closed_)
+        return false;
+      if(this->deliver(value))
+        return true;
+      auto sender = parked_sender();
+      sender.value = &value;
+      this->senders_.push(&sender);
+      this->notify_selector();
+      lock.unlock();
+      sender.park();
+      lock.lock();
+      return sender.state.load(std::memory_order_relaxed) == detail::channel_waiter::done;
+    }
+
+    /**
+     * @brief Sends a value if that is possible without blocking.
+     * @details Rendezvous channel accepts the value only if some thread is blocked in @ref recv.
+     * @param value Value to send. Left intact on failure.
+     * @return <code>true</code> if the value was sent, <code>false</code> if the channel is full or closed.
+     */
+    bool try_send(T&& value) {
+      auto const lock = std::lock_guard(this->mutex_);
+      return not this->closed_ and this->deliver(value);
+    }
+
+    /**
+     * @brief Sends a copy of the value if that is possible without blocking.
+     * @param value Value to send.
+     * @return <code>true</code> if the value was sent, <code>false</code> if the channel is full or closed.
+     */
+    bool try_send(T const& value) {
+      auto copy = T(value);
+      return this->try_send(std::move(copy));
+    }
+
+    /**
+     * @brief Receives a value, blocking until one is available.
+     * @return Received value or <code>std::nullopt</code> if the channel is closed and drained.
+     */
+    [[nodiscard]] std::optional<T> recv() {
+      auto result = std::optional<T>();
+      auto lock = std::unique_lock(this->mutex_);
+      if(this->take(result) != channel_status::empty)
+        return result;
+      auto receiver = parked_receiver();
+      receiver.slot = &result;
+      this->receivers_.push(&receiver);
+      lock.unlock();
+      receiver.park();
+      lock.lock();
+      return result;
+    }
+
+    /**
+     * @brief Receives a value if one is available without blocking.
+     * @return Received value or <code>std::nullopt</code> if the channel is empty or closed.
+     */
+    [[nodiscard]] std::optional<T> try_recv() {
+      auto result = std::optional<T>();
+      auto const lock = std::lock_guard(this->mutex_);
+      static_cast<void>(this->take(result));
+      return result;
+    }
+
+    /**
+     * @brief Closes the channel and wakes all blocked threads. Closing a closed channel has no effect.
+     */
+    void close() {
+      auto const lock = std::lock_guard(this->mutex_);
+      if(this->closed_)
+        return;
+      this->closed_ = true;
+      while(auto* const sender = this->senders_.pop())
+        sender->wake(detail::channel_waiter::closed);
+      while(auto* const receiver = this->receivers_.pop())
+        receiver->wake(detail::channel_waiter::closed);
+      this->notify_selectors();
+    }
+
+    /**
+     * @brief Returns <code>true</code> if the channel is closed.
+     */
+    [[nodiscard]] bool closed() const {
+      auto const lock = std::lock_guard(this->mutex_);
+      return this->closed_;
+    }
+
+    /**
+     * @brief Returns number of buffered values.
+     */
+    [[nodiscard]] usize size() const {
+      auto const lock = std::lock_guard(this->mutex_);
+      return this->size_;
+    }
+
+    /**
+     * @brief Returns capacity of the buffer. Zero for rendezvous channels.
+     */
+    [[nodiscard]] usize capacity() const noexcept { return this->buffer_.size(); }
+
+   private:
+    friend struct detail::channel_access;
+
+    struct parked_sender : detail::channel_waiter
+    {
+      T* value = nullptr;
+      parked_sender* next = nullptr;
+    };
+
+    struct parked_receiver : detail::channel_waiter
+    {
+      std::optional<T>* slot = nullptr;
+      parked_receiver* next = nullptr;
+    };
+
+    /**
+     * Hands the value to a parked receiver or puts it into the buffer. Requires the lock.
+     */
+    [[nodiscard]] bool deliver(T& value) {
+      if(auto* const receiver = this->receivers_.pop()) {
+        receiver->slot->emplace(std::move(value));
+        receiver->wake(detail::channel_waiter::done);
+        return true;
+      }
+      if(this->size_ == this->buffer_.size())
+        return false;
+      this->buffer_[(this->head_ + this->size_) % this->buffer_.size()].emplace(std::move(value));
+      ++this->size_;
+      this->notify_selector();
+      return true;
+    }
+
+    /**
+     * Takes the next value from the buffer or from a parked sender. Requires the lock.
+     */
+    [[nodiscard]] channel_status take(std::optional<T>& out) {
+      if(this->size_ != 0) {
+        auto& front = this->buffer_[this->head_];
+        out.emplace(std::move(*front));
+        front.reset();
+        this->head_ = (this->head_ + 1) % this->buffer_.size();
+        --this->size_;
+        if(auto* const sender = this->senders_.pop()) {
+          this->buffer_[(this->head_ + this->size_) % this->buffer_.size()].emplace(std::move(*sender->value));
+          ++this->size_;
+          sender->wake(detail::channel_waiter::done);
+        }
+        return channel_status::received;
+      }
+      if(auto* const sender = this->senders_.pop()) {
+        out.emplace(std::move(*sender->value));
+        sender->wake(detail::channel_waiter::done);
+        return channel_status::received;
+      }
+      return this->closed_ ? channel_status::closed : channel_status::empty;
+    }
+
+    /**
+     * Wakes one select call waiting on this channel, skipping the ones that have already been
+     * woken by this or another channel. Requires the lock.
+     */
+    void notify_selector() noexcept {
+      for(auto* selector = this->selectors_; selector; selector = selector->next)
+        if(selector->waiter->claim(detail::channel_waiter::done))
+          return;
+    }
+
+    /**
+     * Wakes all select calls waiting on this channel, on close. Requires the lock.
+     */
+    void notify_selectors() noexcept {
+      for(auto* selector = this->selectors_; selector; selector = selector->next)
+        static_cast<void>(selector->waiter->claim(detail::channel_waiter::done));
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<std::optional<T>> buffer_;
+    usize head_ = 0;
+    usize size_ = 0;
+    bool closed_ = false;
+    detail::channel_wait_queue<parked_sender> senders_;
+    detail::channel_wait_queue<parked_receiver> receivers_;
+    detail::channel_selector* selectors_ = nullptr;
+  };
+
+  /**
+   * @brief Receive case of @ref select.
+   * @see on_recv
+   */
+  template <typename T, typename F>
+  struct recv_case
+  {
+    channel<T>& ch; ///< Channel to receive from.
+    F handler;      ///< Handler to invoke with the received <code>std::optional<T></code>.
+  };
+
+  /**
+   * @brief Creates a receive case for @ref select.
+   * @param ch Channel to receive from.
+   * @param handler Handler to invoke with <code>std::optional<T></code>: the received value, or
+   * <code>std::nullopt</code> if the channel is closed and drained.
+   */
+  template <typename T, std::invocable<std::optional<T>&&> F>
+  [[nodiscard]] recv_case<T, std::decay_t<F>> on_recv(channel<T>& ch, F&& handler) {
+    return { ch, std::forward<F>(handler) };
+  }
+
+  namespace detail
+  {
+    template <typename T, typename F>
+    [[nodiscard]] bool try_select_case(recv_case<T, F>& c) {
+      auto value = std::optional<T>();
+      if(channel_access::try_recv(c.ch, value) == channel_status::empty)
+        return false;
+      std::invoke(c.handler, std::move(value));
+      return true;
+    }
+
+    template <typename... Cases>
+    [[nodiscard]] usize try_select_from(usize start, Cases&... cases) {
+      constexpr auto count = sizeof...(Cases);
+      for(auto offset = usize(0); offset < count; ++offset) {
+        auto const target = (start + offset) % count;
+        auto index = usize(0);
+        auto fired = false;
+        static_cast<void>(((index++ == target and (fired = try_select_case(cases))) or ...));
+        if(fired)
+          return target;
+      }
+      return count;
+    }
+
+    [[nodiscard]] inline usize select_rotation() noexcept {
+      thread_local auto rotation = usize(0);
+      return rotation++;
+    }
+  } // namespace detail
+
+  /**
+   * @brief Receives from the first channel that has a value available, without blocking.
+   * @details Channels are polled starting from a rotating position, so that no channel is starved.
+   * The handler of the chosen case is invoked on the calling thread. A closed and drained
+   * channel counts as ready.
+   * @param cases Receive cases created with @ref on_recv.
+   * @return Index of the fired case or <code>std::nullopt</code> if no channel was ready.
+   */
+  template <typename... Cases>
+  std::optional<usize> try_select(Cases&&... cases) {
+    auto const index = detail::try_select_from(detail::select_rotation(), cases...);
+    return index == sizeof...(Cases) ? std::nullopt : std::optional(index);
+  }
+
+  /**
+   * @brief Blocks until one of the channels has a value and receives it.
+   * @details Equivalent of Go's <code>select</code> statement with receive cases only. The calling
+   * thread subscribes to all channels and sleeps on a futex until any of them gets a value,
+   * a parked sender or is closed; there is no polling. A value wakes at most one of the select
+   * calls waiting on its channel, and closing a channel wakes all of them. If several channels are
+   * ready, they are chosen in rotating order.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto numbers = fl::channel<int>(8);
+   *    auto words = fl::channel<std::string>(8);
+   *    ...
+   *    fl::select(
+   *      fl::on_recv(numbers, [](std::optional<int> v) { ... }),
+   *      fl::on_recv(words, [](std::optional<std::string> v) { ... })
+   *    );
+   * @endcode
+   * @param cases Receive cases created with @ref on_recv.
+   * @return Index of the fired case.
+   * @note A zero-capacity channel is ready for <code>select</code> only when a sender is blocked
+   * in @ref channel::send. @ref channel::try_send does not see threads blocked in <code>select</code>.
+   */
+  template <typename... Cases>
+  requires(sizeof...(Cases) > 0)
+  usize select(Cases&&... cases) {
+    constexpr auto count = sizeof...(Cases);
+    auto const start = detail::select_rotation();
+    if(auto const index = detail::try_select_from(start, cases...); index != count)
+      return index;
+    auto waiter = detail::channel_waiter();
+    auto selectors = std::array<detail::channel_selector, count>();
+    for(auto& selector : selectors)
+      selector.waiter = &waiter;
+    auto const unsubscribe = [&] {
+      auto i = usize(0);
+      (detail::channel_access::unsubscribe(cases.ch, selectors[i++]), ...);
+    };
+    while(true) {
+      waiter.state.store(detail::channel_waiter::waiting, std::memory_order_relaxed);
+      {
+        auto i = usize(0);
+        (detail::channel_access::subscribe(cases.ch, selectors[i++]), ...);
+      }
+      auto index = count;
+      try {
+        // re-check after subscribing: values sent before the subscription produced no wakeup
+        index = detail::try_select_from(start, cases...);
+      } catch(...) {
+        unsubscribe();
+        throw;
+      }
+      if(index == count)
+        waiter.park();
+      unsubscribe();
+      if(index != count)
+        return index;
+      if(index = detail::try_select_from(start, cases...); index != count)
+        return index;
+    }
+  }
+} // namespace fl
\ No newline at end of file
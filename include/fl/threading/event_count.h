@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  /**
+   * @brief Event count: condition variable for lock-free data structures.
+   * @details Lets threads sleep until some condition on lock-free state becomes true, without
+   * holding a mutex around that state. Waiting is built on <code>std::atomic::wait</code>,
+   * which is a futex on Linux.
+   *
+   * The waiting side follows the protocol below. Notifying side must make the condition true
+   * first and then call @ref notify_one or @ref notify_all. Notification is a single fence and
+   * a load when nobody is waiting.
+   *
+   * @code {.cpp}
+   *    auto events = fl::event_count();
+   *
+   *    // consumer
+   *    while(true) {
+   *      if(auto v = queue.try_pop())
+   *        return v;
+   *      auto const key = events.prepare_wait();
+   *      if(auto v = queue.try_pop()) {
+   *        events.cancel_wait();
+   *        return v;
+   *      }
+   *      events.wait(key);
+   *    }
+   *
+   *    // producer
+   *    queue.try_push(value);
+   *    events.notify_one();
+   * @endcode
+   * @sa https://github.com/facebook/folly/blob/main/folly/experimental/EventCount.h
+   */
+  class event_count : pin
+  {
+   public:
+    /**
+     * @brief Opaque value returned from @ref prepare_wait.
+     */
+    using key_type = u32;
+
+    event_count() = default;
+    ~event_count() = default;
+
+    /**
+     * @brief Announces intention to wait.
+     * @details Must be followed by either @ref cancel_wait or @ref wait. The condition must be
+     * re-checked between this call and @ref wait.
+     * @return Key to pass to @ref wait.
+     */
+    [[nodiscard]] key_type prepare_wait() noexcept {
+      this->waiters_.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      return this->epoch_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Withdraws intention to wait, announced by @ref prepare_wait.
+     */
+    void cancel_wait() noexcept {
+      this->waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Blocks until notified after the @ref prepare_wait call that returned <code>key</code>.
+     * @param key Key returned from @ref prepare_wait.
+     */
+    void wait(key_type key) noexcept {
+      this->epoch_.wait(key, std::memory_order_acquire);
+      this->waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Wakes at least one thread blocked in @ref wait.
+     */
+    void notify_one() noexcept {
+      if(this->advance())
+        this->epoch_.notify_one();
+    }
+
+    /**
+     * @brief Wakes all threads blocked in @ref wait.
+     */
+    void notify_all() noexcept {
+      if(this->advance())
+        this->epoch_.notify_all();
+    }
+
+   private:
+    [[nodiscard]] bool advance() noexcept {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(this->waiters_.load(std::memory_order_relaxed) == 0)
+        return false;
+      this->epoch_.fetch_add(1, std::memory_order_release);
+      return true;
+    }
+
+    std::atomic<key_type> epoch_ = 0;
+    std::atomic<u32> waiters_ = 0;
+  };
+} // namespace fl
\ No newline at end of file
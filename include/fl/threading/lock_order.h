@@ -0,0 +1,177 @@
+#pragma once
+
+#include <source_location>
+#include "../concepts/threading.h"
+#include "../global/definitions.h"
+#include "../global/export.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  /**
+   * @brief Lock-order checker implementation details.
+   */
+  namespace detail::lock_order
+  {
+    /**
+     * @brief Unique identifier of a checked lock.
+     */
+    using lock_id = u64;
+
+    /**
+     * @brief Registers a new lock in the global lock-order graph.
+     * @return Unique identifier of the lock.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    lock_id register_lock() noexcept;
+
+    /**
+     * @brief Removes the lock and all edges related to it from the global lock-order graph.
+     * @param id Lock identifier.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void unregister_lock(lock_id id) noexcept;
+
+    /**
+     * @brief Records that the current thread is about to acquire the lock.
+     * @details Adds edges from every lock held by the current thread to the acquired lock.
+     * If any of the new edges closes a cycle in the graph, reports an invariant violation through
+     * @ref fl::contracts with both the current location and the location where the opposite order
+     * was established.
+     * @param id Lock identifier.
+     * @param location Location of the acquisition.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void before_lock(lock_id id, std::source_location location);
+
+    /**
+     * @brief Records that the current thread has acquired the lock.
+     * @param id Lock identifier.
+     * @param location Location of the acquisition.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void after_lock(lock_id id, std::source_location location);
+
+    /**
+     * @brief Records that the current thread has released the lock.
+     * @param id Lock identifier.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void after_unlock(lock_id id) noexcept;
+  } // namespace detail::lock_order
+
+  /**
+   * @brief Lockable wrapper that checks global lock acquisition order.
+   * @details In debug mode (see @ref FL_DEBUG), every acquisition is recorded in a process-wide
+   * lock-order graph: acquiring lock <i>B</i> while holding lock <i>A</i> adds an edge <i>A → B</i>.
+   * If a new edge closes a cycle, a potential deadlock exists even if it did not happen in this run,
+   * and an invariant violation is reported with source locations of both conflicting acquisitions.
+   *
+   * In release mode (see @ref FL_NO_DEBUG) the wrapper has the same size as the wrapped lockable
+   * and forwards all calls without any bookkeeping.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    fl::order_checked<std::mutex> a, b;
+   *
+   *    // thread 1
+   *    a.lock(); b.lock(); b.unlock(); a.unlock();
+   *
+   *    // thread 2, even much later
+   *    b.lock(); a.lock(); // contract violation: lock order inversion
+   * @endcode
+   * @note When used with <code>std::lock_guard</code> or <code>std::scoped_lock</code>, reported
+   * source locations will point into the standard library. Call <code>lock()</code> explicitly to get
+   * the location of the caller.
+   * @tparam Mutex Wrapped lockable type.
+   */
+  template <concepts::basic_lockable Mutex>
+  class order_checked : pin
+  {
+   public:
+    using mutex_type = Mutex;
+
+    /**
+     * @brief Creates the wrapped lockable and registers it in the lock-order graph.
+     */
+    order_checked()
+    #if defined(FL_DEBUG)
+      : id_(detail::lock_order::register_lock())
+    #endif
+    {}
+
+    /**
+     * @brief Removes the lock from the lock-order graph.
+     */
+    ~order_checked() {
+      ___fl_debug_only___(detail::lock_order::unregister_lock(this->id_));
+    }
+
+    /**
+     * @brief Acquires the lock, checking the acquisition order.
+     * @param location Location of the acquisition. Defaults to the caller location.
+     */
+    void lock(
+      #ifndef FL_DOC
+      ___fl_release_unused___
+      #endif // FL_DOC
+      std::source_location location = std::source_location::current()
+    ) {
+      ___fl_debug_only___(detail::lock_order::before_lock(this->id_, location));
+      this->mutex_.lock();
+      ___fl_debug_only___(detail::lock_order::after_lock(this->id_, location));
+    }
+
+    /**
+     * @brief Attempts to acquire the lock without blocking.
+     * @details Failed attempts can not deadlock and are not checked. Successful attempts are
+     * recorded as held, so that locks acquired afterwards are ordered after this one.
+     * @param location Location of the acquisition. Defaults to the caller location.
+     * @return <code>true</code> if the lock was acquired.
+     */
+    bool try_lock(
+      #ifndef FL_DOC
+      ___fl_release_unused___
+      #endif // FL_DOC
+      std::source_location location = std::source_location::current()
+    ) requires concepts::lockable<Mutex> {
+      if(not this->mutex_.try_lock())
+        return false;
+      ___fl_debug_only___(detail::lock_order::after_lock(this->id_, location));
+      return true;
+    }
+
+    /**
+     * @brief Releases the lock.
+     */
+    void unlock() {
+      ___fl_debug_only___(detail::lock_order::after_unlock(this->id_));
+      this->mutex_.unlock();
+    }
+
+    /**
+     * @brief Returns reference to the wrapped lockable.
+     * @warning Locking the wrapped lockable directly bypasses the checks.
+     */
+    [[nodiscard]] Mutex& underlying() noexcept { return this->mutex_; }
+
+   private:
+    Mutex mutex_;
+    #if defined(FL_DEBUG)
+    detail::lock_order::lock_id id_;
+    #endif
+  };
+} // namespace fl
\ No newline at end of file
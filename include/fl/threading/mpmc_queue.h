@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include "../contracts.h"
+#include "../memory/cache_padded.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  /**
+   * @brief Bounded lock-free multi-producer multi-consumer queue.
+   * @details Dmitry Vyukov's bounded queue: a ring buffer of power-of-two capacity where every
+   * cell carries a sequence number telling whether it is ready to be written or read on the
+   * current lap. Producers and consumers claim positions with a single CAS on their shared
+   * index, which lives on its own cache line, and then synchronize only through the claimed cell.
+   *
+   * Batch operations claim a run of consecutive ready cells with one CAS, so the shared index
+   * is touched once per batch instead of once per element.
+   *
+   * All operations are lock-free. For blocking operations see @ref blocking_queue.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto queue = fl::mpmc_queue<std::string>(256);
+   *    queue.try_push("hello");
+   *    auto const value = queue.try_pop(); // "hello"
+   * @endcode
+   * @tparam T Type of elements. Must be nothrow move constructible.
+   * @see spsc_queue
+   * @see blocking_queue
+   * @sa https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+   */
+  template <typename T>
+  requires std::is_nothrow_move_constructible_v<T> and std::is_nothrow_destructible_v<T>
+  class mpmc_queue : pin
+  {
+   public:
+    using value_type = T;
+
+    /**
+     * @brief Creates an empty queue.
+     * @param capacity Minimal capacity of the queue. Rounded up to a power of two. Must be positive.
+     */
+    explicit mpmc_queue(usize capacity)
+      : mask_(std::bit_ceil(capacity) - 1)
+      , cells_(std::make_unique<cell[]>(this->mask_ + 1)) // NOLINT(*-avoid-c-arrays)
+    {
+      if(capacity == 0)
+        contracts::broken_precondition("mpmc_queue capacity must be positive");
+      for(auto i = usize(0); i <= this->mask_; ++i)
+        this->cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    ~mpmc_queue() {
+      auto const tail = this->tail_->load(std::memory_order_acquire);
+      for(auto head = this->head_->load(std::memory_order_relaxed); head != tail; ++head)
+        std::destroy_at(this->cells_[head & this->mask_].get());
+    }
+
+    /**
+     * @brief Constructs an element at the back of the queue.
+     * @details If the constructor of <code>T</code> may throw, the element is constructed
+     * before a cell is claimed and then moved into it.
+     * @param args Arguments to pass to the constructor of <code>T</code>.
+     * @return <code>true</code> if the element was pushed, <code>false</code> if the queue is full.
+     */
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+      if constexpr(std::is_nothrow_constructible_v<T, Args...>) {
+        auto const position = this->claim(this->tail_, 0, 1);
+        if(position.count == 0)
+          return false;
+        auto& c = this->cells_[position.first & this->mask_];
+        std::construct_at(c.get(), std::forward<Args>(args)...);
+        c.sequence.store(position.first + 1, std::memory_order_release);
+        return true;
+      } else {
+        auto value = T(std::forward<Args>(args)...);
+        return this->try_emplace(std::move(value));
+      }
+    }
+
+    /**
+     * @brief Pushes an element to the back of the queue.
+     * @param value Value to push.
+     * @return <code>true</code> if the element was pushed, <code>false</code> if the queue is full.
+     */
+    bool try_push(T const& value) { return this->try_emplace(value); }
+
+    /**
+     * @brief Pushes an element to the back of the queue.
+     * @param value Value to push. Left intact if the queue is full.
+     * @return <code>true</code> if the element was pushed, <code>false</code> if the queue is full.
+     */
+    bool try_push(T&& value) noexcept { return this->try_emplace(std::move(value)); }
+
+    /**
+     * @brief Moves a prefix of the span to the back of the queue.
+     * @details Claims all consecutive free cells (up to <code>values.size()</code>) with a single
+     * CAS. Elements of one batch are contiguous in the queue.
+     * @param values Values to push. Pushed values are left in moved-from state.
+     * @return Number of pushed values, i.e. length of the pushed prefix of <code>values</code>.
+     */
+    usize try_push_n(std::span<T> values) noexcept {
+      auto const position = this->claim(this->tail_, 0, values.size());
+      for(auto i = usize(0); i < position.count; ++i) {
+        auto& c = this->cells_[(position.first + i) & this->mask_];
+        std::construct_at(c.get(), std::move(values[i]));
+        c.sequence.store(position.first + i + 1, std::memory_order_release);
+      }
+      return position.count;
+    }
+
+    /**
+     * @brief Pops an element from the front of the queue.
+     * @return Popped element or <code>std::nullopt</code> if the queue is empty.
+     */
+    [[nodiscard]] std::optional<T> try_pop() noexcept {
+      auto const position = this->claim(this->head_, 1, 1);
+      if(position.count == 0)
+        return std::nullopt;
+      return this->take(position.first);
+    }
+
+    /**
+     * @brief Pops up to <code>max</code> elements from the front of the queue.
+     * @details Claims all consecutive ready cells (up to <code>max</code>) with a single CAS.
+     * @param out Output iterator to move popped elements to.
+     * @param max Maximal number of elements to pop.
+     * @return Number of popped elements.
+     */
+    template <std::output_iterator<T> O>
+    usize try_pop_n(O out, usize max) {
+      auto const position = this->claim(this->head_, 1, max);
+      auto i = usize(0);
+      try {
+        for(; i < position.count; ++i)
+          *out++ = this->take(position.first + i);
+      } catch(...) {
+        // claimed cells must be released no matter what
+        for(++i; i < position.count; ++i)
+          static_cast<void>(this->take(position.first + i));
+        throw;
+      }
+      return position.count;
+    }
+
+    /**
+     * @brief Returns approximate number of elements in the queue.
+     */
+    [[nodiscard]] usize size() const noexcept {
+      auto const head = this->head_->load(std::memory_order_acquire);
+      auto const tail = this->tail_->load(std::memory_order_acquire);
+      return tail > head ? std::min(tail - head, this->mask_ + 1) : 0;
+    }
+
+    /**
+     * @brief Returns <code>true</code> if the queue appears empty.
+     */
+    [[nodiscard]] bool empty() const noexcept { return this->size() == 0; }
+
+    /**
+     * @brief Returns the maximal number of elements the queue can hold.
+     */
+    [[nodiscard]] usize capacity() const noexcept { return this->mask_ + 1; }
+
+   private:
+    struct cell
+    {
+      std::atomic<usize> sequence;
+      alignas(T) std::byte bytes[sizeof(T)]; // NOLINT(*-avoid-c-arrays)
+
+      [[nodiscard]] T* get() noexcept { return reinterpret_cast<T*>(this->bytes); } // NOLINT(*-reinterpret-cast)
+    };
+
+    struct claimed
+    {
+      usize first;
+      usize count;
+    };
+
+    /**
+     * Claims up to <tt>max</tt> consecutive cells starting at <tt>index</tt>. Cell at position
+     * <tt>p</tt> is ready when its sequence equals <tt>p + lag</tt>: lag is 0 for producers
+     * and 1 for consumers.
+     */
+    [[nodiscard]] claimed claim(cache_padded<std::atomic<usize>>& index, usize lag, usize max) noexcept {
+      auto position = index->load(std::memory_order_relaxed);
+      while(max != 0) {
+        auto count = usize(0);
+        auto stale = false;
+        while(count < max and count <= this->mask_) {
+          auto const sequence = this->cells_[(position + count) & this->mask_].sequence.load(std::memory_order_acquire);
+          auto const difference = static_cast<isize>(sequence - (position + count + lag));
+          if(difference != 0) {
+            // cell of a later lap means some other thread has already claimed this position
+            stale = count == 0 and difference > 0;
+            break;
+          }
+          ++count;
+        }
+        if(count == 0 and not stale)
+          return { .first = position, .count = 0 };
+        if(count != 0 and index->compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+          return { .first = position, .count = count };
+        if(stale)
+          position = index->load(std::memory_order_relaxed);
+      }
+      return { .first = position, .count = 0 };
+    }
+
+    [[nodiscard]] T take(usize position) noexcept {
+      auto& c = this->cells_[position & this->mask_];
+      auto result = T(std::move(*c.get()));
+      std::destroy_at(c.get());
+      c.sequence.store(position + this->mask_ + 1, std::memory_order_release);
+      return result;
+    }
+
+    usize mask_;
+    std::unique_ptr<cell[]> cells_; // NOLINT(*-avoid-c-arrays)
+    cache_padded<std::atomic<usize>> tail_;
+    cache_padded<std::atomic<usize>> head_;
+  };
+} // namespace fl
\ No newline at end of file
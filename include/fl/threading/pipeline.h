@@ -0,0 +1,663 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "blocking_queue.h"
+#include "sharded_counter.h"
+#include "../contracts.h"
+#include "../global/definitions.h"
+#include "../global/export.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  /**
+   * @brief Configuration of a @ref pipeline stage.
+   */
+  struct stage_options
+  {
+    std::string name = {};     ///< Name of the stage, reported in statistics.
+    usize concurrency = 1;     ///< Number of worker threads. One makes the stage serial. Sources are always serial.
+    bool ordered = false;      ///< Whether the stage must consume items in the order produced by the previous stage.
+    usize queue_capacity = 64; ///< Capacity of the input queue of the stage. Rounded up to a power of two. Ignored for sources.
+  };
+
+  /**
+   * @brief Runtime statistics of a @ref pipeline stage.
+   * @details A stage with full input queue and low @ref stalled time is the bottleneck. A stage with
+   * high @ref stalled time is waiting for the stages after it.
+   */
+  struct stage_statistics
+  {
+    std::string name;                 ///< Name of the stage.
+    usize concurrency;                ///< Number of worker threads.
+    u64 processed;                    ///< Number of items processed by the stage.
+    f64 throughput;                   ///< Items processed per second of pipeline run time.
+    usize queue_depth;                ///< Current number of items in the input queue. Zero for sources.
+    usize queue_capacity;             ///< Capacity of the input queue. Zero for sources.
+    std::chrono::nanoseconds busy;    ///< Time spent in the stage function, summed over all workers.
+    std::chrono::nanoseconds stalled; ///< Time spent waiting for space in the output queue, summed over all workers.
+  };
+
+  class pipeline;
+
+  namespace detail::pipeline
+  {
+    template <typename T>
+    struct item
+    {
+      u64 sequence;
+      T value;
+    };
+
+    template <typename T>
+    using queue = blocking_mpmc_queue<item<T>>;
+
+    template <typename F, typename T>
+    struct transform_result
+    {
+      using type = std::invoke_result_t<F&, T&&>;
+    };
+
+    template <typename F, typename T>
+    requires requires { typename std::invoke_result_t<F&, T&&>::value_type; }
+      and std::same_as<std::invoke_result_t<F&, T&&>, std::optional<typename std::invoke_result_t<F&, T&&>::value_type>>
+    struct transform_result<F, T>
+    {
+      using type = typename std::invoke_result_t<F&, T&&>::value_type;
+    };
+
+    /**
+     * Output type of a transform stage. Transforms returning <tt>std::optional</tt> act as filters.
+     */
+    template <typename F, typename T>
+    using transform_result_t = typename transform_result<F, T>::type;
+
+    class core;
+
+    /**
+     * Type-erased stage. Owns the stage function, the counters and the output queue.
+     */
+    class stage : pin
+    {
+     public:
+      explicit stage(stage_options options);
+      virtual ~stage() = default;
+
+      virtual void start(core& c, std::vector<std::jthread>& threads) = 0;
+      virtual void cancel() noexcept = 0;
+      [[nodiscard]] virtual usize queue_depth() const noexcept = 0;
+      [[nodiscard]] virtual usize queue_capacity() const noexcept = 0;
+
+      [[nodiscard]]
+      #ifndef FL_DOC
+      ___fl_api___
+      #endif // FL_DOC
+      stage_statistics statistics(std::chrono::nanoseconds elapsed) const;
+
+     protected:
+      /**
+       * Measures time spent in the stage function or in pushing downstream.
+       */
+      template <typename F>
+      decltype(auto) timed(sharded_counter& counter, F&& f) {
+        auto const start = std::chrono::steady_clock::now();
+        struct record
+        {
+          sharded_counter& counter;
+          std::chrono::steady_clock::time_point start;
+
+          ~record() {
+            this->counter.add(static_cast<u64>((std::chrono::steady_clock::now() - this->start).count()));
+          }
+        } const r { counter, start };
+        return std::invoke(std::forward<F>(f));
+      }
+
+      stage_options options_;
+      sharded_counter processed_;
+      sharded_counter busy_;
+      sharded_counter stalled_;
+      std::atomic<usize> active_ = 0;
+    };
+
+    /**
+     * Shared state of a running pipeline.
+     */
+    class core : pin
+    {
+     public:
+      core() = default;
+      ~core() = default;
+
+      /**
+       * Records the first error and cancels the pipeline.
+       */
+      #ifndef FL_DOC
+      ___fl_api___
+      #endif // FL_DOC
+      void fail(std::exception_ptr error) noexcept;
+
+      #ifndef FL_DOC
+      ___fl_api___
+      #endif // FL_DOC
+      void cancel() noexcept;
+
+      [[nodiscard]] bool cancelled() const noexcept { return this->cancelled_.load(std::memory_order_acquire); }
+
+      std::vector<std::unique_ptr<stage>> stages;
+      std::chrono::steady_clock::time_point started;
+      std::atomic<std::chrono::steady_clock::time_point> finished;
+      std::exception_ptr error;
+
+     private:
+      std::atomic<bool> cancelled_ = false;
+      std::mutex mutex_;
+    };
+
+    /**
+     * Restores the source order of items, for ordered stages. Items are delivered under the lock,
+     * so delivery is serialized.
+     *
+     * Only items within <code>window</code> of the next item to deliver are accepted: workers holding
+     * later items wait in @ref acquire, so a slow head item throttles the stage instead of letting the
+     * buffer grow. Input queues receive items in sequence order, so the head item is always held by a
+     * worker that is not waiting.
+     */
+    template <typename T>
+    class reorder_buffer
+    {
+     public:
+      explicit reorder_buffer(usize window)
+        : window_(window)
+      {}
+
+      /**
+       * Waits until the item with the given sequence number fits into the window.
+       * Returns false if the buffer was cancelled.
+       */
+      bool acquire(u64 sequence) {
+        auto lock = std::unique_lock(this->mutex_);
+        this->space_.wait(lock, [&] { return this->cancelled_ or sequence - this->next_ < this->window_; });
+        return not this->cancelled_;
+      }
+
+      /**
+       * Stores the item and delivers every ready item at the head of the buffer.
+       * Returns false if delivery failed or the buffer was cancelled.
+       * @note <code>deliver</code> runs under the lock, so it must fail instead of blocking once the
+       * stage is cancelled: @ref cancel waits for the lock.
+       */
+      template <typename Deliver>
+      bool submit(u64 sequence, std::optional<T>&& value, Deliver&& deliver) {
+        auto const lock = std::lock_guard(this->mutex_);
+        if(this->cancelled_)
+          return false;
+        auto const offset = static_cast<usize>(sequence - this->next_);
+        if(this->slots_.size() <= offset)
+          this->slots_.resize(offset + 1);
+        this->slots_[offset] = slot { .ready = true, .value = std::move(value) };
+        auto const next = this->next_;
+        auto delivered = true;
+        while(delivered and not this->slots_.empty() and this->slots_.front().ready) {
+          auto ready = std::move(this->slots_.front().value);
+          this->slots_.pop_front();
+          ++this->next_;
+          delivered = not ready or std::invoke(deliver, std::move(*ready));
+        }
+        if(this->next_ != next)
+          this->space_.notify_all();
+        return delivered;
+      }
+
+      /**
+       * Wakes up all workers waiting in @ref acquire.
+       */
+      void cancel() noexcept {
+        {
+          auto const lock = std::lock_guard(this->mutex_);
+          this->cancelled_ = true;
+        }
+        this->space_.notify_all();
+      }
+
+     private:
+      struct slot
+      {
+        bool ready = false;
+        std::optional<T> value;
+      };
+
+      std::mutex mutex_;
+      std::condition_variable space_;
+      std::deque<slot> slots_;
+      u64 next_ = 0;
+      usize window_;
+      bool cancelled_ = false;
+    };
+
+    /**
+     * Size of the reorder window of an ordered stage: enough to keep every worker busy while the
+     * head item is late, and not more than the input queue can hold.
+     */
+    [[nodiscard]] inline usize reorder_window(stage_options const& options) noexcept {
+      return std::max(options.queue_capacity, options.concurrency);
+    }
+
+    /**
+     * Stage with an output queue: assigns sequence numbers to produced items and applies backpressure.
+     */
+    template <typename Out>
+    class producing_stage : public stage
+    {
+     public:
+      explicit producing_stage(stage_options options)
+        : stage(std::move(options))
+        , reorder_(reorder_window(this->options_))
+      {}
+
+      void cancel() noexcept override {
+        // closing first fails a push blocked under the reorder lock, which cancelling the buffer waits for
+        this->output_->close();
+        this->reorder_.cancel();
+      }
+
+      /**
+       * Sets the output queue. Called when the next stage is appended.
+       */
+      void connect(std::shared_ptr<queue<Out>> output) noexcept { this->output_ = std::move(output); }
+
+     protected:
+      /**
+       * Waits until the input item with the given sequence number may be processed.
+       * Returns false if the pipeline is shutting down.
+       */
+      bool admit(u64 sequence) { return not this->options_.ordered or this->reorder_.acquire(sequence); }
+
+      /**
+       * Pushes a result produced from the input item with the given sequence number.
+       * Returns false if the pipeline is shutting down.
+       * @note Output items are pushed in sequence order, which bounds reordering in the next stage.
+       */
+      bool emit(u64 sequence, std::optional<Out>&& value) {
+        auto const push = [this](Out&& v, u64 s) {
+          return this->output_->push(item<Out> { .sequence = s, .value = std::move(v) });
+        };
+        if(this->options_.ordered)
+          return this->reorder_.submit(sequence, std::move(value), [&](Out&& v) {
+            return this->timed(this->stalled_, [&] { return push(std::move(v), this->next_++); });
+          });
+        if(not value)
+          return true;
+        return this->timed(this->stalled_, [&] {
+          auto const lock = std::lock_guard(this->emit_mutex_);
+          return push(std::move(*value), this->next_++);
+        });
+      }
+
+      /**
+       * Marks one worker as finished. The last worker closes the output queue.
+       */
+      void leave() noexcept {
+        if(this->active_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+          this->output_->close();
+      }
+
+     private:
+      std::shared_ptr<queue<Out>> output_;
+      reorder_buffer<Out> reorder_;
+      std::mutex emit_mutex_;
+      u64 next_ = 0;
+    };
+
+    template <typename Out, typename F>
+    class source_stage final : public producing_stage<Out>
+    {
+     public:
+      source_stage(F f, stage_options options)
+        : producing_stage<Out>(std::move(options))
+        , f_(std::move(f))
+      {
+        this->options_.concurrency = 1;
+        this->options_.ordered = false;
+      }
+
+      [[nodiscard]] usize queue_depth() const noexcept override { return 0; }
+      [[nodiscard]] usize queue_capacity() const noexcept override { return 0; }
+
+      void start(core& c, std::vector<std::jthread>& threads) override {
+        this->active_.store(1, std::memory_order_relaxed);
+        threads.emplace_back([this, &c] {
+          try {
+            for(auto sequence = u64(0); not c.cancelled(); ++sequence) {
+              auto value = this->timed(this->busy_, this->f_);
+              if(not value)
+                break;
+              this->processed_.increment();
+              if(not this->emit(sequence, std::move(value)))
+                break;
+            }
+          } catch(...) {
+            c.fail(std::current_exception());
+          }
+          this->leave();
+        });
+      }
+
+     private:
+      F f_;
+    };
+
+    template <typename In, typename Out, typename F>
+    class transform_stage final : public producing_stage<Out>
+    {
+     public:
+      transform_stage(F f, stage_options options, std::shared_ptr<queue<In>> input)
+        : producing_stage<Out>(std::move(options))
+        , f_(std::move(f))
+        , input_(std::move(input))
+      {}
+
+      [[nodiscard]] usize queue_depth() const noexcept override { return this->input_->size(); }
+      [[nodiscard]] usize queue_capacity() const noexcept override { return this->input_->capacity(); }
+
+      void start(core& c, std::vector<std::jthread>& threads) override {
+        this->active_.store(this->options_.concurrency, std::memory_order_relaxed);
+        for(auto i = usize(0); i < this->options_.concurrency; ++i)
+          threads.emplace_back([this, &c] {
+            try {
+              while(auto input = this->input_->pop()) {
+                if(c.cancelled() or not this->admit(input->sequence))
+                  break;
+                auto output = this->timed(this->busy_, [&] { return std::optional<Out>(std::invoke(this->f_, std::move(input->value))); });
+                this->processed_.increment();
+                if(not this->emit(input->sequence, std::move(output)))
+                  break;
+              }
+            } catch(...) {
+              c.fail(std::current_exception());
+            }
+            this->leave();
+          });
+      }
+
+     private:
+      F f_;
+      std::shared_ptr<queue<In>> input_;
+    };
+
+    template <typename In, typename F>
+    class sink_stage final : public stage
+    {
+     public:
+      sink_stage(F f, stage_options options, std::shared_ptr<queue<In>> input)
+        : stage(std::move(options))
+        , f_(std::move(f))
+        , input_(std::move(input))
+        , reorder_(reorder_window(this->options_))
+      {}
+
+      void cancel() noexcept override { this->reorder_.cancel(); }
+      [[nodiscard]] usize queue_depth() const noexcept override { return this->input_->size(); }
+      [[nodiscard]] usize queue_capacity() const noexcept override { return this->input_->capacity(); }
+
+      void start(core& c, std::vector<std::jthread>& threads) override {
+        for(auto i = usize(0); i < this->options_.concurrency; ++i)
+          threads.emplace_back([this, &c] {
+            try {
+              while(auto input = this->input_->pop()) {
+                if(c.cancelled())
+                  break;
+                if(this->options_.ordered) {
+                  if(not this->reorder_.acquire(input->sequence))
+                    break;
+                  this->reorder_.submit(input->sequence, std::move(input->value), [this](In&& v) { return this->consume(std::move(v)); });
+                } else
+                  this->consume(std::move(input->value));
+              }
+            } catch(...) {
+              c.fail(std::current_exception());
+            }
+          });
+      }
+
+     private:
+      bool consume(In&& value) {
+        this->timed(this->busy_, [&] { std::invoke(this->f_, std::move(value)); });
+        this->processed_.increment();
+        return true;
+      }
+
+      F f_;
+      std::shared_ptr<queue<In>> input_;
+      reorder_buffer<In> reorder_;
+    };
+
+    inline void validate(stage_options const& options) {
+      if(options.concurrency == 0)
+        contracts::broken_precondition("pipeline stage concurrency must be positive");
+      if(options.queue_capacity == 0)
+        contracts::broken_precondition("pipeline stage queue capacity must be positive");
+    }
+  } // namespace detail::pipeline
+
+  /**
+   * @brief Partially built @ref pipeline, whose last stage produces values of type <code>T</code>.
+   * @details Returned from @ref pipeline::from and @ref then. Finished with @ref to.
+   * @tparam T Type of values produced by the last stage.
+   */
+  template <typename T>
+  class pipeline_builder
+  {
+   public:
+    /**
+     * @brief Appends a transform stage.
+     * @details If <code>f</code> returns <code>std::optional<U></code>, the stage is a filter:
+     * <code>std::nullopt</code> results are dropped.
+     * @param f Stage function, taking <code>T&&</code>. Must be safe to call concurrently if <code>options.concurrency > 1</code>.
+     * @param options Stage configuration.
+     * @return Builder whose last stage produces results of <code>f</code>.
+     */
+    template <std::invocable<T&&> F>
+    [[nodiscard]] auto then(F&& f, stage_options options = {}) && -> pipeline_builder<detail::pipeline::transform_result_t<std::decay_t<F>, T>> {
+      using out = detail::pipeline::transform_result_t<std::decay_t<F>, T>;
+      auto input = this->connect(options);
+      auto stage = std::make_unique<detail::pipeline::transform_stage<T, out, std::decay_t<F>>>(
+        std::forward<F>(f),
+        std::move(options),
+        std::move(input)
+      );
+      auto* const last = stage.get();
+      this->stages_.push_back(std::move(stage));
+      return pipeline_builder<out>(std::move(this->stages_), last);
+    }
+
+    /**
+     * @brief Appends the sink stage and returns the finished pipeline.
+     * @param f Stage function, taking <code>T&&</code>. Must be safe to call concurrently if
+     * <code>options.concurrency > 1</code> and <code>options.ordered</code> is false.
+     * @param options Stage configuration. Ordered sink calls <code>f</code> serially, in source order.
+     * @return Pipeline, ready to be started.
+     */
+    template <std::invocable<T&&> F>
+    [[nodiscard]] pipeline to(F&& f, stage_options options = {}) &&;
+
+   private:
+    friend class pipeline;
+
+    template <typename>
+    friend class pipeline_builder;
+
+    pipeline_builder(std::vector<std::unique_ptr<detail::pipeline::stage>> stages, detail::pipeline::producing_stage<T>* last)
+      : stages_(std::move(stages))
+      , last_(last)
+    {}
+
+    /**
+     * Creates the input queue of the next stage and connects the last stage to it.
+     */
+    [[nodiscard]] std::shared_ptr<detail::pipeline::queue<T>> connect(stage_options const& options) {
+      detail::pipeline::validate(options);
+      auto queue = std::make_shared<detail::pipeline::queue<T>>(options.queue_capacity);
+      this->last_->connect(queue);
+      return queue;
+    }
+
+    std::vector<std::unique_ptr<detail::pipeline::stage>> stages_;
+    detail::pipeline::producing_stage<T>* last_;
+  };
+
+  /**
+   * @brief Multistage pipeline: source → transform × N → sink.
+   * @details Every stage runs on its own worker threads: one thread for the source and for serial
+   * stages, <code>concurrency</code> threads for parallel ones. Adjacent stages are connected by
+   * bounded blocking queues (see @ref blocking_queue), so a slow stage throttles the stages before
+   * it instead of letting queues grow without bound.
+   *
+   * Items are numbered in the order they leave each stage. A stage with <code>ordered = true</code>
+   * processes its results in that order: parallel workers still run the stage function concurrently,
+   * but hand the results downstream (or to the sink function) in order. Source order is kept as long
+   * as every parallel stage is ordered; an unordered parallel stage passes items on as they finish. Workers run ahead of the
+   * oldest unfinished item by at most <code>max(queue_capacity, concurrency)</code> items, so a
+   * single slow item stalls the stage instead of buffering results without bound.
+   *
+   * The source is called until it returns <code>std::nullopt</code>. The pipeline is finished when
+   * the sink has consumed every item. If any stage function throws, the pipeline is cancelled and
+   * @ref wait rethrows the first exception.
+   *
+   * Per-stage statistics, including input queue depth and time spent waiting for downstream
+   * stages, can be queried while the pipeline is running.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto files = std::vector<std::filesystem::path> { ... };
+   *    auto next = usize(0);
+   *    auto p = fl::pipeline::from([&]() -> std::optional<std::filesystem::path> {
+   *        if(next == files.size())
+   *          return std::nullopt;
+   *        return files[next++];
+   *      }, { .name = "list" })
+   *      .then(parse_config, { .name = "parse", .concurrency = 4 })
+   *      .then(transform_geometry, { .name = "geometry", .concurrency = 8, .ordered = true })
+   *      .to(write_output, { .name = "write", .ordered = true });
+   *    p.run();
+   *    for(auto const& s : p.statistics())
+   *      std::cout << s.name << ": " << s.throughput << " items/s, queue " << s.queue_depth << '\n';
+   * @endcode
+   */
+  class pipeline : pin
+  {
+   public:
+    /**
+     * @brief Starts building a pipeline with the given source.
+     * @param source Function returning <code>std::optional<T></code>; <code>std::nullopt</code> ends the stream.
+     * Always called from a single thread.
+     * @param options Source configuration. Only <code>name</code> is used.
+     * @return Builder whose last stage produces values of type <code>T</code>.
+     */
+    template <std::invocable F>
+    requires requires { typename std::invoke_result_t<F&>::value_type; }
+    [[nodiscard]] static auto from(F&& source, stage_options options = {}) {
+      using out = typename std::invoke_result_t<std::decay_t<F>&>::value_type;
+      static_assert(std::same_as<std::invoke_result_t<std::decay_t<F>&>, std::optional<out>>, "source must return std::optional");
+      auto stage = std::make_unique<detail::pipeline::source_stage<out, std::decay_t<F>>>(std::forward<F>(source), std::move(options));
+      auto* const last = stage.get();
+      auto stages = std::vector<std::unique_ptr<detail::pipeline::stage>>();
+      stages.push_back(std::move(stage));
+      return pipeline_builder<out>(std::move(stages), last);
+    }
+
+    pipeline(pipeline&&) = delete;
+
+    /**
+     * @brief Cancels the pipeline if it is running and waits for all workers.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    ~pipeline();
+
+    /**
+     * @brief Starts all stages. Returns immediately.
+     * @note Pipeline can be started only once.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void start();
+
+    /**
+     * @brief Waits until the pipeline finishes.
+     * @throws Any exception thrown by a stage function.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void wait();
+
+    /**
+     * @brief Starts the pipeline and waits until it finishes.
+     * @throws Any exception thrown by a stage function.
+     */
+    void run() {
+      this->start();
+      this->wait();
+    }
+
+    /**
+     * @brief Stops all stages as soon as possible. Items in flight are discarded.
+     */
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    void cancel() noexcept;
+
+    /**
+     * @brief Returns statistics of all stages, from source to sink.
+     * @details Can be called while the pipeline is running.
+     */
+    [[nodiscard]]
+    #ifndef FL_DOC
+    ___fl_api___
+    #endif // FL_DOC
+    std::vector<stage_statistics> statistics() const;
+
+   private:
+    template <typename>
+    friend class pipeline_builder;
+
+    explicit pipeline(std::vector<std::unique_ptr<detail::pipeline::stage>> stages);
+
+    std::unique_ptr<detail::pipeline::core> core_;
+    std::vector<std::jthread> threads_;
+    bool started_ = false;
+  };
+
+  template <typename T>
+  template <std::invocable<T&&> F>
+  pipeline pipeline_builder<T>::to(F&& f, stage_options options) && {
+    auto input = this->connect(options);
+    this->stages_.push_back(std::make_unique<detail::pipeline::sink_stage<T, std::decay_t<F>>>(
+      std::forward<F>(f),
+      std::move(options),
+      std::move(input)
+    ));
+    return pipeline(std::move(this->stages_));
+  }
+} // namespace fl
\ No newline at end of file
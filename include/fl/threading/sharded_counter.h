@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <memory>
+#include <thread>
+#include "../memory/cache_padded.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  namespace detail
+  {
+    /**
+     * @brief Returns a small index unique to the calling thread.
+     * @details Indices are handed out sequentially on the first call from every thread, so that
+     * the first <i>N</i> threads are guaranteed to map onto <i>N</i> distinct slots.
+     */
+    [[nodiscard]] inline usize this_thread_slot() noexcept {
+      static auto next = std::atomic<usize>(0);
+      thread_local auto const index = next.fetch_add(1, std::memory_order_relaxed);
+      return index;
+    }
+  } // namespace detail
+
+  /**
+   * @brief Integer counter, split into per-thread cache-line-sized slots.
+   * @details Writers update only the slot of the calling thread with relaxed atomic operations, so
+   * concurrent increments from different threads never contend for the same cache line. Readers
+   * sum all slots, which makes reading <i>O(slots)</i> and not linearizable with respect to writers:
+   * the result is exact once writers are quiescent.
+   *
+   * Use this class for values which are written much more often than they are read: request
+   * counts, transferred bytes, statistics of checks on hot paths.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto requests = fl::sharded_counter();
+   *    auto in_flight = fl::sharded_gauge();
+   *
+   *    // on every request, from any thread
+   *    requests.increment();
+   *    in_flight.increment();
+   *    ...
+   *    in_flight.decrement();
+   *
+   *    // from the metrics thread
+   *    std::cout << requests.value() << ' ' << in_flight.value() << '\n';
+   * @endcode
+   * @tparam T Underlying integer type.
+   * @see sharded_counter
+   * @see sharded_gauge
+   */
+  template <std::integral T>
+  class basic_sharded_counter : pin
+  {
+   public:
+    using value_type = T;
+
+    /**
+     * @brief Creates a zero-initialized counter.
+     * @param slots Number of slots. Rounded up to a power of two. Defaults to the number of hardware threads.
+     */
+    explicit basic_sharded_counter(usize slots = default_slot_count())
+      : mask_(std::bit_ceil(std::max(slots, usize(1))) - 1)
+      , slots_(std::make_unique<cache_padded<std::atomic<T>>[]>(this->mask_ + 1)) // NOLINT(*-avoid-c-arrays)
+    {}
+
+    ~basic_sharded_counter() = default;
+
+    /**
+     * @brief Adds the value to the slot of the calling thread.
+     * @param value Value to add.
+     */
+    void add(T value) noexcept {
+      this->slot()->fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Subtracts the value from the slot of the calling thread.
+     * @param value Value to subtract.
+     */
+    void sub(T value) noexcept {
+      this->slot()->fetch_sub(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Adds one to the slot of the calling thread.
+     */
+    void increment() noexcept { this->add(T(1)); }
+
+    /**
+     * @brief Subtracts one from the slot of the calling thread.
+     */
+    void decrement() noexcept { this->sub(T(1)); }
+
+    /**
+     * @brief Returns the sum of all slots.
+     */
+    [[nodiscard]] T value() const noexcept {
+      auto sum = T(0);
+      for(auto i = usize(0); i <= this->mask_; ++i)
+        sum += this->slots_[i]->load(std::memory_order_relaxed);
+      return sum;
+    }
+
+    /**
+     * @brief Resets all slots to zero and returns the sum of their previous values.
+     * @details Every increment is accounted for exactly once: either in the returned value or in
+     * the value after reset.
+     */
+    T exchange_zero() noexcept {
+      auto sum = T(0);
+      for(auto i = usize(0); i <= this->mask_; ++i)
+        sum += this->slots_[i]->exchange(T(0), std::memory_order_relaxed);
+      return sum;
+    }
+
+    /**
+     * @brief Returns number of slots.
+     */
+    [[nodiscard]] usize slots() const noexcept { return this->mask_ + 1; }
+
+   private:
+    [[nodiscard]] static usize default_slot_count() noexcept {
+      return std::max(std::thread::hardware_concurrency(), 1U);
+    }
+
+    [[nodiscard]] cache_padded<std::atomic<T>>& slot() noexcept {
+      return this->slots_[detail::this_thread_slot() & this->mask_];
+    }
+
+    usize mask_;
+    std::unique_ptr<cache_padded<std::atomic<T>>[]> slots_; // NOLINT(*-avoid-c-arrays)
+  };
+
+  /**
+   * @brief Monotonic sharded counter of events or amounts.
+   * @see basic_sharded_counter
+   */
+  using sharded_counter = basic_sharded_counter<u64>;
+
+  /**
+   * @brief Sharded gauge: a value that goes up and down, e.g. number of requests in flight.
+   * @see basic_sharded_counter
+   */
+  using sharded_gauge = basic_sharded_counter<i64>;
+} // namespace fl
\ No newline at end of file
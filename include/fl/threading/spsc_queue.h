@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include "../contracts.h"
+#include "../memory/cache_padded.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  /**
+   * @brief Bounded lock-free single-producer single-consumer queue.
+   * @details Ring buffer of power-of-two capacity. Producer and consumer indices live on separate
+   * cache lines, and each side keeps a private cached copy of the other side's index, so in the
+   * steady state a push or pop touches no cache line written by the other thread except the slot
+   * itself. Batch operations publish the whole batch with a single store.
+   *
+   * At most one thread may push and at most one thread may pop at any given time.
+   * All operations are wait-free. For blocking operations see @ref blocking_queue.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto queue = fl::spsc_queue<int>(1024);
+   *    auto producer = std::jthread([&] {
+   *      for(auto i = 0; i < 100; ++i)
+   *        while(not queue.try_push(i))
+   *          std::this_thread::yield();
+   *    });
+   *    for(auto received = 0; received < 100;)
+   *      if(auto const v = queue.try_pop())
+   *        ++received;
+   * @endcode
+   * @tparam T Type of elements. Must be nothrow move constructible.
+   * @see mpmc_queue
+   * @see blocking_queue
+   */
+  template <typename T>
+  requires std::is_nothrow_move_constructible_v<T> and std::is_nothrow_destructible_v<T>
+  class spsc_queue : pin
+  {
+   public:
+    using value_type = T;
+
+    /**
+     * @brief Creates an empty queue.
+     * @param capacity Minimal capacity of the queue. Rounded up to a power of two. Must be positive.
+     */
+    explicit spsc_queue(usize capacity)
+      : mask_(std::bit_ceil(capacity) - 1)
+      , buffer_(std::make_unique<storage[]>(this->mask_ + 1)) // NOLINT(*-avoid-c-arrays)
+    {
+      if(capacity == 0)
+        contracts::broken_precondition("spsc_queue capacity must be positive");
+    }
+
+    ~spsc_queue() {
+      auto const tail = this->producer_->tail.load(std::memory_order_acquire);
+      for(auto head = this->consumer_->head.load(std::memory_order_relaxed); head != tail; ++head)
+        std::destroy_at(this->slot(head));
+    }
+
+    /**
+     * @brief Constructs an element at the back of the queue. Producer only.
+     * @param args Arguments to pass to the constructor of <code>T</code>.
+     * @return <code>true</code> if the element was pushed, <code>false</code> if the queue is full.
+     * @throws Any exception thrown by the constructor of <code>T</code>. The queue is left unchanged.
+     */
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+      auto& p = *this->producer_;
+      auto const tail = p.tail.load(std::memory_order_relaxed);
+      if(tail - p.cached_head > this->mask_) {
+        p.cached_head = this->consumer_->head.load(std::memory_order_acquire);
+        if(tail - p.cached_head > this->mask_)
+          return false;
+      }
+      std::construct_at(this->slot(tail), std::forward<Args>(args)...);
+      p.tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief Pushes an element to the back of the queue. Producer only.
+     * @param value Value to push.
+     * @return <code>true</code> if the element was pushed, <code>false</code> if the queue is full.
+     */
+    bool try_push(T const& value) { return this->try_emplace(value); }
+
+    /**
+     * @brief Pushes an element to the back of the queue. Producer only.
+     * @param value Value to push. Left intact if the queue is full.
+     * @return <code>true</code> if the element was pushed, <code>false</code> if the queue is full.
+     */
+    bool try_push(T&& value) noexcept { return this->try_emplace(std::move(value)); }
+
+    /**
+     * @brief Moves as many elements as fit from the front of the span to the back of the queue. Producer only.
+     * @param values Values to push. Pushed values are left in moved-from state.
+     * @return Number of pushed values, i.e. length of the pushed prefix of <code>values</code>.
+     */
+    usize try_push_n(std::span<T> values) noexcept {
+      auto& p = *this->producer_;
+      auto const tail = p.tail.load(std::memory_order_relaxed);
+      if(this->mask_ + 1 - (tail - p.cached_head) < values.size())
+        p.cached_head = this->consumer_->head.load(std::memory_order_acquire);
+      auto const count = std::min(values.size(), this->mask_ + 1 - (tail - p.cached_head));
+      for(auto i = usize(0); i < count; ++i)
+        std::construct_at(this->slot(tail + i), std::move(values[i]));
+      if(count != 0)
+        p.tail.store(tail + count, std::memory_order_release);
+      return count;
+    }
+
+    /**
+     * @brief Pops an element from the front of the queue. Consumer only.
+     * @return Popped element or <code>std::nullopt</code> if the queue is empty.
+     */
+    [[nodiscard]] std::optional<T> try_pop() noexcept {
+      auto& c = *this->consumer_;
+      auto const head = c.head.load(std::memory_order_relaxed);
+      if(head == c.cached_tail) {
+        c.cached_tail = this->producer_->tail.load(std::memory_order_acquire);
+        if(head == c.cached_tail)
+          return std::nullopt;
+      }
+      auto* const element = this->slot(head);
+      auto result = std::optional<T>(std::move(*element));
+      std::destroy_at(element);
+      c.head.store(head + 1, std::memory_order_release);
+      return result;
+    }
+
+    /**
+     * @brief Pops up to <code>max</code> elements from the front of the queue. Consumer only.
+     * @param out Output iterator to move popped elements to.
+     * @param max Maximal number of elements to pop.
+     * @return Number of popped elements.
+     */
+    template <std::output_iterator<T> O>
+    usize try_pop_n(O out, usize max) {
+      auto& c = *this->consumer_;
+      auto const head = c.head.load(std::memory_order_relaxed);
+      if(c.cached_tail - head < max)
+        c.cached_tail = this->producer_->tail.load(std::memory_order_acquire);
+      auto const count = std::min(max, c.cached_tail - head);
+      auto i = usize(0);
+      try {
+        for(; i < count; ++i) {
+          auto* const element = this->slot(head + i);
+          *out++ = std::move(*element);
+          std::destroy_at(element);
+        }
+      } catch(...) {
+        c.head.store(head + i, std::memory_order_release);
+        throw;
+      }
+      if(count != 0)
+        c.head.store(head + count, std::memory_order_release);
+      return count;
+    }
+
+    /**
+     * @brief Returns approximate number of elements in the queue.
+     * @details Exact if called by the producer or the consumer while the other side is idle.
+     */
+    [[nodiscard]] usize size() const noexcept {
+      auto const head = this->consumer_->head.load(std::memory_order_acquire);
+      auto const tail = this->producer_->tail.load(std::memory_order_acquire);
+      return std::min(tail - head, this->mask_ + 1);
+    }
+
+    /**
+     * @brief Returns <code>true</code> if the queue appears empty.
+     */
+    [[nodiscard]] bool empty() const noexcept { return this->size() == 0; }
+
+    /**
+     * @brief Returns the maximal number of elements the queue can hold.
+     */
+    [[nodiscard]] usize capacity() const noexcept { return this->mask_ + 1; }
+
+   private:
+    struct alignas(T) storage
+    {
+      std::byte bytes[sizeof(T)]; // NOLINT(*-avoid-c-arrays)
+    };
+
+    struct producer_side
+    {
+      std::atomic<usize> tail = 0;
+      usize cached_head = 0;
+    };
+
+    struct consumer_side
+    {
+      std::atomic<usize> head = 0;
+      usize cached_tail = 0;
+    };
+
+    [[nodiscard]] T* slot(usize index) const noexcept {
+      return reinterpret_cast<T*>(this->buffer_[index & this->mask_].bytes); // NOLINT(*-reinterpret-cast)
+    }
+
+    usize mask_;
+    std::unique_ptr<storage[]> buffer_; // NOLINT(*-avoid-c-arrays)
+    cache_padded<producer_side> producer_;
+    cache_padded<consumer_side> consumer_;
+  };
+} // namespace fl
\ No newline at end of file
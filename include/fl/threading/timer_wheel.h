@@ -0,0 +1,430 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+#include "../contracts.h"
+#include "../functional/inplace_function.h"
+#include "../traits/noncopyable.h"
+#include "../traits/pin.h"
+#include "../types/stdint.h"
+
+namespace fl
+{
+  /**
+   * @brief Handle of a scheduled timer.
+   * @details Handles are generation-checked: cancelling a timer that has already fired (or was
+   * already cancelled) is a harmless no-op, even if its storage was reused by another timer.
+   * @see timer_wheel
+   */
+  struct timer_id
+  {
+    u32 index = 0;      ///< Index of the timer node.
+    u32 generation = 0; ///< Generation of the timer node. Zero means invalid handle.
+
+    /**
+     * @brief Returns <code>true</code> if the handle refers to some timer.
+     */
+    [[nodiscard]] constexpr explicit operator bool() const noexcept { return this->generation != 0; }
+
+    [[nodiscard]] constexpr bool operator==(timer_id const&) const noexcept = default;
+  };
+
+  /**
+   * @brief Hierarchical timer wheel.
+   * @details Schedules callbacks to be invoked after a given number of ticks with O(1) insertion
+   * and cancellation. Time is advanced explicitly by calling @ref tick or @ref advance.
+   *
+   * The wheel consists of four levels with 256 slots each. Level 0 has one-tick resolution,
+   * every next level has 256 times coarser resolution. When a level wraps around, timers from
+   * the next slot of the coarser level are redistributed (cascaded) into finer levels. Timers
+   * further than 2<sup>32</sup> ticks in the future are kept in the last slot of the coarsest level
+   * and cascaded repeatedly until they are in range.
+   *
+   * Timer nodes and their callbacks are stored in a single pool with intrusive links, so
+   * scheduling a timer does not allocate unless the pool has to grow (see @ref reserve).
+   * Callbacks must fit into @ref callback_type, i.e. into <code>CallbackCapacity</code> bytes.
+   *
+   * This class is not thread-safe. See @ref concurrent_timer_wheel for a thread-safe front-end.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto wheel = fl::timer_wheel<>();
+   *    auto const id = wheel.schedule(10, [] { std::cout << "fired\n"; });
+   *    wheel.advance(9);  // nothing happens
+   *    wheel.tick();      // prints "fired"
+   * @endcode
+   * @tparam CallbackCapacity Size of inline storage for each callback in bytes.
+   * @sa http://www.cs.columbia.edu/~nahum/w6998/papers/sosp87-timing-wheels.pdf
+   */
+  template <usize CallbackCapacity = 48>
+  class timer_wheel : noncopyable // NOLINT(*-special-member-functions)
+  {
+    static constexpr usize levels = 4;
+    static constexpr usize slot_bits = 8;
+    static constexpr usize slots = usize(1) << slot_bits;
+    static constexpr u64 slot_mask = slots - 1;
+    static constexpr u64 max_range = u64(1) << (slot_bits * levels);
+    static constexpr u32 sentinels = levels * slots + 1;
+    static constexpr u32 expiring = levels * slots;
+    static constexpr u32 npos = ~u32(0);
+
+   public:
+    /**
+     * @brief Type of the stored callbacks.
+     */
+    using callback_type = inplace_function<void(), CallbackCapacity>;
+
+    /**
+     * @brief Creates an empty wheel at tick zero.
+     * @param capacity Number of timers to preallocate storage for.
+     */
+    explicit timer_wheel(usize capacity = 0) {
+      this->nodes_.resize(sentinels);
+      for(auto i = u32(0); i < sentinels; ++i) {
+        this->nodes_[i].prev = i;
+        this->nodes_[i].next = i;
+      }
+      this->reserve(capacity);
+    }
+
+    timer_wheel(timer_wheel&&) noexcept = default;
+    timer_wheel& operator=(timer_wheel&&) noexcept = default;
+    ~timer_wheel() = default;
+
+    /**
+     * @brief Preallocates storage for the given number of timers.
+     * @param capacity Number of timers.
+     */
+    void reserve(usize capacity) {
+      this->nodes_.reserve(sentinels + capacity);
+    }
+
+    /**
+     * @brief Schedules a callback to be invoked after the given number of ticks.
+     * @details Delay of zero is treated as one tick: callback is invoked on the next tick.
+     * @param delay Delay in ticks.
+     * @param callback Callback to invoke.
+     * @return Handle of the scheduled timer.
+     */
+    timer_id schedule(u64 delay, callback_type callback) {
+      auto const index = this->allocate();
+      auto& n = this->nodes_[index];
+      n.expiry = this->now_ + std::max(delay, u64(1));
+      n.callback = std::move(callback);
+      this->place(index);
+      ++this->size_;
+      return { .index = index, .generation = n.generation };
+    }
+
+    /**
+     * @brief Cancels the timer.
+     * @param id Timer handle.
+     * @return <code>true</code> if the timer was pending and is now cancelled, <code>false</code> if it
+     * has already fired or was cancelled before.
+     */
+    bool cancel(timer_id id) noexcept {
+      if(not this->pending(id))
+        return false;
+      this->unlink(id.index);
+      this->release(id.index);
+      --this->size_;
+      return true;
+    }
+
+    /**
+     * @brief Returns <code>true</code> if the timer is scheduled and has not fired yet.
+     * @param id Timer handle.
+     */
+    [[nodiscard]] bool pending(timer_id id) const noexcept {
+      return id.index >= sentinels
+        and id.index < this->nodes_.size()
+        and this->nodes_[id.index].generation == id.generation
+        and this->nodes_[id.index].linked;
+    }
+
+    /**
+     * @brief Advances time by one tick, invoking callbacks of expired timers.
+     * @return Number of invoked callbacks.
+     */
+    usize tick() {
+      return this->tick([](callback_type&& callback) { callback(); });
+    }
+
+    /**
+     * @brief Advances time by one tick, passing callbacks of expired timers to the given sink.
+     * @details Useful for handing expired callbacks over to an executor instead of invoking them in place.
+     * Sink may schedule or cancel timers.
+     * @param sink Callable accepting <code>callback_type&&</code>.
+     * @return Number of expired timers.
+     */
+    template <typename Sink>
+    requires std::invocable<Sink&, callback_type&&>
+    usize tick(Sink&& sink) {
+      ++this->now_;
+      for(auto level = levels - 1; level > 0; --level)
+        if((this->now_ & ((u64(1) << (slot_bits * level)) - 1)) == 0)
+          this->cascade(level);
+      this->splice(this->slot(0, this->now_ & slot_mask), expiring);
+
+      auto count = usize(0);
+      while(this->nodes_[expiring].next != expiring) {
+        auto const index = this->nodes_[expiring].next;
+        this->unlink(index);
+        auto callback = std::move(this->nodes_[index].callback);
+        this->release(index);
+        --this->size_;
+        ++count;
+        sink(std::move(callback));
+      }
+      return count;
+    }
+
+    /**
+     * @brief Advances time by the given number of ticks, invoking callbacks of expired timers.
+     * @param ticks Number of ticks.
+     * @return Number of invoked callbacks.
+     */
+    usize advance(u64 ticks) {
+      auto count = usize(0);
+      for(auto i = u64(0); i < ticks; ++i)
+        count += this->tick();
+      return count;
+    }
+
+    /**
+     * @brief Returns current time in ticks.
+     */
+    [[nodiscard]] u64 now() const noexcept { return this->now_; }
+
+    /**
+     * @brief Returns number of pending timers.
+     */
+    [[nodiscard]] usize size() const noexcept { return this->size_; }
+
+    /**
+     * @brief Returns <code>true</code> if there are no pending timers.
+     */
+    [[nodiscard]] bool empty() const noexcept { return this->size_ == 0; }
+
+   private:
+    struct node
+    {
+      u32 prev = npos;
+      u32 next = npos;
+      u32 generation = 1;
+      bool linked = false;
+      u64 expiry = 0;
+      callback_type callback;
+    };
+
+    [[nodiscard]] static constexpr u32 slot(usize level, u64 index) noexcept {
+      return static_cast<u32>(level * slots + index);
+    }
+
+    u32 allocate() {
+      if(this->free_ != npos) {
+        auto const index = this->free_;
+        this->free_ = this->nodes_[index].next;
+        return index;
+      }
+      if(this->nodes_.size() >= npos)
+        throw std::length_error("too many timers");
+      this->nodes_.emplace_back();
+      return static_cast<u32>(this->nodes_.size() - 1);
+    }
+
+    void release(u32 index) noexcept {
+      auto& n = this->nodes_[index];
+      n.callback.reset();
+      if(++n.generation == 0)
+        n.generation = 1;
+      n.next = this->free_;
+      this->free_ = index;
+    }
+
+    void link(u32 head, u32 index) noexcept {
+      auto& n = this->nodes_[index];
+      n.prev = this->nodes_[head].prev;
+      n.next = head;
+      this->nodes_[n.prev].next = index;
+      this->nodes_[head].prev = index;
+      n.linked = true;
+    }
+
+    void unlink(u32 index) noexcept {
+      auto& n = this->nodes_[index];
+      this->nodes_[n.prev].next = n.next;
+      this->nodes_[n.next].prev = n.prev;
+      n.prev = npos;
+      n.next = npos;
+      n.linked = false;
+    }
+
+    void splice(u32 from, u32 to) noexcept {
+      while(this->nodes_[from].next != from) {
+        auto const index = this->nodes_[from].next;
+        this->unlink(index);
+        this->link(to, index);
+      }
+    }
+
+    void place(u32 index) noexcept {
+      auto const expiry = this->nodes_[index].expiry;
+      auto const delta = expiry - this->now_;
+      if(delta >= max_range) {
+        auto const top = levels - 1;
+        this->link(this->slot(top, ((this->now_ >> (slot_bits * top)) + slot_mask) & slot_mask), index);
+        return;
+      }
+      auto level = usize(0);
+      while(delta >= (u64(1) << (slot_bits * (level + 1))))
+        ++level;
+      this->link(this->slot(level, (expiry >> (slot_bits * level)) & slot_mask), index);
+    }
+
+    void cascade(usize level) noexcept {
+      auto const head = this->slot(level, (this->now_ >> (slot_bits * level)) & slot_mask);
+      while(this->nodes_[head].next != head) {
+        auto const index = this->nodes_[head].next;
+        this->unlink(index);
+        this->place(index);
+      }
+    }
+
+    std::vector<node> nodes_;
+    u32 free_ = npos;
+    u64 now_ = 0;
+    usize size_ = 0;
+  };
+
+  /**
+   * @brief Thread-safe timer wheel driven by a background thread.
+   * @details Wraps @ref timer_wheel with a mutex and ticks it every <code>resolution</code> from a
+   * dedicated thread. Expired callbacks are collected under the lock and handed to the executor
+   * after the lock is released, so callbacks are free to schedule or cancel timers.
+   *
+   * Executor is any callable accepting <code>callback_type&&</code>. By default, callbacks are
+   * invoked directly on the timer thread.
+   *
+   * Example usage:
+   *
+   * @code {.cpp}
+   *    auto pool = my_thread_pool();
+   *    auto timers = fl::concurrent_timer_wheel(
+   *      std::chrono::milliseconds(1),
+   *      [&pool](auto&& callback) { pool.post(std::move(callback)); }
+   *    );
+   *    auto const id = timers.schedule(std::chrono::seconds(5), [] { retry(); });
+   *    timers.cancel(id);
+   * @endcode
+   * @tparam CallbackCapacity Size of inline storage for each callback in bytes.
+   * @see timer_wheel
+   */
+  template <usize CallbackCapacity = 48>
+  class concurrent_timer_wheel : pin
+  {
+   public:
+    /**
+     * @brief Type of the stored callbacks.
+     */
+    using callback_type = typename timer_wheel<CallbackCapacity>::callback_type;
+
+    /**
+     * @brief Type of the executor.
+     */
+    using executor_type = inplace_function<void(callback_type&&), CallbackCapacity>;
+
+    /**
+     * @brief Starts the timer thread.
+     * @param resolution Duration of a single tick.
+     * @param executor Executor for expired callbacks.
+     */
+    explicit concurrent_timer_wheel(
+      std::chrono::nanoseconds resolution = std::chrono::milliseconds(1),
+      executor_type executor = [](callback_type&& callback) { callback(); }
+    )
+      : resolution_(resolution)
+      , executor_(std::move(executor))
+      , thread_([this](std::stop_token const& stop) { this->run(stop); })
+    {
+      if(resolution.count() <= 0)
+        contracts::broken_precondition("timer resolution must be positive");
+    }
+
+    /**
+     * @brief Stops the timer thread. Pending timers are discarded.
+     */
+    ~concurrent_timer_wheel() = default;
+
+    /**
+     * @brief Schedules a callback to be handed to the executor after the given delay.
+     * @details Delay is rounded up to the whole number of ticks. Negative delay is treated as zero.
+     * @param delay Delay.
+     * @param callback Callback.
+     * @return Handle of the scheduled timer.
+     */
+    timer_id schedule(std::chrono::nanoseconds delay, callback_type callback) {
+      delay = std::max(delay, std::chrono::nanoseconds(0));
+      // rounds up without adding to the delay, which overflows close to nanoseconds::max()
+      auto const ticks = static_cast<u64>(delay / this->resolution_) + (delay % this->resolution_ != std::chrono::nanoseconds(0) ? 1 : 0);
+      auto const lock = std::scoped_lock(this->mutex_);
+      return this->wheel_.schedule(ticks, std::move(callback));
+    }
+
+    /**
+     * @brief Cancels the timer.
+     * @param id Timer handle.
+     * @return <code>true</code> if the timer was pending and is now cancelled.
+     * @note Callback that has already been handed to the executor can not be cancelled.
+     */
+    bool cancel(timer_id id) {
+      auto const lock = std::scoped_lock(this->mutex_);
+      return this->wheel_.cancel(id);
+    }
+
+    /**
+     * @brief Returns number of pending timers.
+     */
+    [[nodiscard]] usize size() const {
+      auto const lock = std::scoped_lock(this->mutex_);
+      return this->wheel_.size();
+    }
+
+   private:
+    void run(std::stop_token const& stop) { // NOLINT(*-function-cognitive-complexity)
+      auto expired = std::vector<callback_type>();
+      auto next = std::chrono::steady_clock::now() + this->resolution_;
+      while(not stop.stop_requested()) {
+        {
+          auto lock = std::unique_lock(this->mutex_);
+          if(this->wakeup_.wait_until(lock, stop, next, [] { return false; }) or stop.stop_requested())
+            return;
+          // catch up with missed ticks, if the thread was descheduled
+          auto const now = std::chrono::steady_clock::now();
+          while(next <= now) {
+            this->wheel_.tick([&expired](callback_type&& callback) { expired.push_back(std::move(callback)); });
+            next += this->resolution_;
+          }
+        }
+        for(auto& callback : expired)
+          this->executor_(std::move(callback));
+        expired.clear();
+      }
+    }
+
+    std::chrono::nanoseconds resolution_;
+    executor_type executor_;
+    mutable std::mutex mutex_;
+    std::condition_variable_any wakeup_;
+    timer_wheel<CallbackCapacity> wheel_;
+    std::jthread thread_;
+  };
+} // namespace fl
\ No newline at end of file
@@ -1,44 +1,375 @@
 #include <fl/contracts.h>
 
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <mutex>
 #include <utility>
-#include "extern/termcolor.hh"
+#include <fl/platform/stacktrace.h>
+#include <fl/types/stdint.h>
+
+#if defined(FL_OS_WINDOWS)
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
 
 namespace
 {
   using namespace fl::contracts;
-  contract_violation_handler global_violation_handler = default_contract_violation_handler; // NOLINT(*-avoid-non-const-global-variables)
+
+  struct handler_node
+  {
+    contract_violation_handler handler;
+    handler_node* next_retired = nullptr;
+  };
+
+  /**
+   * Global handler, published through an atomic pointer. Null means the default handler.
+   *
+   * Reporting threads announce themselves in <tt>readers</tt> before loading the pointer. A replaced
+   * node is retired and freed by a later writer which observes no readers after its own exchange:
+   * every reader that started after that point sees only the newer node.
+   */
+  struct handler_registry
+  {
+    std::atomic<handler_node*> current = nullptr;
+    std::atomic<fl::usize> readers = 0;
+    std::mutex writer;
+    handler_node* retired = nullptr; // guarded by writer
+  };
+
+  constinit handler_registry registry; // NOLINT(*-avoid-non-const-global-variables)
+
+  class reader
+  {
+   public:
+    reader() noexcept { ::registry.readers.fetch_add(1, std::memory_order_seq_cst); }
+    ~reader() { ::registry.readers.fetch_sub(1, std::memory_order_release); }
+    reader(reader const&) = delete;
+    reader(reader&&) = delete;
+    auto operator=(reader const&) -> reader& = delete;
+    auto operator=(reader&&) -> reader& = delete;
+
+    [[nodiscard]] auto current() const noexcept -> handler_node* {
+      return ::registry.current.load(std::memory_order_seq_cst);
+    }
+  };
+
+  auto stderr_is_terminal() noexcept -> bool {
+    #if defined(FL_OS_WINDOWS)
+    return ::_isatty(2) != 0;
+    #else
+    return ::isatty(STDERR_FILENO) == 1;
+    #endif
+  }
+
+  /**
+   * Async-signal-safe buffered writer to the standard error stream. Output is assembled in a stack
+   * buffer and written with <tt>write(2)</tt> when the buffer is full and on destruction.
+   */
+  class stderr_writer
+  {
+   public:
+    stderr_writer() = default;
+    ~stderr_writer() { this->flush(); }
+    stderr_writer(stderr_writer const&) = delete;
+    stderr_writer(stderr_writer&&) = delete;
+    auto operator=(stderr_writer const&) -> stderr_writer& = delete;
+    auto operator=(stderr_writer&&) -> stderr_writer& = delete;
+
+    auto operator<<(std::string_view text) noexcept -> stderr_writer& {
+      while(not text.empty()) {
+        if(this->size_ == this->buffer_.size())
+          this->flush();
+        auto const count = std::min(text.size(), this->buffer_.size() - this->size_);
+        std::memcpy(this->buffer_.data() + this->size_, text.data(), count);
+        this->size_ += count;
+        text.remove_prefix(count);
+      }
+      return *this;
+    }
+
+    auto operator<<(char const* text) noexcept -> stderr_writer& {
+      return *this << std::string_view(text);
+    }
+
+    auto operator<<(fl::u64 value) noexcept -> stderr_writer& {
+      auto digits = std::array<char, 20>();
+      auto const [end, _] = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+      return *this << std::string_view(digits.data(), end);
+    }
+
+    auto hex(fl::uptr value) noexcept -> stderr_writer& {
+      constexpr auto digits = std::string_view("0123456789abcdef");
+      auto text = std::array<char, 2 + 2 * sizeof(fl::uptr)>();
+      text[0] = '0';
+      text[1] = 'x';
+      for(auto i = text.size(); i > 2; --i, value >>= 4)
+        text[i - 1] = digits[value & 0xF];
+      return *this << std::string_view(text.data(), text.size());
+    }
+
+    auto flush() noexcept -> void {
+      auto const* data = this->buffer_.data();
+      auto remaining = this->size_;
+      while(remaining > 0) {
+        #if defined(FL_OS_WINDOWS)
+        auto const written = ::_write(2, data, static_cast<unsigned>(remaining));
+        #else
+        auto const written = ::write(STDERR_FILENO, data, remaining);
+        #endif
+        if(written < 0 and errno == EINTR)
+          continue;
+        if(written <= 0)
+          break;
+        data += written;
+        remaining -= static_cast<fl::usize>(written);
+      }
+      this->size_ = 0;
+    }
+
+   private:
+    std::array<char, 512> buffer_ {};
+    fl::usize size_ = 0;
+  };
+
+  auto type_name(contract_type type) noexcept -> std::string_view {
+    switch(type) {
+      case contract_type::precondition: return "precondition";
+      case contract_type::postcondition: return "postcondition";
+      case contract_type::invariant: return "invariant";
+      default: return "unknown";
+    }
+  }
+
+  /**
+   * Call site of observed violations. The slot is claimed by a CAS on <tt>key</tt>; the claiming
+   * thread fills in the location and publishes it with <tt>ready</tt>.
+   */
+  struct observed_site
+  {
+    std::atomic<fl::u64> key = 0;
+    std::atomic<fl::u64> count = 0;
+    std::atomic<bool> ready = false;
+    contract_type type = contract_type::invariant;
+    std::source_location location;
+  };
+
+  struct observed_sample
+  {
+    std::atomic<bool> ready = false;
+    contract_type type = contract_type::invariant;
+    std::source_location location;
+    fl::usize size = 0;
+    std::array<char, 256> message {};
+  };
+
+  /**
+   * Statically allocated open-addressing table of observed sites and the first few messages.
+   */
+  struct observed_table
+  {
+    static constexpr auto site_count = fl::usize(1'024);
+    static constexpr auto sample_count = fl::usize(16);
+
+    std::array<observed_site, site_count> sites;
+    std::array<observed_sample, sample_count> samples;
+    std::atomic<fl::usize> next_sample = 0;
+    std::atomic<fl::u64> untracked = 0;
+    std::atomic<bool> dump_registered = false;
+  };
+
+  constinit observed_table observed; // NOLINT(*-avoid-non-const-global-variables)
+
+  /**
+   * Last enforced violation. The flag serializes writers without blocking: a violation reported
+   * while another is being recorded is skipped.
+   */
+  struct last_violation_slot
+  {
+    std::atomic_flag writing;
+    std::atomic<bool> ready = false;
+    fl::contracts::violation_record record;
+  };
+
+  constinit last_violation_slot last; // NOLINT(*-avoid-non-const-global-variables)
+  constinit std::atomic<fl::u32> sampling_rate = fl::contracts::default_sampling_rate; // NOLINT(*-avoid-non-const-global-variables)
+
+  auto site_key(contract_type type, std::source_location const& location) noexcept -> fl::u64 {
+    // FNV-1a: the same site may be reported from different translation units, which do not share
+    // the file name string
+    auto hash = fl::u64(14'695'981'039'346'656'037ULL);
+    auto const mix = [&hash](fl::u64 value) {
+      hash ^= value;
+      hash *= 1'099'511'628'211ULL;
+    };
+    for(auto const* c = location.file_name(); *c != '\0'; ++c)
+      mix(static_cast<unsigned char>(*c));
+    mix(location.line());
+    mix(location.column());
+    mix(static_cast<fl::u64>(type));
+    return hash == 0 ? 1 : hash;
+  }
+
+  auto find_site(contract_type type, std::source_location const& location) noexcept -> observed_site* {
+    auto const key = ::site_key(type, location);
+    for(auto i = fl::usize(0); i < observed_table::site_count; ++i) {
+      auto& site = ::observed.sites[(key + i) % observed_table::site_count];
+      auto current = site.key.load(std::memory_order_acquire);
+      if(current == 0 and site.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+        site.type = type;
+        site.location = location;
+        site.ready.store(true, std::memory_order_release);
+        return &site;
+      }
+      if(current == key)
+        return &site;
+    }
+    return nullptr;
+  }
+
+  auto record_sample(contract_type type, std::string_view message, std::source_location const& location) noexcept -> void {
+    if(::observed.next_sample.load(std::memory_order_relaxed) >= observed_table::sample_count)
+      return;
+    auto const index = ::observed.next_sample.fetch_add(1, std::memory_order_relaxed);
+    if(index >= observed_table::sample_count)
+      return;
+    auto& sample = ::observed.samples[index];
+    sample.type = type;
+    sample.location = location;
+    sample.size = std::min(message.size(), sample.message.size());
+    std::memcpy(sample.message.data(), message.data(), sample.size);
+    sample.ready.store(true, std::memory_order_release);
+  }
+
+  auto copy_truncated(std::string_view text, std::span<char> out) noexcept -> void {
+    auto const size = std::min(text.size(), out.size() - 1);
+    std::memcpy(out.data(), text.data(), size);
+    out[size] = '\0';
+  }
+
+  auto record_last_violation(contract_type type, std::string_view message, std::source_location const& location) noexcept -> void {
+    if(::last.writing.test_and_set(std::memory_order_acquire))
+      return;
+    ::last.ready.store(false, std::memory_order_relaxed);
+    auto& record = ::last.record;
+    record.type = type;
+    record.line = location.line();
+    record.column = location.column();
+    ::copy_truncated(location.file_name(), record.file);
+    ::copy_truncated(location.function_name(), record.function);
+    ::copy_truncated(message, record.message);
+    ::last.ready.store(true, std::memory_order_release);
+    ::last.writing.clear(std::memory_order_release);
+  }
+
+  auto dump_at_exit() -> void {
+    fl::contracts::dump_observed_violations();
+  }
+
+  auto free_retired() -> void {
+    while(auto* const node = ::registry.retired) {
+      ::registry.retired = node->next_retired;
+      delete node; // NOLINT(*-owning-memory)
+    }
+  }
 } // namespace
 
 namespace fl::contracts
 {
   void default_contract_violation_handler(const contract_violation& violation) {
-    auto type = [&violation]() -> std::string_view {
-      switch(violation.type) {
-        case contract_type::precondition: return "precondition";
-        case contract_type::postcondition: return "postcondition";
-        case contract_type::invariant: return "invariant";
-        default: return "unknown";
+    auto const color = ::stderr_is_terminal();
+    {
+      auto out = ::stderr_writer();
+      out << (color ? "\033[1;31m" : "") << "Contract violation (" << ::type_name(violation.type) << "):\n" << (color ? "\033[22m" : "");
+      out << "  " << violation.message << "\n";
+      out << "  in function '" << std::string_view(violation.location.function_name()) << "'\n";
+      out << "  in file '" << std::string_view(violation.location.file_name()) << "'\n";
+      out << "  at line " << violation.location.line() << ":" << violation.location.column() << "\n";
+      if(not violation.frames.empty()) {
+        out << "  raw stack trace:";
+        for(auto const frame : violation.frames)
+          (out << " ").hex(frame);
+        out << "\n";
       }
-    };
-    std::cerr << termcolor::red << termcolor::bold << std::format("Contract violation ({}):\n", type()) << termcolor::reset << termcolor::red;
-    std::cerr << std::format("  {}\n", violation.message);
-    std::cerr << std::format("  in function \'{}\'\n", violation.location.function_name());
-    std::cerr << std::format("  in file \'{}\'\n", violation.location.file_name());
-    std::cerr << std::format("  at line {}:{}\n", violation.location.line(), violation.location.column());
-    std::cerr << termcolor::reset;
-    std::flush(std::cerr);
-    std::terminate();
+      out << (color ? "\033[0m" : "");
+    }
+    std::abort();
   }
 
-  contract_violation_handler& violation_handler() {
-    return ::global_violation_handler;
+  contract_violation_handler violation_handler() {
+    auto const r = ::reader();
+    if(auto const* const node = r.current())
+      return node->handler;
+    return default_contract_violation_handler;
   }
 
   contract_violation_handler set_violation_handler(contract_violation_handler handler) {
-    auto old = ::global_violation_handler;
-    ::global_violation_handler = std::move(handler);
-    return old;
+    auto const lock = std::lock_guard(::registry.writer);
+    auto* const node = handler ? new ::handler_node { .handler = std::move(handler) } : nullptr; // NOLINT(*-owning-memory)
+    auto* const old = ::registry.current.exchange(node, std::memory_order_seq_cst);
+    auto result = old ? old->handler : contract_violation_handler(default_contract_violation_handler);
+    if(old) {
+      old->next_retired = ::registry.retired;
+      ::registry.retired = old;
+    }
+    if(::registry.readers.load(std::memory_order_seq_cst) == 0)
+      ::free_retired();
+    return result;
+  }
+
+  violation_statistics observed_violations() {
+    auto result = violation_statistics();
+    for(auto const& site : ::observed.sites)
+      if(site.ready.load(std::memory_order_acquire))
+        result.sites.push_back({
+          .type = site.type,
+          .location = site.location,
+          .count = site.count.load(std::memory_order_relaxed)
+        });
+    std::ranges::stable_sort(result.sites, std::ranges::greater(), &observed_violation::count);
+    for(auto const& sample : ::observed.samples)
+      if(sample.ready.load(std::memory_order_acquire))
+        result.samples.push_back({
+          .type = sample.type,
+          .location = sample.location,
+          .message = std::string(sample.message.data(), sample.size)
+        });
+    result.untracked = ::observed.untracked.load(std::memory_order_relaxed);
+    return result;
+  }
+
+  void dump_observed_violations() {
+    auto out = ::stderr_writer();
+    out << "Observed contract violations:\n";
+    for(auto const& site : ::observed.sites)
+      if(site.ready.load(std::memory_order_acquire))
+        out << "  " << site.count.load(std::memory_order_relaxed) << " x " << ::type_name(site.type)
+            << " at " << std::string_view(site.location.file_name()) << ":" << site.location.line()
+            << ":" << site.location.column() << " in '" << std::string_view(site.location.function_name()) << "'\n";
+    if(auto const untracked = ::observed.untracked.load(std::memory_order_relaxed); untracked > 0)
+      out << "  " << untracked << " x untracked (site table is full)\n";
+    out << "First violations:\n";
+    for(auto const& sample : ::observed.samples)
+      if(sample.ready.load(std::memory_order_acquire))
+        out << "  " << ::type_name(sample.type) << ": " << std::string_view(sample.message.data(), sample.size)
+            << "\n    at " << std::string_view(sample.location.file_name()) << ":" << sample.location.line()
+            << ":" << sample.location.column() << "\n";
+  }
+
+  u32 sampling_rate() noexcept {
+    return ::sampling_rate.load(std::memory_order_relaxed);
+  }
+
+  void set_sampling_rate(u32 rate) noexcept {
+    ::sampling_rate.store(rate, std::memory_order_relaxed);
   }
 
   contract_violation detail::make_contract_violation(
@@ -48,7 +379,7 @@ namespace fl::contracts
   ) {
     return {
       .type = type,
-      .message = std::string(message),
+      .message = message,
       .location = location
     };
   }
@@ -58,6 +389,36 @@ namespace fl::contracts
     std::string_view message,
     std::source_location location
   ) {
-    ::violation_handler()(make_contract_violation(type, message, location));
+    ::record_last_violation(type, message, location);
+    auto violation = make_contract_violation(type, message, location);
+    auto const trace = platform::raw_stacktrace::capture();
+    violation.frames = trace.frames();
+    {
+      auto const r = ::reader();
+      if(auto const* const node = r.current())
+        node->handler(violation);
+      else
+        default_contract_violation_handler(violation);
+    }
+    // handlers must not return
+    std::terminate();
+  }
+
+  violation_record const* last_violation() noexcept {
+    return ::last.ready.load(std::memory_order_acquire) ? &::last.record : nullptr;
+  }
+
+  void detail::observe(
+    contract_type type,
+    std::string_view message,
+    std::source_location location
+  ) {
+    if(auto* const site = ::find_site(type, location))
+      site->count.fetch_add(1, std::memory_order_relaxed);
+    else
+      ::observed.untracked.fetch_add(1, std::memory_order_relaxed);
+    ::record_sample(type, message, location);
+    if(not ::observed.dump_registered.exchange(true, std::memory_order_relaxed))
+      std::atexit(::dump_at_exit);
   }
 } // namespace fl::contracts
\ No newline at end of file
@@ -0,0 +1,578 @@
+#include <fl/platform/crash.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <format>
+
+#if defined(FL_OS_LINUX)
+# include <csignal>
+# include <ctime>
+# include <fcntl.h>
+# include <sys/syscall.h>
+# include <ucontext.h>
+# include <unistd.h>
+#endif
+
+namespace
+{
+  using namespace fl;
+  using namespace fl::platform;
+
+  /*
+   * Report layout: a sequence of records, each a record_header followed by its payload. The first
+   * record is the report header, the last one is an end record; a report without it was cut short.
+   * Integers are stored in the byte order of the crashed host.
+   */
+  constexpr auto report_magic = std::array<char, 8> { 'F', 'L', 'C', 'R', 'A', 'S', 'H', '\0' };
+  constexpr auto report_version = u32(1);
+
+  enum class record_type : u32
+  {
+    header = 1,
+    registers = 2,
+    frames = 3,
+    module = 4,
+    violation = 5,
+    end = 6
+  };
+
+  struct record_header
+  {
+    record_type type = record_type::end;
+    u32 size = 0;
+  };
+
+  struct report_header
+  {
+    std::array<char, 8> magic = report_magic;
+    u32 version = report_version;
+    crash_architecture architecture = crash_architecture::unknown;
+    i32 signal = 0;
+    i32 code = 0;
+    u64 fault_address = 0;
+    u64 process = 0;
+    u64 thread = 0;
+    u64 time = 0;
+  };
+
+  /// Followed by <tt>path_size</tt> bytes of the module path.
+  struct module_record
+  {
+    u64 bias = 0;
+    u64 begin = 0;
+    u64 end = 0;
+    std::array<u8, build_id::max_size> id = {};
+    u32 id_size = 0;
+    u32 path_size = 0;
+  };
+
+  /// Followed by the file, function and message strings.
+  struct violation_header
+  {
+    u32 type = 0;
+    u32 line = 0;
+    u32 column = 0;
+    u32 file_size = 0;
+    u32 function_size = 0;
+    u32 message_size = 0;
+  };
+
+  constexpr auto x86_64_registers = std::array<std::string_view, 23> {
+    "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", "rdi", "rsi", "rbp", "rbx",
+    "rdx", "rax", "rcx", "rsp", "rip", "eflags", "csgsfs", "err", "trapno", "oldmask", "cr2"
+  };
+
+  constexpr auto aarch64_registers = std::array<std::string_view, 34> {
+    "x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11",
+    "x12", "x13", "x14", "x15", "x16", "x17", "x18", "x19", "x20", "x21", "x22", "x23",
+    "x24", "x25", "x26", "x27", "x28", "x29", "x30", "sp", "pc", "pstate"
+  };
+
+  auto signal_name(i32 signal) -> std::string_view {
+    #if defined(FL_OS_LINUX)
+    switch(signal) {
+      case SIGSEGV: return "SIGSEGV";
+      case SIGABRT: return "SIGABRT";
+      case SIGBUS: return "SIGBUS";
+      case SIGFPE: return "SIGFPE";
+      default: break;
+    }
+    #endif
+    return "unknown signal";
+  }
+
+  auto append_bytes(std::vector<std::byte>& out, void const* data, usize size) -> void {
+    auto const* const bytes = static_cast<std::byte const*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+  }
+
+  auto serialize_modules(module_map const& map) -> std::vector<std::byte> {
+    auto result = std::vector<std::byte>();
+    for(auto const& module : map.modules()) {
+      auto record = ::module_record {
+        .bias = module.bias,
+        .begin = module.begin,
+        .end = module.end,
+        .id = module.id.bytes,
+        .id_size = module.id.size,
+        .path_size = static_cast<u32>(module.path.size())
+      };
+      auto const header = ::record_header {
+        .type = record_type::module,
+        .size = static_cast<u32>(sizeof(record) + module.path.size())
+      };
+      ::append_bytes(result, &header, sizeof(header));
+      ::append_bytes(result, &record, sizeof(record));
+      ::append_bytes(result, module.path.data(), module.path.size());
+    }
+    return result;
+  }
+
+  /**
+   * Sequential reader over the bytes of a report. Reads past the end fail instead of throwing.
+   */
+  class byte_reader
+  {
+   public:
+    explicit byte_reader(std::span<std::byte const> data)
+      : data_(data)
+    {}
+
+    template <typename T>
+    [[nodiscard]] auto read(T& value) -> bool {
+      if(this->data_.size() < sizeof(T))
+        return false;
+      std::memcpy(&value, this->data_.data(), sizeof(T));
+      this->data_ = this->data_.subspan(sizeof(T));
+      return true;
+    }
+
+    [[nodiscard]] auto read_string(usize size, std::string& value) -> bool {
+      if(this->data_.size() < size)
+        return false;
+      value.assign(reinterpret_cast<char const*>(this->data_.data()), size); // NOLINT(*-reinterpret-cast)
+      this->data_ = this->data_.subspan(size);
+      return true;
+    }
+
+    [[nodiscard]] auto take(usize size) -> std::optional<std::span<std::byte const>> {
+      if(this->data_.size() < size)
+        return std::nullopt;
+      auto const result = this->data_.first(size);
+      this->data_ = this->data_.subspan(size);
+      return result;
+    }
+
+    [[nodiscard]] auto empty() const -> bool { return this->data_.empty(); }
+
+   private:
+    std::span<std::byte const> data_;
+  };
+
+  template <typename T>
+  auto read_array(std::span<std::byte const> payload, std::vector<T>& values) -> void {
+    values.resize(payload.size() / sizeof(T));
+    std::memcpy(values.data(), payload.data(), values.size() * sizeof(T));
+  }
+
+  #if defined(FL_OS_LINUX)
+  constexpr auto handled_signals = std::array { SIGSEGV, SIGABRT, SIGBUS, SIGFPE };
+
+  /// Longest report path, including the process ID and the terminating zero.
+  constexpr auto max_path_size = usize(4'096);
+
+  /**
+   * Everything the signal handler touches is allocated when the handler is installed. Module
+   * snapshots are immutable and never freed while the handler is installed, so the handler can use
+   * the current one without synchronization beyond the pointer.
+   */
+  struct handler_state
+  {
+    std::mutex mutex;
+    bool installed = false;
+    std::array<char, max_path_size> path_prefix = {};
+    usize path_prefix_size = 0;
+    std::array<struct sigaction, handled_signals.size()> previous = {};
+    std::deque<std::vector<std::byte>> module_snapshots;
+    std::atomic<std::vector<std::byte> const*> modules = nullptr;
+    std::unique_ptr<std::byte[]> alternate_stack;
+    usize alternate_stack_size = 0;
+    stack_t previous_stack = {};
+    std::atomic<bool> crashing = false;
+  };
+
+  auto state = handler_state(); // NOLINT(*-avoid-non-const-global-variables)
+
+  /**
+   * Writes to a file descriptor with plain system calls.
+   */
+  struct descriptor_writer
+  {
+    int descriptor = -1;
+
+    auto write(void const* data, usize size) const noexcept -> void {
+      auto const* bytes = static_cast<char const*>(data);
+      while(size > 0) {
+        auto const written = ::write(this->descriptor, bytes, size);
+        if(written < 0 and errno == EINTR)
+          continue;
+        if(written <= 0)
+          return;
+        bytes += written;
+        size -= static_cast<usize>(written);
+      }
+    }
+
+    auto write(std::string_view text) const noexcept -> void {
+      this->write(text.data(), text.size());
+    }
+
+    auto record(record_type type, void const* payload, usize size) const noexcept -> void {
+      auto const header = ::record_header { .type = type, .size = static_cast<u32>(size) };
+      this->write(&header, sizeof(header));
+      this->write(payload, size);
+    }
+  };
+
+  /// Formats a number into a buffer without allocating. Returns the number of digits.
+  auto format_decimal(u64 value, std::span<char> out) noexcept -> usize {
+    auto digits = std::array<char, 20>();
+    auto count = usize(0);
+    do {
+      digits[count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while(value != 0 and count < digits.size());
+    count = std::min(count, out.size());
+    for(auto i = usize(0); i < count; ++i)
+      out[i] = digits[count - 1 - i];
+    return count;
+  }
+
+  #if defined(__x86_64__)
+  constexpr auto current_architecture = crash_architecture::x86_64;
+  #elif defined(__aarch64__)
+  constexpr auto current_architecture = crash_architecture::aarch64;
+  #else
+  constexpr auto current_architecture = crash_architecture::unknown;
+  #endif
+
+  auto write_registers(descriptor_writer const& out, void const* context) noexcept -> void {
+    [[maybe_unused]] auto const& machine = static_cast<ucontext_t const*>(context)->uc_mcontext;
+    #if defined(__x86_64__)
+    auto registers = std::array<u64, ::x86_64_registers.size()>();
+    for(auto i = usize(0); i < registers.size(); ++i)
+      registers[i] = static_cast<u64>(machine.gregs[i]);
+    out.record(record_type::registers, registers.data(), sizeof(registers));
+    #elif defined(__aarch64__)
+    auto registers = std::array<u64, ::aarch64_registers.size()>();
+    std::copy_n(machine.regs, 31, registers.begin());
+    registers[31] = machine.sp;
+    registers[32] = machine.pc;
+    registers[33] = machine.pstate;
+    out.record(record_type::registers, registers.data(), sizeof(registers));
+    #else
+    static_cast<void>(out);
+    #endif
+  }
+
+  auto write_violation(descriptor_writer const& out) noexcept -> void {
+    auto const* const violation = contracts::last_violation();
+    if(violation == nullptr)
+      return;
+    auto const header = ::violation_header {
+      .type = static_cast<u32>(violation->type),
+      .line = violation->line,
+      .column = violation->column,
+      .file_size = static_cast<u32>(std::strlen(violation->file.data())),
+      .function_size = static_cast<u32>(std::strlen(violation->function.data())),
+      .message_size = static_cast<u32>(std::strlen(violation->message.data()))
+    };
+    auto const record = ::record_header {
+      .type = record_type::violation,
+      .size = static_cast<u32>(sizeof(header) + header.file_size + header.function_size + header.message_size)
+    };
+    out.write(&record, sizeof(record));
+    out.write(&header, sizeof(header));
+    out.write(violation->file.data(), header.file_size);
+    out.write(violation->function.data(), header.function_size);
+    out.write(violation->message.data(), header.message_size);
+  }
+
+  auto write_report(int signal, siginfo_t const* info, void const* context) noexcept -> void {
+    auto path = std::array<char, max_path_size>();
+    auto size = ::state.path_prefix_size;
+    std::copy_n(::state.path_prefix.begin(), size, path.begin());
+    constexpr auto extension = std::string_view(".flcrash");
+    size += ::format_decimal(static_cast<u64>(::getpid()), std::span(path).subspan(size, 20));
+    std::ranges::copy(extension, path.begin() + static_cast<isize>(size));
+    size += extension.size();
+    path[size] = '\0';
+
+    auto const descriptor = ::open(path.data(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    auto const error = ::descriptor_writer { .descriptor = STDERR_FILENO };
+    if(descriptor < 0) {
+      error.write("fatal signal, failed to write crash report\n");
+      return;
+    }
+    auto const out = ::descriptor_writer { .descriptor = descriptor };
+
+    auto now = timespec();
+    ::clock_gettime(CLOCK_REALTIME, &now);
+    auto const header = ::report_header {
+      .architecture = ::current_architecture,
+      .signal = signal,
+      .code = info->si_code,
+      .fault_address = reinterpret_cast<uptr>(info->si_addr), // NOLINT(*-reinterpret-cast)
+      .process = static_cast<u64>(::getpid()),
+      .thread = static_cast<u64>(::syscall(SYS_gettid)),
+      .time = static_cast<u64>(now.tv_sec) * 1'000'000'000ULL + static_cast<u64>(now.tv_nsec)
+    };
+    out.record(record_type::header, &header, sizeof(header));
+    ::write_registers(out, context);
+    auto const trace = raw_stacktrace::capture_from_signal(context);
+    out.record(record_type::frames, trace.frames().data(), trace.size() * sizeof(uptr));
+    if(auto const* const modules = ::state.modules.load(std::memory_order_acquire))
+      out.write(modules->data(), modules->size());
+    ::write_violation(out);
+    out.record(record_type::end, nullptr, 0);
+    ::close(descriptor);
+
+    error.write("fatal ");
+    error.write(::signal_name(signal));
+    error.write(", crash report written to ");
+    error.write(path.data(), size);
+    error.write("\n");
+  }
+
+  auto restore_previous_handlers() noexcept -> void {
+    for(auto i = usize(0); i < ::handled_signals.size(); ++i)
+      ::sigaction(::handled_signals[i], &::state.previous[i], nullptr);
+  }
+
+  void on_crash(int signal, siginfo_t* info, void* context) {
+    if(::state.crashing.exchange(true)) {
+      // another thread is writing its report and will terminate the process
+      for(;;)
+        ::pause();
+    }
+    ::write_report(signal, info, context);
+    ::restore_previous_handlers();
+    // faults repeat when the faulting instruction is executed again; signals sent by a process
+    // (including abort) have to be raised again
+    if(info->si_code <= 0)
+      ::raise(signal);
+  }
+
+  auto capture_modules() -> void {
+    auto& snapshot = ::state.module_snapshots.emplace_back(::serialize_modules(module_map::capture()));
+    ::state.modules.store(&snapshot, std::memory_order_release);
+  }
+  #endif // FL_OS_LINUX
+} // namespace
+
+namespace fl::platform
+{
+  std::optional<crash_report> crash_report::parse(std::span<std::byte const> data) {
+    auto reader = ::byte_reader(data);
+    auto record = ::record_header();
+    auto header = ::report_header();
+    if(not reader.read(record) or record.type != record_type::header or record.size < sizeof(header))
+      return std::nullopt;
+    auto header_payload = reader.take(record.size);
+    if(not header_payload)
+      return std::nullopt;
+    std::memcpy(&header, header_payload->data(), sizeof(header));
+    if(header.magic != ::report_magic or header.version != ::report_version)
+      return std::nullopt;
+
+    auto report = crash_report {
+      .signal = header.signal,
+      .code = header.code,
+      .fault_address = static_cast<uptr>(header.fault_address),
+      .process = header.process,
+      .thread = header.thread,
+      .time = header.time,
+      .architecture = header.architecture
+    };
+    while(not reader.empty()) {
+      if(not reader.read(record))
+        return std::nullopt;
+      auto const payload = reader.take(record.size);
+      if(not payload)
+        return std::nullopt;
+      auto content = ::byte_reader(*payload);
+      switch(record.type) {
+        case record_type::registers: ::read_array(*payload, report.registers); break;
+        case record_type::frames: ::read_array(*payload, report.frames); break;
+        case record_type::module: {
+          auto module = ::module_record();
+          auto info = module_info();
+          if(not content.read(module) or module.id_size > build_id::max_size or not content.read_string(module.path_size, info.path))
+            return std::nullopt;
+          info.bias = static_cast<uptr>(module.bias);
+          info.begin = static_cast<uptr>(module.begin);
+          info.end = static_cast<uptr>(module.end);
+          info.id = { .bytes = module.id, .size = static_cast<u8>(module.id_size) };
+          report.modules.push_back(std::move(info));
+          break;
+        }
+        case record_type::violation: {
+          auto violation_data = ::violation_header();
+          auto violation = crash_violation();
+          if(not content.read(violation_data)
+            or not content.read_string(violation_data.file_size, violation.file)
+            or not content.read_string(violation_data.function_size, violation.function)
+            or not content.read_string(violation_data.message_size, violation.message))
+            return std::nullopt;
+          violation.type = static_cast<contracts::contract_type>(violation_data.type);
+          violation.line = violation_data.line;
+          violation.column = violation_data.column;
+          report.violation = std::move(violation);
+          break;
+        }
+        case record_type::end: return report;
+        default: break;
+      }
+    }
+    // no end record: the handler did not finish, but everything written so far is usable
+    return report;
+  }
+
+  std::span<std::string_view const> crash_report::register_names(crash_architecture architecture) noexcept {
+    switch(architecture) {
+      case crash_architecture::x86_64: return ::x86_64_registers;
+      case crash_architecture::aarch64: return ::aarch64_registers;
+      default: return {};
+    }
+  }
+
+  void install_crash_handler(crash_handler_options const& options) {
+    #if defined(FL_OS_LINUX)
+    auto const lock = std::lock_guard(::state.mutex);
+    auto const prefix = options.directory + "/crash-";
+    if(prefix.size() + 32 > ::max_path_size)
+      throw std::runtime_error("crash report directory path is too long");
+    std::ranges::copy(prefix, ::state.path_prefix.begin());
+    ::state.path_prefix_size = prefix.size();
+    ::capture_modules();
+    if(::state.installed)
+      return;
+
+    if(options.alternate_stack_size > 0) {
+      // a stack kept by a previous installation may still be the signal stack of another thread
+      if(::state.alternate_stack_size < options.alternate_stack_size) {
+        static_cast<void>(::state.alternate_stack.release()); // NOLINT(*-unused-return-value)
+        ::state.alternate_stack = std::make_unique<std::byte[]>(options.alternate_stack_size);
+        ::state.alternate_stack_size = options.alternate_stack_size;
+      }
+      auto stack = stack_t {
+        .ss_sp = ::state.alternate_stack.get(),
+        .ss_flags = 0,
+        .ss_size = ::state.alternate_stack_size
+      };
+      if(::sigaltstack(&stack, &::state.previous_stack) != 0)
+        throw std::runtime_error("failed to install crash signal stack");
+    }
+    struct sigaction action = {};
+    action.sa_sigaction = ::on_crash;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    for(auto const signal : ::handled_signals)
+      sigaddset(&action.sa_mask, signal);
+    for(auto i = usize(0); i < ::handled_signals.size(); ++i)
+      if(::sigaction(::handled_signals[i], &action, &::state.previous[i]) != 0) {
+        while(i-- > 0)
+          ::sigaction(::handled_signals[i], &::state.previous[i], nullptr);
+        throw std::runtime_error("failed to install crash handler");
+      }
+    ::state.installed = true;
+    #else
+    static_cast<void>(options);
+    throw std::runtime_error("crash handler is not supported on this platform");
+    #endif
+  }
+
+  void uninstall_crash_handler() noexcept {
+    #if defined(FL_OS_LINUX)
+    auto const lock = std::lock_guard(::state.mutex);
+    if(not ::state.installed)
+      return;
+    ::restore_previous_handlers();
+    // the signal stack can be restored only on the installing thread; otherwise it is kept
+    if(auto current = stack_t(); ::state.alternate_stack and ::sigaltstack(nullptr, &current) == 0
+      and current.ss_sp == ::state.alternate_stack.get()) {
+      ::sigaltstack(&::state.previous_stack, nullptr);
+      ::state.alternate_stack.reset();
+      ::state.alternate_stack_size = 0;
+    }
+    ::state.modules.store(nullptr, std::memory_order_release);
+    ::state.module_snapshots.clear();
+    ::state.installed = false;
+    #endif
+  }
+
+  void refresh_crash_modules() {
+    #if defined(FL_OS_LINUX)
+    auto const lock = std::lock_guard(::state.mutex);
+    if(::state.installed)
+      ::capture_modules();
+    #endif
+  }
+
+  std::string to_string(crash_report const& report, stacktrace const& trace) {
+    auto result = std::format(
+      "fatal {} (signal {}, code {}) at address {:#x}\nprocess {}, thread {}, time {}.{:09}\n",
+      ::signal_name(report.signal),
+      report.signal,
+      report.code,
+      report.fault_address,
+      report.process,
+      report.thread,
+      report.time / 1'000'000'000ULL,
+      report.time % 1'000'000'000ULL
+    );
+    if(report.violation) {
+      auto const& violation = *report.violation;
+      auto const type = violation.type == contracts::contract_type::precondition ? "precondition"
+        : violation.type == contracts::contract_type::postcondition ? "postcondition"
+        : "invariant";
+      result += std::format(
+        "\nlast contract violation ({}): {}\n  in function {}\n  at {}:{}:{}\n",
+        type,
+        violation.message,
+        violation.function,
+        violation.file,
+        violation.line,
+        violation.column
+      );
+    }
+    auto const names = crash_report::register_names(report.architecture);
+    if(not report.registers.empty())
+      result += "\nregisters:\n";
+    for(auto i = usize(0); i < report.registers.size(); ++i)
+      result += std::format("  {:<8} {:#018x}\n", i < names.size() ? names[i] : "?", report.registers[i]);
+    result += "\nstack trace:\n";
+    if(trace.empty())
+      for(auto i = usize(0); i < report.frames.size(); ++i)
+        result += std::format("#{:<2} {:#018x}\n", i, report.frames[i]);
+    else
+      result += to_string(trace);
+    result += "\nmodules:\n";
+    for(auto const& module : report.modules)
+      result += std::format(
+        "  {:#018x}-{:#018x} {} {}\n",
+        module.begin,
+        module.end,
+        module.id.empty() ? "-" : module.id.to_string(),
+        module.path
+      );
+    return result;
+  }
+} // namespace fl::platform
\ No newline at end of file
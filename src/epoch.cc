@@ -0,0 +1,262 @@
+#include <fl/memory/epoch.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fl/memory/cache_padded.h>
+
+namespace
+{
+  using namespace fl;
+  using namespace fl::epoch;
+
+  constexpr u64 pinned_bit = 1ULL << 63U;
+
+  struct retired_ptr
+  {
+    void* ptr;
+    deleter_function deleter;
+  };
+
+  struct bag
+  {
+    u64 epoch = 0;
+    std::vector<retired_ptr> items;
+  };
+
+  /**
+   * Per-thread participant. Records are never freed: when thread exits, its record is marked as
+   * unused and can be adopted by a new thread, so that the lock-free list is only ever appended to.
+   */
+  struct alignas(cache_line_size) record
+  {
+    std::atomic<u64> local = 0; // global epoch | pinned_bit while inside a critical section, 0 otherwise
+    std::atomic<bool> in_use = false;
+    record* next = nullptr;
+
+    // accessed only by the owning thread
+    usize nesting = 0;
+    usize pending = 0;
+    std::array<bag, 3> bags;
+  };
+
+  struct collector
+  {
+    cache_padded<std::atomic<u64>> epoch = cache_padded<std::atomic<u64>>(std::in_place, 0);
+    std::atomic<record*> head = nullptr;
+    std::atomic<usize> threads = 0;
+    std::atomic<usize> batch_size = 128;
+    std::atomic<u64> retired = 0;
+    std::atomic<u64> reclaimed = 0;
+    std::mutex orphans_mutex;
+    std::vector<bag> orphans;
+  };
+
+  // intentionally leaked: thread-local handles of detached threads may outlive static destructors
+  auto global() -> collector& {
+    static auto* const c = new collector(); // NOLINT(*-owning-memory)
+    return *c;
+  }
+
+  auto is_expired(u64 bag_epoch, u64 global_epoch) -> bool {
+    return global_epoch - bag_epoch >= 2;
+  }
+
+  auto destroy(std::vector<retired_ptr>&& items) -> void {
+    auto const local = std::move(items);
+    for(auto const& item : local)
+      item.deleter(item.ptr);
+    global().reclaimed.fetch_add(local.size(), std::memory_order_relaxed);
+  }
+
+  auto acquire_record() -> record* {
+    auto& c = global();
+    for(auto* r = c.head.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+      auto expected = false;
+      if(r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        c.threads.fetch_add(1, std::memory_order_relaxed);
+        return r;
+      }
+    }
+    auto* r = new record(); // NOLINT(*-owning-memory)
+    r->in_use.store(true, std::memory_order_relaxed);
+    r->next = c.head.load(std::memory_order_relaxed);
+    while(not c.head.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+      ;
+    c.threads.fetch_add(1, std::memory_order_relaxed);
+    return r;
+  }
+
+  auto release_record(record* r) -> void {
+    auto& c = global();
+    {
+      auto const lock = std::scoped_lock(c.orphans_mutex);
+      for(auto& b : r->bags) {
+        if(b.items.empty())
+          continue;
+        c.orphans.push_back(std::move(b));
+        b = bag();
+      }
+    }
+    r->pending = 0;
+    r->nesting = 0;
+    r->local.store(0, std::memory_order_release);
+    r->in_use.store(false, std::memory_order_release);
+    c.threads.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  struct handle
+  {
+    record* rec = nullptr;
+
+    handle() = default;
+    handle(handle const&) = delete;
+    handle(handle&&) = delete;
+    auto operator=(handle const&) -> handle& = delete;
+    auto operator=(handle&&) -> handle& = delete;
+
+    ~handle() {
+      if(this->rec != nullptr)
+        release_record(this->rec);
+    }
+
+    auto get() -> record& {
+      if(this->rec == nullptr)
+        this->rec = acquire_record();
+      return *this->rec;
+    }
+  };
+
+  thread_local handle current; // NOLINT(*-avoid-non-const-global-variables)
+
+  /**
+   * Advances the global epoch if every pinned thread has observed the current one.
+   * Returns the global epoch after the attempt.
+   */
+  auto try_advance() -> u64 {
+    auto& c = global();
+    auto e = c.epoch->load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for(auto const* r = c.head.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+      auto const local = r->local.load(std::memory_order_relaxed);
+      if((local & pinned_bit) != 0 and (local & ~pinned_bit) != e)
+        return e;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(c.epoch->compare_exchange_strong(e, e + 1, std::memory_order_release, std::memory_order_relaxed))
+      return e + 1;
+    return e;
+  }
+
+  auto collect_orphans(u64 global_epoch, bool blocking) -> void {
+    auto& c = global();
+    auto lock = std::unique_lock(c.orphans_mutex, std::defer_lock);
+    if(blocking)
+      lock.lock();
+    else if(not lock.try_lock())
+      return;
+    auto expired = std::vector<retired_ptr>();
+    std::erase_if(c.orphans, [&](bag& b) {
+      if(not is_expired(b.epoch, global_epoch))
+        return false;
+      expired.insert(expired.end(), b.items.begin(), b.items.end());
+      return true;
+    });
+    lock.unlock();
+    destroy(std::move(expired));
+  }
+
+  auto collect(record& r, u64 global_epoch) -> void {
+    for(auto& b : r.bags) {
+      if(b.items.empty() or not is_expired(b.epoch, global_epoch))
+        continue;
+      r.pending -= b.items.size();
+      destroy(std::exchange(b.items, {}));
+    }
+  }
+} // namespace
+
+namespace fl::epoch
+{
+  guard::guard() noexcept {
+    auto& r = ::current.get();
+    if(r.nesting++ != 0)
+      return;
+    auto const e = ::global().epoch->load(std::memory_order_relaxed);
+    r.local.store(e | ::pinned_bit, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  guard::~guard() noexcept {
+    auto& r = ::current.get();
+    if(--r.nesting == 0)
+      r.local.store(0, std::memory_order_release);
+  }
+
+  bool pinned() noexcept {
+    return ::current.rec != nullptr and ::current.rec->nesting != 0;
+  }
+
+  void retire(void* ptr, deleter_function deleter) {
+    auto& c = ::global();
+    auto& r = ::current.get();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto const e = c.epoch->load(std::memory_order_relaxed);
+    auto& b = r.bags.at(e % r.bags.size());
+    if(b.epoch != e) {
+      // same slot can only hold an epoch that is at least three epochs old, which is always expired
+      r.pending -= b.items.size();
+      destroy(std::exchange(b.items, {}));
+      b.epoch = e;
+    }
+    b.items.push_back({ .ptr = ptr, .deleter = deleter });
+    c.retired.fetch_add(1, std::memory_order_relaxed);
+    if(++r.pending < c.batch_size.load(std::memory_order_relaxed))
+      return;
+    auto const global_epoch = ::try_advance();
+    ::collect(r, global_epoch);
+    ::collect_orphans(global_epoch, false);
+  }
+
+  bool try_reclaim() {
+    auto& c = ::global();
+    auto const before = c.epoch->load(std::memory_order_relaxed);
+    auto const global_epoch = ::try_advance();
+    ::collect(::current.get(), global_epoch);
+    ::collect_orphans(global_epoch, false);
+    return global_epoch != before;
+  }
+
+  void synchronize() {
+    if(pinned())
+      contracts::broken_precondition("synchronize must not be called inside a critical section");
+    auto& c = ::global();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto const target = c.epoch->load(std::memory_order_relaxed) + 2;
+    auto global_epoch = ::try_advance();
+    while(global_epoch < target) {
+      std::this_thread::yield();
+      global_epoch = ::try_advance();
+    }
+    ::collect(::current.get(), global_epoch);
+    ::collect_orphans(global_epoch, true);
+  }
+
+  void set_batch_size(usize size) {
+    if(size == 0)
+      contracts::broken_precondition("batch size must be greater than zero");
+    ::global().batch_size.store(size, std::memory_order_relaxed);
+  }
+
+  statistics stats() noexcept {
+    auto const& c = ::global();
+    return {
+      .epoch = c.epoch->load(std::memory_order_relaxed),
+      .retired = c.retired.load(std::memory_order_relaxed),
+      .reclaimed = c.reclaimed.load(std::memory_order_relaxed),
+      .threads = c.threads.load(std::memory_order_relaxed)
+    };
+  }
+} // namespace fl::epoch
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include <fl/threading/lock_order.h>
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <fl/contracts.h>
+
+namespace
+{
+  using namespace fl;
+  using fl::detail::lock_order::lock_id;
+
+  struct held_lock
+  {
+    lock_id id;
+    std::source_location location;
+  };
+
+  struct edge
+  {
+    std::source_location from; ///< Where the first lock was acquired.
+    std::source_location to;   ///< Where the second lock was acquired while holding the first one.
+  };
+
+  struct graph
+  {
+    std::atomic<lock_id> next_id = 1;
+    std::shared_mutex mutex;
+    std::unordered_map<lock_id, std::unordered_map<lock_id, edge>> edges;
+  };
+
+  // intentionally leaked: locks with static storage duration may be destroyed after the graph
+  auto global() -> graph& {
+    static auto* const g = new graph(); // NOLINT(*-owning-memory)
+    return *g;
+  }
+
+  thread_local std::vector<held_lock> held; // NOLINT(*-avoid-non-const-global-variables)
+
+  /**
+   * Finds a path from <tt>from</tt> to <tt>to</tt>. Returns the edges of the path, empty if none.
+   */
+  auto find_path(graph const& g, lock_id from, lock_id to) -> std::vector<std::pair<lock_id, edge>> {
+    auto parent = std::unordered_map<lock_id, std::pair<lock_id, edge>>();
+    auto visited = std::unordered_set<lock_id> { from };
+    auto stack = std::vector<lock_id> { from };
+    while(not stack.empty()) {
+      auto const current = stack.back();
+      stack.pop_back();
+      auto const it = g.edges.find(current);
+      if(it == g.edges.end())
+        continue;
+      for(auto const& [next, e] : it->second) {
+        if(not visited.insert(next).second)
+          continue;
+        parent.emplace(next, std::pair(current, e));
+        if(next == to) {
+          auto path = std::vector<std::pair<lock_id, edge>>();
+          for(auto node = to; node != from; node = parent.at(node).first)
+            path.emplace_back(node, parent.at(node).second);
+          std::ranges::reverse(path);
+          return path;
+        }
+        stack.push_back(next);
+      }
+    }
+    return {};
+  }
+
+  auto describe(std::source_location const& location) -> std::string {
+    return std::format("{}:{} ('{}')", location.file_name(), location.line(), location.function_name());
+  }
+} // namespace
+
+namespace fl::detail::lock_order
+{
+  lock_id register_lock() noexcept {
+    return ::global().next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void unregister_lock(lock_id id) noexcept {
+    auto& g = ::global();
+    auto const lock = std::unique_lock(g.mutex);
+    g.edges.erase(id);
+    for(auto& [from, targets] : g.edges)
+      targets.erase(id);
+  }
+
+  void before_lock(lock_id id, std::source_location location) {
+    auto& g = ::global();
+    auto message = std::string();
+    for(auto const& h : ::held) {
+      if(h.id == id)
+        continue;
+      {
+        auto const lock = std::shared_lock(g.mutex);
+        auto const it = g.edges.find(h.id);
+        if(it != g.edges.end() and it->second.contains(id))
+          continue;
+      }
+      auto const lock = std::unique_lock(g.mutex);
+      auto const path = ::find_path(g, id, h.id);
+      if(path.empty()) {
+        g.edges[h.id].try_emplace(id, ::edge { .from = h.location, .to = location });
+        continue;
+      }
+      message = std::format(
+        "Lock order inversion: acquiring lock #{} at {} while holding lock #{} acquired at {}. "
+        "Opposite order was established earlier:",
+        id,
+        ::describe(location),
+        h.id,
+        ::describe(h.location)
+      );
+      auto from = id;
+      for(auto const& [to, e] : path) {
+        message += std::format(" lock #{} acquired at {}, then lock #{} acquired at {};", from, ::describe(e.from), to, ::describe(e.to));
+        from = to;
+      }
+      break;
+    }
+    if(not message.empty())
+      contracts::detail::violate(contracts::contract_type::invariant, message, location);
+  }
+
+  void after_lock(lock_id id, std::source_location location) {
+    ::held.push_back({ .id = id, .location = location });
+  }
+
+  void after_unlock(lock_id id) noexcept {
+    // locks are not necessarily released in reverse order
+    auto const it = std::ranges::find(::held.rbegin(), ::held.rend(), id, &::held_lock::id);
+    if(it != ::held.rend())
+      ::held.erase(std::next(it).base());
+  }
+} // namespace fl::detail::lock_order
\ No newline at end of file
@@ -0,0 +1,756 @@
+#include <fl/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <variant>
+#include <vector>
+#include <fl/memory/cache_padded.h>
+#include <fl/threading/event_count.h>
+#include <spdlog/sinks/sink.h>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+  using namespace fl;
+  using namespace fl::log;
+
+  /// Size of a ring slot in machine words: one cache-line multiple per record.
+  constexpr auto slot_words = usize(32);
+
+  /**
+   * Fixed part of a record in a slot, followed by the encoded arguments.
+   */
+  struct record_header
+  {
+    i64 time = 0;
+    call_site site = {};
+    u32 size = 0;
+    u32 suppressed = 0;
+    level severity = level::info;
+  };
+
+  constexpr auto payload_size = (slot_words - 1) * sizeof(u64);
+  static_assert(sizeof(record_header) + max_argument_size <= payload_size);
+  static_assert(std::is_trivially_copyable_v<record_header>);
+
+  /**
+   * Slot of a ring. The sequence number is the index of the record in the slot plus one, or zero
+   * while the slot is written: with @ref overflow_policy::drop_oldest the producer may overwrite a
+   * slot the consumer is reading, and the consumer detects that like a sequence lock. Payload words
+   * are accessed atomically for the same reason.
+   */
+  struct slot
+  {
+    std::atomic<u64> sequence = 0;
+    std::array<u64, slot_words - 1> payload = {};
+  };
+
+  /**
+   * Record copied out of a ring, owned by the background thread until the batch is written.
+   */
+  struct pending_record
+  {
+    record_header header;
+    u64 thread = 0;
+    std::array<std::byte, max_argument_size> arguments = {};
+  };
+
+  auto encode(record_header const& header, std::span<std::byte const> arguments, std::array<u64, slot_words - 1>& words) -> usize {
+    auto const used = (sizeof(header) + arguments.size() + sizeof(u64) - 1) / sizeof(u64);
+    auto* const bytes = reinterpret_cast<std::byte*>(words.data()); // NOLINT(*-reinterpret-cast)
+    words[used - 1] = 0;
+    std::memcpy(bytes, &header, sizeof(header));
+    std::memcpy(bytes + sizeof(header), arguments.data(), arguments.size());
+    return used;
+  }
+
+  /**
+   * Single-producer single-consumer ring of one thread.
+   */
+  class ring
+  {
+   public:
+    ring(usize capacity, u64 thread)
+      : mask_(std::bit_ceil(std::max(capacity, usize(2))) - 1)
+      , slots_(std::make_unique<slot[]>(this->mask_ + 1)) // NOLINT(*-avoid-c-arrays)
+      , thread_(thread)
+    {}
+
+    [[nodiscard]] auto thread() const -> u64 { return this->thread_; }
+    [[nodiscard]] auto capacity() const -> usize { return this->mask_ + 1; }
+
+    /// Producer only. Returns <code>false</code> if the ring is full.
+    auto try_push(record_header const& header, std::span<std::byte const> arguments, bool overwrite) -> bool {
+      auto const tail = this->tail_->load(std::memory_order_relaxed);
+      if(not overwrite and tail - this->cached_head_ > this->mask_) {
+        this->cached_head_ = this->head_->load(std::memory_order_acquire);
+        if(tail - this->cached_head_ > this->mask_)
+          return false;
+      }
+      std::array<u64, slot_words - 1> words; // NOLINT(*-member-init)
+      auto const used = ::encode(header, arguments, words);
+      auto& target = this->slots_[tail & this->mask_];
+      target.sequence.store(0, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      for(auto i = usize(0); i < used; ++i)
+        std::atomic_ref(target.payload[i]).store(words[i], std::memory_order_relaxed);
+      target.sequence.store(tail + 1, std::memory_order_release);
+      this->tail_->store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// Consumer only. Appends all available records; returns the number of overwritten ones.
+    auto drain(std::vector<pending_record>& out) -> u64 {
+      auto const tail = this->tail_->load(std::memory_order_acquire);
+      auto head = this->head_->load(std::memory_order_relaxed);
+      auto lost = u64(0);
+      if(tail - head > this->capacity()) {
+        lost += tail - this->capacity() - head;
+        head = tail - this->capacity();
+      }
+      for(; head != tail; ++head) {
+        auto& source = this->slots_[head & this->mask_];
+        auto const before = source.sequence.load(std::memory_order_acquire);
+        std::array<u64, slot_words - 1> words; // NOLINT(*-member-init)
+        auto header = record_header();
+        if(before == head + 1) {
+          constexpr auto header_words = (sizeof(header) + sizeof(u64) - 1) / sizeof(u64);
+          for(auto i = usize(0); i < header_words; ++i)
+            words[i] = std::atomic_ref(source.payload[i]).load(std::memory_order_relaxed);
+          std::memcpy(static_cast<void*>(&header), words.data(), sizeof(header));
+          header.size = static_cast<u32>(std::min<usize>(header.size, max_argument_size));
+          for(auto i = header_words; i < (sizeof(header) + header.size + sizeof(u64) - 1) / sizeof(u64); ++i)
+            words[i] = std::atomic_ref(source.payload[i]).load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(before != head + 1 or source.sequence.load(std::memory_order_relaxed) != before) {
+          ++lost;
+          continue;
+        }
+        auto& record = out.emplace_back();
+        record.header = header;
+        record.thread = this->thread_;
+        std::memcpy(record.arguments.data(), reinterpret_cast<std::byte const*>(words.data()) + sizeof(header), record.header.size); // NOLINT(*-reinterpret-cast)
+      }
+      this->head_->store(head, std::memory_order_release);
+      return lost;
+    }
+
+    /// Consumer only.
+    [[nodiscard]] auto empty() const -> bool {
+      return this->head_->load(std::memory_order_relaxed) == this->tail_->load(std::memory_order_acquire);
+    }
+
+    std::atomic<bool> retired = false;
+
+   private:
+    usize mask_;
+    std::unique_ptr<slot[]> slots_; // NOLINT(*-avoid-c-arrays)
+    u64 thread_;
+    cache_padded<std::atomic<u64>> tail_ = {};
+    cache_padded<std::atomic<u64>> head_ = {};
+    u64 cached_head_ = 0;
+  };
+
+  /// Longest summary of suppressed records appended to a message.
+  constexpr auto suppressed_summary_size = std::string_view(" [4294967295 suppressed]").size();
+
+  /// Formats the message of a record, followed by the summary of suppressed records.
+  auto to_record(pending_record const& pending, std::span<char> message) -> record {
+    auto const& site = pending.header.site;
+    auto const arguments = std::span(pending.arguments.data(), pending.header.size);
+    auto const suppressed = pending.header.suppressed;
+    auto size = site.decode(site.format, arguments, suppressed == 0 ? message : message.first(message.size() - ::suppressed_summary_size));
+    if(suppressed != 0)
+      size += static_cast<usize>(std::format_to_n(message.data() + size, ::suppressed_summary_size, " [{} suppressed]", suppressed).size);
+    return {
+      .severity = pending.header.severity,
+      .time = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(pending.header.time)),
+      .thread = pending.thread,
+      .location = site.location,
+      .message = std::string_view(message.data(), size),
+      .site = &site,
+      .arguments = arguments,
+      .suppressed = suppressed
+    };
+  }
+
+  /**
+   * Output iterator which counts all characters but stores only those which fit.
+   */
+  class truncating_iterator
+  {
+   public:
+    using difference_type = std::ptrdiff_t;
+
+    explicit truncating_iterator(std::span<char> output)
+      : output_(output)
+    {}
+
+    [[nodiscard]] auto size() const -> usize { return this->size_; }
+    auto operator*() -> truncating_iterator& { return *this; }
+    auto operator++() -> truncating_iterator& { return *this; }
+    auto operator++(int) -> truncating_iterator& { return *this; }
+
+    auto operator=(char c) -> truncating_iterator& {
+      if(this->size_ < this->output_.size())
+        this->output_[this->size_] = c;
+      ++this->size_;
+      return *this;
+    }
+
+   private:
+    std::span<char> output_;
+    usize size_ = 0;
+  };
+
+  /// Appends the structured fields of a record to its message as <tt>key=value</tt> pairs.
+  auto with_fields(record const& r, std::span<char> text) -> std::string_view {
+    auto size = std::min(r.message.size(), text.size());
+    std::memcpy(text.data(), r.message.data(), size);
+    visit_fields(r, [&](std::string_view key, field_value const& value) {
+      std::visit([&](auto const& v) {
+        auto const remaining = static_cast<std::ptrdiff_t>(text.size() - size);
+        size += std::min(
+          static_cast<usize>(std::format_to_n(text.data() + size, remaining, " {}={}", key, v).size),
+          text.size() - size
+        );
+      }, value);
+    });
+    return { text.data(), size };
+  }
+
+  auto write_to_spdlog(std::span<record const> records) -> void {
+    auto const logger = spdlog::default_logger();
+    auto flush = false;
+    auto text = std::array<char, 2 * max_message_size>();
+    for(auto const& r : records) {
+      auto const severity = static_cast<spdlog::level::level_enum>(r.severity);
+      if(not logger->should_log(severity))
+        continue;
+      auto const payload = r.site != nullptr and r.site->fields != nullptr ? ::with_fields(r, text) : r.message;
+      auto message = spdlog::details::log_msg(
+        r.time,
+        spdlog::source_loc(r.location.file_name(), static_cast<int>(r.location.line()), r.location.function_name()),
+        logger->name(),
+        severity,
+        spdlog::string_view_t(payload.data(), payload.size())
+      );
+      message.thread_id = static_cast<usize>(r.thread);
+      for(auto const& sink : logger->sinks())
+        if(sink->should_log(severity))
+          sink->log(message);
+      flush = flush or severity >= logger->flush_level();
+    }
+    if(flush)
+      for(auto const& sink : logger->sinks())
+        sink->flush();
+  }
+
+  /**
+   * Sink writing one JSON object per record. The buffer keeps its capacity between batches.
+   */
+  class json_lines_writer
+  {
+   public:
+    explicit json_lines_writer(std::FILE* file)
+      : file_(file) {
+      this->buffer_.reserve(usize(1) << 16);
+    }
+
+    auto operator()(std::span<record const> records) -> void {
+      this->buffer_.clear();
+      for(auto const& r : records)
+        this->append(r);
+      std::fwrite(this->buffer_.data(), 1, this->buffer_.size(), this->file_);
+      std::fflush(this->file_);
+    }
+
+   private:
+    static constexpr auto level_names = std::array<std::string_view, 7> {
+      "trace", "debug", "info", "warn", "error", "critical", "off"
+    };
+
+    auto append(record const& r) -> void {
+      this->raw(R"({"time":)");
+      this->number(std::chrono::duration_cast<std::chrono::nanoseconds>(r.time.time_since_epoch()).count());
+      this->raw(R"(,"level":")");
+      this->raw(level_names[std::min(static_cast<usize>(r.severity), level_names.size() - 1)]);
+      this->raw(R"(","thread":)");
+      this->number(r.thread);
+      this->raw(R"(,"file":)");
+      this->string(r.location.file_name());
+      this->raw(R"(,"line":)");
+      this->number(r.location.line());
+      this->raw(R"(,"message":)");
+      this->string(r.message);
+      if(r.suppressed != 0) {
+        this->raw(R"(,"suppressed":)");
+        this->number(r.suppressed);
+      }
+      visit_fields(r, [this](std::string_view key, field_value const& value) {
+        this->raw(",");
+        this->string(key);
+        this->raw(":");
+        std::visit([this](auto const& v) { this->value(v); }, value);
+      });
+      this->raw("}\n");
+    }
+
+    auto raw(std::string_view text) -> void {
+      this->buffer_.insert(this->buffer_.end(), text.begin(), text.end());
+    }
+
+    template <typename T>
+    auto number(T value) -> void {
+      auto digits = std::array<char, 32>();
+      auto const result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+      this->raw({ digits.data(), result.ptr });
+    }
+
+    auto string(std::string_view text) -> void {
+      constexpr auto hex = std::string_view("0123456789abcdef");
+      this->buffer_.push_back('"');
+      for(auto const c : text) {
+        switch(c) {
+          case '"': this->raw(R"(\")"); break;
+          case '\\': this->raw(R"(\\)"); break;
+          case '\n': this->raw(R"(\n)"); break;
+          case '\r': this->raw(R"(\r)"); break;
+          case '\t': this->raw(R"(\t)"); break;
+          default:
+            if(static_cast<unsigned char>(c) < 0x20) {
+              this->raw(R"(\u00)");
+              this->buffer_.push_back(hex[static_cast<unsigned char>(c) >> 4]);
+              this->buffer_.push_back(hex[static_cast<unsigned char>(c) & 0xF]);
+            } else
+              this->buffer_.push_back(c);
+        }
+      }
+      this->buffer_.push_back('"');
+    }
+
+    auto value(bool v) -> void { this->raw(v ? "true" : "false"); }
+    auto value(i64 v) -> void { this->number(v); }
+    auto value(u64 v) -> void { this->number(v); }
+    auto value(std::string_view v) -> void { this->string(v); }
+
+    auto value(double v) -> void {
+      if(std::isfinite(v))
+        this->number(v);
+      else
+        this->raw("null");
+    }
+
+    std::FILE* file_;
+    std::vector<char> buffer_;
+  };
+
+  /**
+   * Global logging state. Rings are shared between their thread and the background thread, which
+   * drops them once they are retired and drained.
+   */
+  class backend
+  {
+   public:
+    backend() {
+      // construct the spdlog registry first, so it is destroyed after the final drain
+      static_cast<void>(spdlog::default_logger());
+    }
+
+    ~backend() { this->stop(); }
+    backend(backend const&) = delete;
+    backend(backend&&) = delete;
+    auto operator=(backend const&) -> backend& = delete;
+    auto operator=(backend&&) -> backend& = delete;
+
+    std::atomic<level> minimum = level::info;
+    std::atomic<bool> running = false;
+    std::atomic<u64> generation = 0;
+    std::atomic<u64> next_thread = 1;
+    std::atomic<u64> written = 0;
+    std::atomic<u64> dropped_newest = 0;
+    std::atomic<u64> dropped_oldest = 0;
+    std::atomic<u64> blocked = 0;
+    std::atomic<overflow_policy> overflow = overflow_policy::block;
+    event_count space; ///< Notified after the rings are drained, for producers blocked on a full ring.
+
+    auto set_sink(sink destination) -> void {
+      auto const lock = std::lock_guard(this->sink_mutex_);
+      this->sink_ = std::move(destination);
+    }
+
+    auto write_batch(std::span<record const> records) -> void {
+      if(records.empty())
+        return;
+      auto const lock = std::lock_guard(this->sink_mutex_);
+      if(this->sink_)
+        this->sink_(records);
+      else
+        ::write_to_spdlog(records);
+    }
+
+    auto make_ring(u64 thread) -> std::shared_ptr<ring> {
+      auto const lock = std::lock_guard(this->rings_mutex_);
+      return this->rings_.emplace_back(std::make_shared<ring>(this->capacity_, thread));
+    }
+
+    auto start(async_options const& options) -> void {
+      auto const lock = std::lock_guard(this->control_mutex_);
+      this->stop_locked();
+      {
+        auto const rings_lock = std::lock_guard(this->rings_mutex_);
+        this->capacity_ = options.capacity;
+      }
+      this->flush_interval_ = options.flush_interval;
+      this->overflow.store(options.overflow, std::memory_order_relaxed);
+      this->generation.fetch_add(1, std::memory_order_release);
+      this->running.store(true, std::memory_order_release);
+      this->drainer_ = std::jthread([this](std::stop_token const& stop) { this->run(stop); });
+    }
+
+    auto stop() -> void {
+      auto const lock = std::lock_guard(this->control_mutex_);
+      this->stop_locked();
+    }
+
+    /// Makes the background thread drain the rings without waiting for it, e.g. because a ring is full.
+    auto wake() -> void {
+      auto const lock = std::lock_guard(this->flush_mutex_);
+      ++this->flush_requested_;
+      this->wake_.notify_one();
+    }
+
+    auto flush() -> void {
+      if(not this->running.load(std::memory_order_acquire))
+        return;
+      auto lock = std::unique_lock(this->flush_mutex_);
+      auto const request = ++this->flush_requested_;
+      this->wake_.notify_one();
+      this->flushed_.wait(lock, [&] {
+        return this->flush_completed_ >= request or not this->running.load(std::memory_order_acquire);
+      });
+    }
+
+   private:
+    auto stop_locked() -> void {
+      if(not this->drainer_.joinable())
+        return;
+      this->running.store(false, std::memory_order_release);
+      this->space.notify_all();
+      this->drainer_.request_stop();
+      this->drainer_.join();
+      this->drain();
+      auto const lock = std::lock_guard(this->flush_mutex_);
+      this->flushed_.notify_all();
+    }
+
+    auto run(std::stop_token const& stop) -> void {
+      while(not stop.stop_requested()) {
+        {
+          auto lock = std::unique_lock(this->flush_mutex_);
+          this->wake_.wait_for(lock, stop, this->flush_interval_, [&] {
+            return this->flush_requested_ > this->flush_completed_;
+          });
+        }
+        auto const request = [&] {
+          auto const lock = std::lock_guard(this->flush_mutex_);
+          return this->flush_requested_;
+        }();
+        this->drain();
+        auto const lock = std::lock_guard(this->flush_mutex_);
+        this->flush_completed_ = std::max(this->flush_completed_, request);
+        this->flushed_.notify_all();
+      }
+    }
+
+    auto drain() -> void {
+      auto rings = [&] {
+        auto const lock = std::lock_guard(this->rings_mutex_);
+        return this->rings_;
+      }();
+      this->batch_.clear();
+      for(auto const& r : rings)
+        this->dropped_oldest.fetch_add(r->drain(this->batch_), std::memory_order_relaxed);
+      this->space.notify_all();
+      std::ranges::stable_sort(this->batch_, {}, [](pending_record const& r) { return r.header.time; });
+      this->messages_.resize(std::max(this->messages_.size(), this->batch_.size()));
+      this->records_.clear();
+      for(auto i = usize(0); i < this->batch_.size(); ++i)
+        this->records_.push_back(::to_record(this->batch_[i], this->messages_[i]));
+      this->write_batch(this->records_);
+      this->written.fetch_add(this->records_.size(), std::memory_order_relaxed);
+
+      auto const lock = std::lock_guard(this->rings_mutex_);
+      std::erase_if(this->rings_, [](std::shared_ptr<ring> const& r) {
+        return r->retired.load(std::memory_order_acquire) and r->empty();
+      });
+    }
+
+    std::mutex control_mutex_;
+    std::mutex sink_mutex_;
+    sink sink_;
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<ring>> rings_;
+    usize capacity_ = async_options().capacity;
+    std::chrono::milliseconds flush_interval_ = async_options().flush_interval;
+    std::mutex flush_mutex_;
+    std::condition_variable_any wake_;
+    std::condition_variable_any flushed_;
+    u64 flush_requested_ = 0;
+    u64 flush_completed_ = 0;
+    std::vector<pending_record> batch_;
+    std::vector<std::array<char, max_message_size>> messages_;
+    std::vector<record> records_;
+    std::jthread drainer_;
+  };
+
+  /**
+   * State of a limited call site. The slot is claimed by a CAS on <tt>key</tt>. <tt>value</tt> is
+   * the call counter, the theoretical arrival time of the next record in nanoseconds or the logged
+   * flag, depending on the kind of limit.
+   */
+  struct limited_site
+  {
+    std::atomic<u64> key = 0;
+    std::atomic<u64> value = 0;
+    std::atomic<u64> suppressed = 0;
+  };
+
+  /**
+   * Statically allocated open-addressing table of limited call sites.
+   */
+  struct limited_table
+  {
+    static constexpr auto site_count = usize(1'024);
+
+    std::array<limited_site, site_count> sites;
+  };
+
+  constinit limited_table limited; // NOLINT(*-avoid-non-const-global-variables)
+
+  auto site_key(detail::limit kind, std::source_location const& location) noexcept -> u64 {
+    // the file name pointer identifies the file within a translation unit; sites in inline
+    // functions may get one slot per translation unit, which only splits their limit
+    auto hash = u64(14'695'981'039'346'656'037ULL);
+    auto const mix = [&hash](u64 value) {
+      hash ^= value;
+      hash *= 1'099'511'628'211ULL;
+    };
+    mix(reinterpret_cast<uptr>(location.file_name())); // NOLINT(*-reinterpret-cast)
+    mix(location.line());
+    mix(location.column());
+    mix(static_cast<u64>(kind));
+    return hash == 0 ? 1 : hash;
+  }
+
+  auto find_limited_site(detail::limit kind, std::source_location const& location) noexcept -> limited_site* {
+    auto const key = ::site_key(kind, location);
+    for(auto i = usize(0); i < limited_table::site_count; ++i) {
+      auto& site = ::limited.sites[(key + i) % limited_table::site_count];
+      auto current = site.key.load(std::memory_order_acquire);
+      if(current == 0 and site.key.compare_exchange_strong(current, key, std::memory_order_acq_rel))
+        return &site;
+      if(current == key)
+        return &site;
+    }
+    return nullptr;
+  }
+
+  /// Generic cell rate algorithm: admits a call if the next record is due within the burst.
+  auto admit_rate(limited_site& site, u64 interval) noexcept -> bool {
+    constexpr auto second = u64(1'000'000'000);
+    auto const now = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()
+    ).count());
+    auto const burst = interval < second ? second - interval : 0;
+    auto due = site.value.load(std::memory_order_relaxed);
+    while(true) {
+      if(due > now + burst)
+        return false;
+      auto const start = std::max(due, now);
+      auto const next = interval > ~u64(0) - start ? ~u64(0) : start + interval;
+      if(site.value.compare_exchange_weak(due, next, std::memory_order_relaxed))
+        return true;
+    }
+  }
+
+  auto state() -> backend& {
+    static auto instance = backend();
+    return instance;
+  }
+
+  /**
+   * Ring of the calling thread, replaced when the backend is restarted.
+   */
+  struct thread_ring
+  {
+    std::shared_ptr<ring> current = nullptr;
+    u64 generation = 0;
+    u64 thread = 0;
+
+    thread_ring() = default;
+    thread_ring(thread_ring const&) = delete;
+    thread_ring(thread_ring&&) = delete;
+    auto operator=(thread_ring const&) -> thread_ring& = delete;
+    auto operator=(thread_ring&&) -> thread_ring& = delete;
+
+    ~thread_ring() {
+      if(this->current)
+        this->current->retired.store(true, std::memory_order_release);
+    }
+  };
+
+  thread_local auto local_ring = thread_ring(); // NOLINT(*-avoid-non-const-global-variables)
+
+  auto thread_id() -> u64 {
+    if(::local_ring.thread == 0)
+      ::local_ring.thread = ::state().next_thread.fetch_add(1, std::memory_order_relaxed);
+    return ::local_ring.thread;
+  }
+
+  auto current_ring(backend& b) -> ring& {
+    auto& local = ::local_ring;
+    auto const generation = b.generation.load(std::memory_order_acquire);
+    if(local.generation != generation or not local.current) {
+      if(local.current)
+        local.current->retired.store(true, std::memory_order_release);
+      local.current = b.make_ring(::thread_id());
+      local.generation = generation;
+    }
+    return *local.current;
+  }
+
+  /// Returns <code>true</code> if the record was buffered or dropped, <code>false</code> if it has to be written synchronously.
+  auto push(backend& b, record_header const& header, std::span<std::byte const> arguments) -> bool {
+    auto& r = ::current_ring(b);
+    auto const overflow = b.overflow.load(std::memory_order_relaxed);
+    if(r.try_push(header, arguments, overflow == overflow_policy::drop_oldest))
+      return true;
+    if(overflow == overflow_policy::drop_newest) {
+      b.dropped_newest.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    b.blocked.fetch_add(1, std::memory_order_relaxed);
+    while(true) {
+      b.wake();
+      auto const key = b.space.prepare_wait();
+      if(r.try_push(header, arguments, false)) {
+        b.space.cancel_wait();
+        return true;
+      }
+      if(not b.running.load(std::memory_order_acquire)) {
+        b.space.cancel_wait();
+        return false;
+      }
+      b.space.wait(key);
+    }
+  }
+} // namespace
+
+namespace fl::log
+{
+  void set_sink(sink destination) {
+    ::state().set_sink(std::move(destination));
+  }
+
+  void set_level(level minimum) noexcept {
+    ::state().minimum.store(minimum, std::memory_order_relaxed);
+  }
+
+  level current_level() noexcept {
+    return ::state().minimum.load(std::memory_order_relaxed);
+  }
+
+  void start_async(async_options const& options) {
+    ::state().start(options);
+  }
+
+  void stop_async() {
+    ::state().stop();
+  }
+
+  void flush() {
+    ::state().flush();
+  }
+
+  async_statistics statistics() noexcept {
+    auto& b = ::state();
+    return {
+      .written = b.written.load(std::memory_order_relaxed),
+      .dropped_newest = b.dropped_newest.load(std::memory_order_relaxed),
+      .dropped_oldest = b.dropped_oldest.load(std::memory_order_relaxed),
+      .blocked = b.blocked.load(std::memory_order_relaxed)
+    };
+  }
+
+  usize detail::format_message(std::string_view format, std::format_args arguments, std::span<char> message) noexcept {
+    auto size = usize(0);
+    try {
+      size = std::vformat_to(::truncating_iterator(message), format, arguments).size();
+    } catch(std::exception const& e) {
+      size = std::format_to_n(message.data(), static_cast<std::ptrdiff_t>(message.size()), "<{}: {}>", e.what(), format).size;
+    }
+    if(size <= message.size())
+      return size;
+    std::ranges::fill(message.last(std::min(message.size(), usize(3))), '.');
+    return message.size();
+  }
+
+  detail::admission detail::admit(limit kind, u64 parameter, std::source_location const& location) noexcept {
+    auto* const site = ::find_limited_site(kind, location);
+    if(site == nullptr)
+      return { .logged = true };
+    auto logged = false;
+    switch(kind) {
+      case limit::every: {
+        auto const call = site->value.fetch_add(1, std::memory_order_relaxed);
+        logged = parameter <= 1 or call % parameter == 0;
+        break;
+      }
+      case limit::rate: logged = ::admit_rate(*site, parameter); break;
+      case limit::once: logged = site->value.exchange(1, std::memory_order_relaxed) == 0; break;
+    }
+    if(not logged) {
+      site->suppressed.fetch_add(1, std::memory_order_relaxed);
+      return {};
+    }
+    return { .logged = true, .suppressed = site->suppressed.exchange(0, std::memory_order_relaxed) };
+  }
+
+  sink json_lines_sink(std::FILE* file) {
+    return ::json_lines_writer(file);
+  }
+
+  void detail::write(level severity, call_site const& site, std::span<std::byte const> arguments, u64 suppressed) {
+    auto& b = ::state();
+    auto const header = ::record_header {
+      .time = std::chrono::system_clock::now().time_since_epoch().count(),
+      .site = site,
+      .size = static_cast<u32>(std::min(arguments.size(), max_argument_size)),
+      .suppressed = static_cast<u32>(std::min<u64>(suppressed, std::numeric_limits<u32>::max())),
+      .severity = severity
+    };
+    if(b.running.load(std::memory_order_acquire) and ::push(b, header, arguments.first(header.size)))
+      return;
+    auto pending = ::pending_record { .header = header, .thread = ::thread_id() };
+    std::memcpy(pending.arguments.data(), arguments.data(), header.size);
+    auto message = std::array<char, max_message_size>();
+    auto const r = ::to_record(pending, message);
+    b.write_batch(std::span(&r, 1));
+  }
+} // namespace fl::log
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <fl/threading/pipeline.h>
+
+#include <algorithm>
+#include <fl/contracts.h>
+
+namespace
+{
+  using namespace fl;
+
+  auto to_nanoseconds(sharded_counter const& counter) -> std::chrono::nanoseconds {
+    return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(counter.value()));
+  }
+} // namespace
+
+namespace fl::detail::pipeline
+{
+  stage::stage(stage_options options)
+    : options_(std::move(options))
+  {}
+
+  stage_statistics stage::statistics(std::chrono::nanoseconds elapsed) const {
+    auto const processed = this->processed_.value();
+    auto const seconds = std::chrono::duration<f64>(elapsed).count();
+    return {
+      .name = this->options_.name,
+      .concurrency = this->options_.concurrency,
+      .processed = processed,
+      .throughput = seconds > 0.0 ? static_cast<f64>(processed) / seconds : 0.0,
+      .queue_depth = this->queue_depth(),
+      .queue_capacity = this->queue_capacity(),
+      .busy = ::to_nanoseconds(this->busy_),
+      .stalled = ::to_nanoseconds(this->stalled_)
+    };
+  }
+
+  void core::fail(std::exception_ptr error) noexcept {
+    {
+      auto const lock = std::lock_guard(this->mutex_);
+      if(not this->error)
+        this->error = std::move(error);
+    }
+    this->cancel();
+  }
+
+  void core::cancel() noexcept {
+    this->cancelled_.store(true, std::memory_order_release);
+    for(auto const& s : this->stages)
+      s->cancel();
+  }
+} // namespace fl::detail::pipeline
+
+namespace fl
+{
+  pipeline::pipeline(std::vector<std::unique_ptr<detail::pipeline::stage>> stages)
+    : core_(std::make_unique<detail::pipeline::core>())
+  {
+    this->core_->stages = std::move(stages);
+  }
+
+  pipeline::~pipeline() {
+    if(not this->threads_.empty()) {
+      this->core_->cancel();
+      this->threads_.clear();
+    }
+  }
+
+  void pipeline::start() {
+    if(this->started_)
+      contracts::broken_precondition("pipeline can be started only once");
+    this->started_ = true;
+    this->core_->started = std::chrono::steady_clock::now();
+    try {
+      for(auto const& s : this->core_->stages)
+        s->start(*this->core_, this->threads_);
+    } catch(...) {
+      this->core_->cancel();
+      this->threads_.clear();
+      throw;
+    }
+  }
+
+  void pipeline::wait() {
+    this->threads_.clear();
+    this->core_->finished.store(std::chrono::steady_clock::now(), std::memory_order_release);
+    if(this->core_->error)
+      std::rethrow_exception(std::exchange(this->core_->error, nullptr));
+  }
+
+  void pipeline::cancel() noexcept {
+    this->core_->cancel();
+  }
+
+  std::vector<stage_statistics> pipeline::statistics() const {
+    auto const finished = this->core_->finished.load(std::memory_order_acquire);
+    auto const end = finished == std::chrono::steady_clock::time_point() ? std::chrono::steady_clock::now() : finished;
+    auto const elapsed = this->started_ ? end - this->core_->started : std::chrono::nanoseconds(0);
+    auto result = std::vector<stage_statistics>();
+    result.reserve(this->core_->stages.size());
+    for(auto const& s : this->core_->stages)
+      result.push_back(s->statistics(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)));
+    return result;
+  }
+} // namespace fl
\ No newline at end of file
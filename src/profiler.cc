@@ -0,0 +1,254 @@
+#include <fl/profiler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <format>
+#include <fl/platform/stacktrace.h>
+
+#if defined(FL_OS_LINUX)
+# include <csignal>
+# include <ctime>
+#endif
+
+namespace
+{
+  using namespace fl;
+
+  /// Marks a thread which could not claim a buffer in the current session.
+  constexpr auto no_buffer = ~usize(0);
+
+  /**
+   * Buffer claimed by the calling thread. A thread claims a buffer on its first sample in a session,
+   * from inside the signal handler, so the state is a trivial thread-local without a constructor.
+   */
+  struct thread_state
+  {
+    u64 session = 0;
+    usize buffer = no_buffer;
+  };
+
+  constinit thread_local auto current_thread = thread_state();
+
+  /// Identifies profiling sessions, so thread states of a previous session are not reused.
+  auto sessions = std::atomic<u64>(0);
+} // namespace
+
+namespace fl
+{
+  struct profiler::impl
+  {
+    profiler_options options;
+    u64 session = 0;
+    std::vector<uptr> words;
+    std::unique_ptr<std::atomic<usize>[]> sizes;
+    std::atomic<usize> next_buffer = 0;
+    std::atomic<u64> samples = 0;
+    std::atomic<u64> dropped = 0;
+    bool running = false;
+    #if defined(FL_OS_LINUX)
+    timer_t timer = {};
+    struct sigaction previous = {};
+    #endif
+
+    /**
+     * Profiler the signal handler records into. <tt>stop</tt> clears it and then waits until no handler
+     * is inside; both sides use sequentially consistent operations, so a handler which still sees the
+     * profiler is counted in <tt>handlers</tt>.
+     */
+    static inline auto active = std::atomic<impl*>(nullptr);
+    static inline auto handlers = std::atomic<usize>(0);
+
+    explicit impl(profiler_options const& options)
+      : options(options)
+      , words(options.max_threads * options.buffer_size)
+      , sizes(std::make_unique<std::atomic<usize>[]>(options.max_threads))
+    {}
+
+    /// Called from the signal handler. Each buffer is written only by its owning thread.
+    void record(void const* context) noexcept {
+      auto& state = ::current_thread;
+      if(state.session != this->session) {
+        auto const buffer = this->next_buffer.fetch_add(1, std::memory_order_relaxed);
+        state = { .session = this->session, .buffer = buffer < this->options.max_threads ? buffer : ::no_buffer };
+      }
+      if(state.buffer == ::no_buffer) {
+        this->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      auto const trace = platform::raw_stacktrace::capture_from_signal(context);
+      if(trace.empty())
+        return;
+      auto& size = this->sizes[state.buffer];
+      auto const used = size.load(std::memory_order_relaxed);
+      if(used + trace.size() + 1 > this->options.buffer_size) {
+        this->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      auto* const out = this->words.data() + state.buffer * this->options.buffer_size + used;
+      out[0] = trace.size();
+      std::ranges::copy(trace.frames(), out + 1);
+      size.store(used + trace.size() + 1, std::memory_order_release);
+      this->samples.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    #if defined(FL_OS_LINUX)
+    static void on_signal(int, siginfo_t*, void* context) {
+      auto const saved_errno = errno;
+      handlers.fetch_add(1);
+      if(auto* const profiler = active.load(); profiler != nullptr)
+        profiler->record(context);
+      handlers.fetch_sub(1);
+      errno = saved_errno;
+    }
+    #endif
+  };
+} // namespace fl
+
+namespace
+{
+  auto frame_name(platform::stacktrace_frame const& frame) -> std::string {
+    auto name = frame.function.empty() ? std::format("{:#x}", frame.address) : frame.function;
+    std::ranges::replace(name, ';', ':');
+    return name;
+  }
+} // namespace
+
+namespace fl
+{
+  profiler::profiler(profiler_options options)
+    : impl_(std::make_unique<impl>(options))
+  {}
+
+  profiler::~profiler() {
+    this->stop();
+  }
+
+  void profiler::start() {
+    #if defined(FL_OS_LINUX)
+    if(this->impl_->running)
+      return;
+    if(this->impl_->options.frequency == 0)
+      throw std::runtime_error("profiler frequency must be positive");
+    this->impl_->session = ::sessions.fetch_add(1, std::memory_order_relaxed) + 1;
+    this->impl_->next_buffer.store(0, std::memory_order_relaxed);
+    this->impl_->samples.store(0, std::memory_order_relaxed);
+    this->impl_->dropped.store(0, std::memory_order_relaxed);
+    for(auto i = usize(0); i < this->impl_->options.max_threads; ++i)
+      this->impl_->sizes[i].store(0, std::memory_order_relaxed);
+
+    auto* expected = static_cast<impl*>(nullptr);
+    if(not impl::active.compare_exchange_strong(expected, this->impl_.get()))
+      throw std::runtime_error("another profiler is already running");
+
+    struct sigaction action = {};
+    action.sa_sigaction = impl::on_signal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if(sigaction(SIGPROF, &action, &this->impl_->previous) != 0) {
+      impl::active.store(nullptr);
+      throw std::runtime_error("failed to install SIGPROF handler");
+    }
+
+    auto event = sigevent();
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = SIGPROF;
+    if(timer_create(CLOCK_PROCESS_CPUTIME_ID, &event, &this->impl_->timer) != 0) {
+      sigaction(SIGPROF, &this->impl_->previous, nullptr);
+      impl::active.store(nullptr);
+      throw std::runtime_error("failed to create profiling timer");
+    }
+    auto const period = 1'000'000'000L / static_cast<long>(this->impl_->options.frequency);
+    auto interval = itimerspec();
+    interval.it_interval = { .tv_sec = period / 1'000'000'000L, .tv_nsec = period % 1'000'000'000L };
+    interval.it_value = interval.it_interval;
+    if(timer_settime(this->impl_->timer, 0, &interval, nullptr) != 0) {
+      timer_delete(this->impl_->timer);
+      sigaction(SIGPROF, &this->impl_->previous, nullptr);
+      impl::active.store(nullptr);
+      throw std::runtime_error("failed to start profiling timer");
+    }
+    this->impl_->running = true;
+    #else
+    throw std::runtime_error("profiler is not supported on this platform");
+    #endif
+  }
+
+  void profiler::stop() noexcept {
+    #if defined(FL_OS_LINUX)
+    if(not this->impl_->running)
+      return;
+    timer_delete(this->impl_->timer);
+    impl::active.store(nullptr);
+    while(impl::handlers.load() != 0)
+      std::this_thread::yield();
+    // a signal generated before the timer was deleted may still be pending; the default action of
+    // SIGPROF terminates the process, so it is replaced by ignoring the signal
+    auto previous = this->impl_->previous;
+    if(not (previous.sa_flags & SA_SIGINFO) and previous.sa_handler == SIG_DFL)
+      previous.sa_handler = SIG_IGN;
+    sigaction(SIGPROF, &previous, nullptr);
+    this->impl_->running = false;
+    #endif
+  }
+
+  bool profiler::running() const noexcept {
+    return this->impl_->running;
+  }
+
+  u64 profiler::samples() const noexcept {
+    return this->impl_->samples.load(std::memory_order_relaxed);
+  }
+
+  u64 profiler::dropped() const noexcept {
+    return this->impl_->dropped.load(std::memory_order_relaxed);
+  }
+
+  void profiler::write_folded(std::ostream& stream) const {
+    auto stacks = std::map<std::vector<uptr>, u64>();
+    auto addresses = std::vector<uptr>();
+    auto const buffers = std::min(
+      this->impl_->next_buffer.load(std::memory_order_relaxed),
+      this->impl_->options.max_threads
+    );
+    for(auto b = usize(0); b < buffers; ++b) {
+      auto const* const words = this->impl_->words.data() + b * this->impl_->options.buffer_size;
+      auto const size = this->impl_->sizes[b].load(std::memory_order_acquire);
+      for(auto i = usize(0); i < size; i += words[i] + 1) {
+        auto const frames = std::span(words + i + 1, words[i]);
+        ++stacks[std::vector(frames.rbegin(), frames.rend())];
+        addresses.insert(addresses.end(), frames.begin(), frames.end());
+      }
+    }
+    std::ranges::sort(addresses);
+    auto const [last, end] = std::ranges::unique(addresses);
+    addresses.erase(last, end);
+
+    auto const symbols = platform::symbolizer::instance().symbolize(addresses);
+    auto names = std::vector<std::string>();
+    names.reserve(symbols.size());
+    for(auto const& frame : symbols)
+      names.push_back(::frame_name(frame));
+    auto const name_of = [&](uptr address) -> std::string const& {
+      return names[static_cast<usize>(std::ranges::lower_bound(addresses, address) - addresses.begin())];
+    };
+
+    for(auto const& [stack, count] : stacks) {
+      for(auto i = usize(0); i < stack.size(); ++i)
+        stream << (i == 0 ? "" : ";") << name_of(stack[i]);
+      stream << ' ' << count << '\n';
+    }
+  }
+
+  std::string profiler::folded() const {
+    auto stream = std::ostringstream();
+    this->write_folded(stream);
+    return stream.str();
+  }
+} // namespace fl
\ No newline at end of file
@@ -0,0 +1,811 @@
+#include <fl/platform/stacktrace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <limits>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <tuple>
+#include <cxxabi.h>
+#include <fl/containers/concurrent_map.h>
+
+#if defined(FL_OS_LINUX)
+# include <elf.h>
+# include <link.h>
+# include <ucontext.h>
+# include <unistd.h>
+# include <unwind.h>
+# include <elfutils/libdwfl.h>
+#elif defined(FL_OS_WINDOWS)
+# include <windows.h>
+#endif
+
+#if defined(FL_FRAME_POINTERS) and (defined(__x86_64__) or defined(__aarch64__))
+# define FL_STACKTRACE_FRAME_POINTERS
+#endif
+
+namespace
+{
+  using namespace fl;
+  using namespace fl::platform;
+
+  auto hex_digit(char c) -> int {
+    if(c >= '0' and c <= '9')
+      return c - '0';
+    if(c >= 'a' and c <= 'f')
+      return c - 'a' + 10;
+    if(c >= 'A' and c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  auto demangle(char const* name) -> std::string {
+    auto status = 0;
+    auto const demangled = std::unique_ptr<char, decltype(&std::free)>(
+      abi::__cxa_demangle(name, nullptr, nullptr, &status),
+      &std::free
+    );
+    return status == 0 and demangled ? std::string(demangled.get()) : std::string(name);
+  }
+
+  #if defined(FL_STACKTRACE_FRAME_POINTERS)
+  /// Largest accepted distance between two frame records, to stop at a frame without a frame pointer.
+  constexpr auto max_frame_size = uptr(1) << 20;
+
+  /**
+   * Walks the chain of frame records. A frame record is the saved frame pointer of the caller,
+   * followed by the return address. The walk stops at a record which does not look valid: records
+   * must be aligned and lie above each other within a bounded distance.
+   */
+  auto walk_frame_pointers(uptr const* frame, std::span<uptr> frames, usize skip) noexcept -> usize {
+    auto size = usize(0);
+    while(frame != nullptr and size < frames.size()) {
+      auto const return_address = frame[1];
+      if(return_address == 0)
+        break;
+      if(skip > 0)
+        --skip;
+      else
+        frames[size++] = return_address;
+      auto const* const next = reinterpret_cast<uptr const*>(frame[0]); // NOLINT(*-reinterpret-cast, *-no-int-to-ptr)
+      auto const distance = reinterpret_cast<uptr>(next) - reinterpret_cast<uptr>(frame); // NOLINT(*-reinterpret-cast)
+      if(next <= frame or distance > ::max_frame_size or reinterpret_cast<uptr>(next) % alignof(uptr) != 0) // NOLINT(*-reinterpret-cast)
+        break;
+      frame = next;
+    }
+    return size;
+  }
+  #endif
+
+  #if defined(FL_OS_LINUX) and not defined(FL_STACKTRACE_FRAME_POINTERS)
+  struct unwind_state
+  {
+    uptr* frames;
+    usize capacity;
+    usize size;
+    usize skip;
+  };
+
+  auto unwind_callback(_Unwind_Context* context, void* arg) -> _Unwind_Reason_Code {
+    auto& state = *static_cast<unwind_state*>(arg);
+    auto const ip = static_cast<uptr>(_Unwind_GetIP(context));
+    if(ip == 0)
+      return _URC_END_OF_STACK;
+    if(state.skip > 0) {
+      --state.skip;
+      return _URC_NO_REASON;
+    }
+    state.frames[state.size++] = ip;
+    return state.size == state.capacity ? _URC_END_OF_STACK : _URC_NO_REASON;
+  }
+  #endif
+
+  #if defined(FL_OS_LINUX)
+
+  /**
+   * Reads the <tt>NT_GNU_BUILD_ID</tt> note from the loaded <tt>PT_NOTE</tt> segments of a module.
+   */
+  auto read_build_id(dl_phdr_info const& info) -> build_id {
+    auto result = build_id();
+    for(auto i = 0; i < info.dlpi_phnum; ++i) {
+      auto const& phdr = info.dlpi_phdr[i];
+      if(phdr.p_type != PT_NOTE)
+        continue;
+      auto const* data = reinterpret_cast<u8 const*>(info.dlpi_addr + phdr.p_vaddr); // NOLINT(*-reinterpret-cast, *-no-int-to-ptr)
+      auto remaining = static_cast<usize>(phdr.p_memsz);
+      auto const align = [](usize size) { return (size + 3) & ~usize(3); };
+      while(remaining >= sizeof(ElfW(Nhdr))) {
+        auto note = ElfW(Nhdr)();
+        std::memcpy(&note, data, sizeof(note));
+        auto const name_size = align(note.n_namesz);
+        auto const size = sizeof(note) + name_size + align(note.n_descsz);
+        if(size > remaining)
+          break;
+        auto const* name = data + sizeof(note);
+        if(note.n_type == NT_GNU_BUILD_ID and note.n_namesz == 4 and std::memcmp(name, "GNU", 4) == 0) {
+          result.size = static_cast<u8>(std::min<usize>(note.n_descsz, build_id::max_size));
+          std::memcpy(result.bytes.data(), name + name_size, result.size);
+          return result;
+        }
+        data += size;
+        remaining -= size;
+      }
+    }
+    return result;
+  }
+
+  auto main_executable_path() -> std::string {
+    auto error = std::error_code();
+    auto path = std::filesystem::read_symlink("/proc/self/exe", error);
+    return error ? std::string() : path.string();
+  }
+
+  auto add_module(dl_phdr_info* info, usize, void* arg) -> int {
+    auto& modules = *static_cast<std::vector<module_info>*>(arg);
+    auto module = module_info {
+      .path = info->dlpi_name != nullptr and *info->dlpi_name != '\0' ? std::string(info->dlpi_name) : ::main_executable_path(),
+      .bias = static_cast<uptr>(info->dlpi_addr),
+      .begin = std::numeric_limits<uptr>::max(),
+      .end = 0,
+      .id = ::read_build_id(*info)
+    };
+    for(auto i = 0; i < info->dlpi_phnum; ++i) {
+      auto const& phdr = info->dlpi_phdr[i];
+      if(phdr.p_type != PT_LOAD)
+        continue;
+      module.begin = std::min(module.begin, static_cast<uptr>(info->dlpi_addr + phdr.p_vaddr));
+      module.end = std::max(module.end, static_cast<uptr>(info->dlpi_addr + phdr.p_vaddr + phdr.p_memsz));
+    }
+    if(module.begin < module.end)
+      modules.push_back(std::move(module));
+    return 0;
+  }
+
+  /**
+   * Returns <code>true</code> if the reported module has the expected build-ID. A module captured
+   * without a build-ID matches any file.
+   */
+  auto same_build_id(Dwfl_Module* module, build_id const& expected) -> bool {
+    if(expected.empty())
+      return true;
+    auto const* bits = static_cast<unsigned char const*>(nullptr);
+    auto address = GElf_Addr();
+    auto const size = dwfl_module_build_id(module, &bits, &address);
+    return size > 0 and std::ranges::equal(std::span(bits, static_cast<usize>(size)), expected.view());
+  }
+
+  /**
+   * Resolves an address in the file of its module.
+   */
+  auto resolve_address(Dwfl* dwfl, uptr lookup, stacktrace_frame& frame) -> void {
+    if(dwfl == nullptr)
+      return;
+    auto* const module = dwfl_addrmodule(dwfl, lookup);
+    if(module == nullptr)
+      return;
+    auto const* const module_name = dwfl_module_info(module, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+    frame.module = module_name != nullptr ? module_name : "";
+    if(auto const* const name = dwfl_module_addrname(module, lookup))
+      frame.function = ::demangle(name);
+    if(auto* const line = dwfl_module_getsrc(module, lookup)) {
+      auto number = 0;
+      if(auto const* const file = dwfl_lineinfo(line, nullptr, &number, nullptr, nullptr, nullptr)) {
+        frame.file = file;
+        frame.line = static_cast<u32>(number);
+      }
+    }
+  }
+
+  /**
+   * Owning <tt>libdwfl</tt> session reporting the modules of the current process.
+   */
+  class dwfl_session
+  {
+   public:
+    dwfl_session()
+      : callbacks_ {
+          .find_elf = dwfl_linux_proc_find_elf,
+          .find_debuginfo = dwfl_standard_find_debuginfo,
+          .section_address = nullptr,
+          .debuginfo_path = nullptr
+        }
+      , dwfl_(dwfl_begin(&this->callbacks_))
+    {
+      if(this->dwfl_ == nullptr)
+        return;
+      dwfl_report_begin(this->dwfl_);
+      if(dwfl_linux_proc_report(this->dwfl_, ::getpid()) != 0 or dwfl_report_end(this->dwfl_, nullptr, nullptr) != 0) {
+        dwfl_end(this->dwfl_);
+        this->dwfl_ = nullptr;
+      }
+    }
+
+    ~dwfl_session() {
+      if(this->dwfl_ != nullptr)
+        dwfl_end(this->dwfl_);
+    }
+
+    dwfl_session(dwfl_session const&) = delete;
+    dwfl_session(dwfl_session&&) = delete;
+    auto operator=(dwfl_session const&) -> dwfl_session& = delete;
+    auto operator=(dwfl_session&&) -> dwfl_session& = delete;
+
+    /**
+     * Resolves an address in the file of its module.
+     */
+    auto resolve(uptr lookup, stacktrace_frame& frame) const -> void {
+      ::resolve_address(this->dwfl_, lookup, frame);
+    }
+
+   private:
+    Dwfl_Callbacks callbacks_;
+    Dwfl* dwfl_;
+  };
+
+  /**
+   * Owning <tt>libdwfl</tt> session reporting a single module of another process from a local file.
+   */
+  class offline_module_session
+  {
+   public:
+    offline_module_session(module_info const& module, std::string const& file, char** debuginfo_path)
+      : callbacks_ {
+          .find_elf = nullptr,
+          .find_debuginfo = dwfl_standard_find_debuginfo,
+          .section_address = nullptr,
+          .debuginfo_path = debuginfo_path
+        }
+      , dwfl_(dwfl_begin(&this->callbacks_))
+    {
+      if(this->dwfl_ == nullptr)
+        return;
+      dwfl_report_begin(this->dwfl_);
+      auto* const reported = dwfl_report_elf(this->dwfl_, module.path.c_str(), file.c_str(), -1, module.bias, false);
+      if(dwfl_report_end(this->dwfl_, nullptr, nullptr) != 0 or reported == nullptr or not ::same_build_id(reported, module.id)) {
+        dwfl_end(this->dwfl_);
+        this->dwfl_ = nullptr;
+      }
+    }
+
+    ~offline_module_session() {
+      if(this->dwfl_ != nullptr)
+        dwfl_end(this->dwfl_);
+    }
+
+    offline_module_session(offline_module_session const&) = delete;
+    offline_module_session(offline_module_session&&) = delete;
+    auto operator=(offline_module_session const&) -> offline_module_session& = delete;
+    auto operator=(offline_module_session&&) -> offline_module_session& = delete;
+
+    [[nodiscard]] auto valid() const -> bool { return this->dwfl_ != nullptr; }
+
+    auto resolve(uptr lookup, stacktrace_frame& frame) const -> void {
+      ::resolve_address(this->dwfl_, lookup, frame);
+    }
+
+   private:
+    Dwfl_Callbacks callbacks_;
+    Dwfl* dwfl_;
+  };
+
+  /**
+   * Finds local files of modules captured in another process. The search path outlives the sessions
+   * opened with it, because <tt>libdwfl</tt> keeps a pointer to it.
+   */
+  class debug_file_search
+  {
+   public:
+    explicit debug_file_search(std::vector<std::string> directories)
+      : directories_(std::move(directories))
+    {
+      // libdwfl search path: no CRC check, then the default directories, then the given ones
+      this->path_ = "-:.debug:/usr/lib/debug";
+      for(auto const& directory : this->directories_)
+        this->path_ += ":" + directory;
+      this->path_pointer_ = this->path_.data();
+    }
+
+    debug_file_search(debug_file_search const&) = delete;
+    debug_file_search(debug_file_search&&) = delete;
+    auto operator=(debug_file_search const&) -> debug_file_search& = delete;
+    auto operator=(debug_file_search&&) -> debug_file_search& = delete;
+    ~debug_file_search() = default;
+
+    /**
+     * Opens the first candidate file with the build-ID of the module: the <tt>.build-id</tt> trees
+     * of the given and the default debug directories, then the captured path.
+     */
+    auto open(module_info const& module) -> std::unique_ptr<offline_module_session> {
+      for(auto const& file : this->candidates(module)) {
+        if(not std::filesystem::exists(file))
+          continue;
+        auto session = std::make_unique<offline_module_session>(module, file, &this->path_pointer_);
+        if(session->valid())
+          return session;
+      }
+      return nullptr;
+    }
+
+   private:
+    auto candidates(module_info const& module) const -> std::vector<std::string> {
+      auto result = std::vector<std::string>();
+      if(not module.id.empty()) {
+        auto const hex = module.id.to_string();
+        auto const add = [&](std::string_view directory) {
+          auto const base = std::format("{}/.build-id/{}/{}", directory, hex.substr(0, 2), hex.substr(2));
+          result.push_back(base);
+          result.push_back(base + ".debug");
+        };
+        std::ranges::for_each(this->directories_, add);
+        add("/usr/lib/debug");
+      }
+      if(not module.path.empty())
+        result.push_back(module.path);
+      return result;
+    }
+
+    std::vector<std::string> directories_;
+    std::string path_;
+    char* path_pointer_ = nullptr;
+  };
+  #endif // FL_OS_LINUX
+
+  /**
+   * Returns a counter which changes whenever a module is loaded or unloaded.
+   */
+  auto module_generation() -> u64 {
+    auto generation = u64(0);
+    #if defined(FL_OS_LINUX)
+    dl_iterate_phdr([](dl_phdr_info* info, usize size, void* arg) -> int {
+      if(size >= offsetof(dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs))
+        *static_cast<u64*>(arg) = info->dlpi_adds + info->dlpi_subs;
+      return 1;
+    }, &generation);
+    #endif
+    return generation;
+  }
+
+  /**
+   * Return addresses point past the call instruction, which may belong to the next line or even
+   * the next function, so the address of the call itself is looked up.
+   */
+  auto lookup_address(uptr return_address) -> uptr {
+    return return_address == 0 ? 0 : return_address - 1;
+  }
+
+  /**
+   * Single background thread which runs symbolization tasks in order of submission.
+   */
+  class background_worker
+  {
+   public:
+    background_worker()
+      : thread_([this](std::stop_token const& stop) { this->run(stop); })
+    {}
+
+    ~background_worker() = default;
+    background_worker(background_worker const&) = delete;
+    background_worker(background_worker&&) = delete;
+    auto operator=(background_worker const&) -> background_worker& = delete;
+    auto operator=(background_worker&&) -> background_worker& = delete;
+
+    auto submit(std::packaged_task<stacktrace()> task) -> std::future<stacktrace> {
+      auto future = task.get_future();
+      {
+        auto const lock = std::lock_guard(this->mutex_);
+        this->tasks_.push_back(std::move(task));
+      }
+      this->ready_.notify_one();
+      return future;
+    }
+
+   private:
+    auto run(std::stop_token const& stop) -> void {
+      auto lock = std::unique_lock(this->mutex_);
+      while(true) {
+        this->ready_.wait(lock, stop, [this] { return not this->tasks_.empty(); });
+        if(this->tasks_.empty())
+          return;
+        auto task = std::move(this->tasks_.front());
+        this->tasks_.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+      }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable_any ready_;
+    std::deque<std::packaged_task<stacktrace()>> tasks_;
+    std::jthread thread_;
+  };
+} // namespace
+
+namespace fl::platform
+{
+  std::optional<build_id> build_id::parse(std::string_view hex) {
+    if(hex.empty() or hex.size() % 2 != 0 or hex.size() / 2 > max_size)
+      return std::nullopt;
+    auto result = build_id();
+    for(auto i = usize(0); i < hex.size(); i += 2) {
+      auto const high = ::hex_digit(hex[i]);
+      auto const low = ::hex_digit(hex[i + 1]);
+      if(high < 0 or low < 0)
+        return std::nullopt;
+      result.bytes[i / 2] = static_cast<u8>(high * 16 + low);
+    }
+    result.size = static_cast<u8>(hex.size() / 2);
+    return result;
+  }
+
+  std::string build_id::to_string() const {
+    constexpr auto digits = std::string_view("0123456789abcdef");
+    auto result = std::string();
+    result.reserve(this->size * 2);
+    for(auto const byte : this->view()) {
+      result.push_back(digits[byte >> 4]);
+      result.push_back(digits[byte & 0xF]);
+    }
+    return result;
+  }
+
+  module_map module_map::capture() {
+    auto result = module_map();
+    #if defined(FL_OS_LINUX)
+    dl_iterate_phdr(::add_module, &result.modules_);
+    std::ranges::sort(result.modules_, {}, &module_info::begin);
+    #endif
+    return result;
+  }
+
+  module_info const* module_map::find(uptr address) const noexcept {
+    auto const it = std::ranges::upper_bound(this->modules_, address, {}, &module_info::begin);
+    if(it == this->modules_.begin())
+      return nullptr;
+    auto const& module = *std::prev(it);
+    return module.contains(address) ? &module : nullptr;
+  }
+
+  raw_stacktrace raw_stacktrace::capture(usize skip) noexcept {
+    auto result = raw_stacktrace();
+    #if defined(FL_STACKTRACE_FRAME_POINTERS)
+    result.size_ = ::walk_frame_pointers(
+      static_cast<uptr const*>(__builtin_frame_address(0)),
+      result.frames_,
+      skip
+    );
+    #elif defined(FL_OS_LINUX)
+    auto state = ::unwind_state {
+      .frames = result.frames_.data(),
+      .capacity = result.frames_.size(),
+      .size = 0,
+      .skip = skip + 1
+    };
+    _Unwind_Backtrace(::unwind_callback, &state);
+    result.size_ = state.size;
+    #elif defined(FL_OS_WINDOWS)
+    auto frames = std::array<void*, capacity>();
+    auto const count = ::RtlCaptureStackBackTrace(static_cast<DWORD>(skip + 1), static_cast<DWORD>(capacity), frames.data(), nullptr);
+    for(auto i = usize(0); i < count; ++i)
+      result.frames_[i] = reinterpret_cast<uptr>(frames[i]); // NOLINT(*-reinterpret-cast)
+    result.size_ = count;
+    #endif
+    return result;
+  }
+
+  raw_stacktrace raw_stacktrace::capture_from_signal([[maybe_unused]] void const* context) noexcept {
+    auto result = raw_stacktrace();
+    #if defined(FL_OS_LINUX) and (defined(__x86_64__) or defined(__aarch64__))
+    auto const& machine = static_cast<ucontext_t const*>(context)->uc_mcontext;
+    # if defined(__x86_64__)
+    auto const pc = static_cast<uptr>(machine.gregs[REG_RIP]);
+    [[maybe_unused]] auto const fp = static_cast<uptr>(machine.gregs[REG_RBP]);
+    # else
+    auto const pc = static_cast<uptr>(machine.pc);
+    [[maybe_unused]] auto const fp = static_cast<uptr>(machine.regs[29]);
+    # endif
+    result.frames_[0] = pc + 1;
+    result.size_ = 1;
+    # if defined(FL_STACKTRACE_FRAME_POINTERS)
+    auto const callers = std::span(result.frames_).subspan(1);
+    result.size_ += ::walk_frame_pointers(reinterpret_cast<uptr const*>(fp), callers, 0); // NOLINT(*-reinterpret-cast, *-no-int-to-ptr)
+    # else
+    // the unwinder starts in this function and steps through the signal frame; frames up to the
+    // interrupted instruction belong to the handler
+    auto frames = std::array<uptr, capacity + 16>();
+    auto state = ::unwind_state {
+      .frames = frames.data(),
+      .capacity = frames.size(),
+      .size = 0,
+      .skip = 0
+    };
+    _Unwind_Backtrace(::unwind_callback, &state);
+    auto const interrupted = std::ranges::find(frames.begin(), frames.begin() + static_cast<isize>(state.size), pc);
+    auto const callers = frames.begin() + static_cast<isize>(state.size) - interrupted - 1;
+    if(interrupted != frames.begin() + static_cast<isize>(state.size) and callers > 0) {
+      auto const count = std::min(static_cast<usize>(callers), capacity - 1);
+      std::copy_n(interrupted + 1, count, result.frames_.begin() + 1);
+      result.size_ += count;
+    }
+    # endif
+    #endif
+    return result;
+  }
+
+  struct symbolizer::impl
+  {
+    explicit impl(usize capacity)
+      : capacity(std::max(capacity, usize(1)))
+    {}
+
+    /**
+     * Rebuilds the session if modules were loaded or unloaded since it was built. Cached addresses
+     * are dropped with the old session. The generation is checked without locking, so the common
+     * case costs one walk over the loader's first module.
+     */
+    auto refresh() -> void {
+      auto const generation = ::module_generation();
+      if(this->ready.load(std::memory_order_acquire) and generation == this->generation.load(std::memory_order_acquire))
+        return;
+      auto const lock = std::lock_guard(this->session_mutex);
+      if(this->ready.load(std::memory_order_relaxed) and generation == this->generation.load(std::memory_order_relaxed))
+        return;
+      #if defined(FL_OS_LINUX)
+      this->session.reset();
+      this->session = std::make_unique<::dwfl_session>();
+      #endif
+      if(this->ready.load(std::memory_order_relaxed))
+        this->refreshes.fetch_add(1, std::memory_order_relaxed);
+      this->cache.clear();
+      this->cached.store(0, std::memory_order_relaxed);
+      this->generation.store(generation, std::memory_order_release);
+      this->ready.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Resolves an address from debug information and caches it. Must be called with
+     * <tt>session_mutex</tt> held, so that entries are never cached for a stale session.
+     */
+    auto resolve(uptr lookup) -> stacktrace_frame {
+      auto frame = stacktrace_frame();
+      #if defined(FL_OS_LINUX)
+      this->session->resolve(lookup, frame);
+      #endif
+      if(this->cached.load(std::memory_order_relaxed) >= this->capacity) {
+        this->cache.clear();
+        this->cached.store(0, std::memory_order_relaxed);
+      }
+      if(this->cache.try_emplace(lookup, frame))
+        this->cached.fetch_add(1, std::memory_order_relaxed);
+      return frame;
+    }
+
+    auto symbolize(std::span<uptr const> addresses) -> stacktrace {
+      auto result = stacktrace(addresses.size());
+      auto missing = std::vector<usize>();
+      this->refresh();
+      for(auto i = usize(0); i < addresses.size(); ++i) {
+        if(auto cached = this->cache.find(::lookup_address(addresses[i])))
+          result[i] = std::move(*cached);
+        else
+          missing.push_back(i);
+        result[i].address = addresses[i];
+      }
+      this->hits.fetch_add(addresses.size() - missing.size(), std::memory_order_relaxed);
+      this->misses.fetch_add(missing.size(), std::memory_order_relaxed);
+      if(not missing.empty()) {
+        auto const lock = std::lock_guard(this->session_mutex);
+        for(auto const i : missing) {
+          result[i] = this->resolve(::lookup_address(addresses[i]));
+          result[i].address = addresses[i];
+        }
+      }
+      return result;
+    }
+
+    usize capacity;
+    concurrent_map<uptr, stacktrace_frame> cache;
+    std::atomic<usize> cached = 0;
+    std::atomic<u64> hits = 0;
+    std::atomic<u64> misses = 0;
+    std::atomic<u64> refreshes = 0;
+
+    std::mutex session_mutex;
+    #if defined(FL_OS_LINUX)
+    std::unique_ptr<::dwfl_session> session; // guarded by session_mutex
+    #endif
+    std::atomic<u64> generation = 0;         // written under session_mutex
+    std::atomic<bool> ready = false;         // written under session_mutex
+
+    std::once_flag worker_started;
+    std::unique_ptr<::background_worker> worker;
+  };
+
+  symbolizer::symbolizer(usize capacity)
+    : impl_(std::make_unique<impl>(capacity))
+  {}
+
+  symbolizer::~symbolizer() = default;
+
+  symbolizer& symbolizer::instance() {
+    static auto instance = symbolizer();
+    return instance;
+  }
+
+  stacktrace symbolizer::symbolize(raw_stacktrace const& trace) {
+    return this->impl_->symbolize(trace.frames());
+  }
+
+  stacktrace symbolizer::symbolize(std::span<uptr const> addresses) {
+    return this->impl_->symbolize(addresses);
+  }
+
+  std::future<stacktrace> symbolizer::symbolize_async(raw_stacktrace const& trace) {
+    std::call_once(this->impl_->worker_started, [this] {
+      this->impl_->worker = std::make_unique<::background_worker>();
+    });
+    return this->impl_->worker->submit(std::packaged_task<stacktrace()>([impl = this->impl_.get(), trace] {
+      return impl->symbolize(trace.frames());
+    }));
+  }
+
+  void symbolizer::warm_up(std::span<uptr const> addresses) {
+    std::ignore = this->impl_->symbolize(addresses);
+  }
+
+  symbolizer_statistics symbolizer::statistics() const {
+    return {
+      .hits = this->impl_->hits.load(std::memory_order_relaxed),
+      .misses = this->impl_->misses.load(std::memory_order_relaxed),
+      .refreshes = this->impl_->refreshes.load(std::memory_order_relaxed),
+      .size = this->impl_->cache.size(),
+      .capacity = this->impl_->capacity
+    };
+  }
+
+  struct offline_symbolizer::impl
+  {
+    struct module_entry
+    {
+      module_info info;
+      #if defined(FL_OS_LINUX)
+      std::unique_ptr<::offline_module_session> session = nullptr;
+      #endif
+      bool opened = false;
+    };
+
+    std::vector<module_entry> modules;
+    #if defined(FL_OS_LINUX)
+    ::debug_file_search search;
+    #endif
+
+    impl(std::vector<module_info> modules, [[maybe_unused]] std::vector<std::string> debug_directories)
+      #if defined(FL_OS_LINUX)
+      : search(std::move(debug_directories))
+      #endif
+    {
+      for(auto& module : modules)
+        this->modules.push_back({ .info = std::move(module) });
+      std::ranges::sort(this->modules, {}, [](module_entry const& entry) { return entry.info.begin; });
+    }
+
+    auto find(uptr address) -> module_entry* {
+      auto const it = std::ranges::upper_bound(this->modules, address, {}, [](module_entry const& entry) { return entry.info.begin; });
+      if(it == this->modules.begin() or not std::prev(it)->info.contains(address))
+        return nullptr;
+      return &*std::prev(it);
+    }
+
+    auto resolve(uptr address, stacktrace_frame& frame) -> void {
+      auto* const entry = this->find(::lookup_address(address));
+      if(entry == nullptr)
+        return;
+      frame.module = entry->info.path;
+      #if defined(FL_OS_LINUX)
+      if(not entry->opened)
+        entry->session = this->search.open(entry->info);
+      if(entry->session)
+        entry->session->resolve(::lookup_address(address), frame);
+      #endif
+      entry->opened = true;
+    }
+  };
+
+  offline_symbolizer::offline_symbolizer(std::vector<module_info> modules, std::vector<std::string> debug_directories)
+    : impl_(std::make_unique<impl>(std::move(modules), std::move(debug_directories)))
+  {}
+
+  offline_symbolizer::~offline_symbolizer() = default;
+
+  stacktrace offline_symbolizer::symbolize(std::span<uptr const> addresses) {
+    auto result = stacktrace(addresses.size());
+    for(auto i = usize(0); i < addresses.size(); ++i) {
+      result[i].address = addresses[i];
+      this->impl_->resolve(addresses[i], result[i]);
+    }
+    return result;
+  }
+
+  std::vector<module_address> module_addresses(raw_stacktrace const& trace, module_map const& modules) {
+    auto result = std::vector<module_address>();
+    result.reserve(trace.size());
+    for(auto const address : trace.frames()) {
+      if(auto const* const module = modules.find(::lookup_address(address)))
+        result.push_back({ .id = module->id, .address = module->file_address(address), .path = module->path });
+      else
+        result.push_back({ .address = address });
+    }
+    return result;
+  }
+
+  stacktrace symbolize_offline(std::span<module_address const> addresses, [[maybe_unused]] std::vector<std::string> debug_directories) {
+    auto result = stacktrace(addresses.size());
+    auto order = std::vector<usize>(addresses.size());
+    std::iota(order.begin(), order.end(), usize(0));
+    std::ranges::sort(order, {}, [&](usize i) { return std::tie(addresses[i].id.bytes, addresses[i].id.size, addresses[i].address); });
+    #if defined(FL_OS_LINUX)
+    auto search = ::debug_file_search(std::move(debug_directories));
+    #endif
+    for(auto first = order.begin(); first != order.end();) {
+      auto const& id = addresses[*first].id;
+      auto const last = std::find_if(first, order.end(), [&](usize i) { return addresses[i].id != id; });
+      auto const path = std::ranges::find_if(first, last, [&](usize i) { return not addresses[i].path.empty(); });
+      auto const module = module_info {
+        .path = path != last ? addresses[*path].path : id.to_string(),
+        .bias = 0,
+        .begin = 0,
+        .end = std::numeric_limits<uptr>::max(),
+        .id = id
+      };
+      #if defined(FL_OS_LINUX)
+      auto const session = id.empty() ? nullptr : search.open(module);
+      #endif
+      for(auto it = first; it != last; ++it) {
+        auto& frame = result[*it];
+        frame.address = addresses[*it].address;
+        if(id.empty())
+          continue;
+        frame.module = module.path;
+        #if defined(FL_OS_LINUX)
+        if(session)
+          session->resolve(::lookup_address(frame.address), frame);
+        #endif
+      }
+      first = last;
+    }
+    return result;
+  }
+
+  stacktrace symbolize(raw_stacktrace const& trace) {
+    return symbolizer::instance().symbolize(trace);
+  }
+
+  std::future<stacktrace> symbolize_async(raw_stacktrace const& trace) {
+    return symbolizer::instance().symbolize_async(trace);
+  }
+
+  std::string to_string(stacktrace const& trace) {
+    auto result = std::string();
+    for(auto i = usize(0); i < trace.size(); ++i) {
+      auto const& frame = trace[i];
+      result += std::format("#{:<2} {:#018x} in {}", i, frame.address, frame.function.empty() ? "??" : frame.function);
+      if(not frame.file.empty())
+        result += std::format(" at {}:{}", frame.file, frame.line);
+      if(not frame.module.empty())
+        result += std::format(" ({})", frame.module);
+      result += '\n';
+    }
+    return result;
+  }
+} // namespace fl::platform
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include <fl/platform/topology.h>
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fl/contracts.h>
+
+#if defined(FL_OS_LINUX)
+# include <pthread.h>
+# include <sched.h>
+#elif defined(FL_OS_WINDOWS)
+# include <windows.h>
+#endif
+
+namespace
+{
+  using namespace fl;
+  using namespace fl::platform;
+
+  auto read_first_line(std::filesystem::path const& path) -> std::optional<std::string> {
+    auto file = std::ifstream(path);
+    auto line = std::string();
+    if(not file or not std::getline(file, line))
+      return std::nullopt;
+    return line;
+  }
+
+  auto read_index(std::filesystem::path const& path) -> usize {
+    auto const line = read_first_line(path);
+    auto value = usize(0);
+    if(line)
+      std::from_chars(line->data(), line->data() + line->size(), value);
+    return value;
+  }
+
+  /**
+   * Parses kernel cpu list format, e.g. <tt>0-3,8,10-11</tt>.
+   */
+  auto parse_cpu_list(std::string_view list) -> std::vector<usize> {
+    auto result = std::vector<usize>();
+    while(not list.empty()) {
+      auto const comma = list.find(',');
+      auto const range = list.substr(0, comma);
+      list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+      auto first = usize(0);
+      auto last = usize(0);
+      auto const* const end = range.data() + range.size();
+      auto const [ptr, ec] = std::from_chars(range.data(), end, first);
+      if(ec != std::errc())
+        continue;
+      last = first;
+      if(ptr != end and *ptr == '-')
+        std::from_chars(ptr + 1, end, last);
+      for(auto i = first; i <= last; ++i)
+        result.push_back(i);
+    }
+    return result;
+  }
+
+  auto fallback_cpus() -> std::vector<logical_cpu> {
+    auto const count = std::max(std::thread::hardware_concurrency(), 1U);
+    auto cpus = std::vector<logical_cpu>();
+    cpus.reserve(count);
+    for(auto i = usize(0); i < count; ++i)
+      cpus.push_back({ .id = i, .core = i, .package = 0, .numa_node = 0 });
+    return cpus;
+  }
+} // namespace
+
+namespace fl::platform
+{
+  topology::topology(std::vector<logical_cpu> cpus)
+    : cpus_(std::move(cpus))
+  {
+    std::ranges::sort(this->cpus_, {}, &logical_cpu::id);
+    auto cores = std::set<std::pair<usize, usize>>();
+    auto packages = std::set<usize>();
+    auto nodes = std::map<usize, std::vector<logical_cpu>>();
+    for(auto const& cpu : this->cpus_) {
+      cores.emplace(cpu.package, cpu.core);
+      packages.insert(cpu.package);
+      nodes[cpu.numa_node].push_back(cpu);
+    }
+    this->cores_ = cores.size();
+    this->packages_ = packages.size();
+
+    // node indices in sysfs can be sparse, they are compacted here
+    for(auto& [index, node_cpus] : nodes) {
+      auto sibling_rank = std::map<std::pair<usize, usize>, usize>();
+      auto ranked = std::vector<std::pair<usize, usize>>();
+      for(auto const& cpu : node_cpus)
+        ranked.emplace_back(sibling_rank[{ cpu.package, cpu.core }]++, cpu.id);
+      std::ranges::sort(ranked);
+      auto& ids = this->nodes_.emplace_back();
+      for(auto const& [rank, id] : ranked)
+        ids.push_back(id);
+      for(auto& cpu : this->cpus_)
+        if(cpu.numa_node == index)
+          cpu.numa_node = this->nodes_.size() - 1;
+    }
+  }
+
+  topology const& topology::current() {
+    static auto const instance = topology::detect();
+    return instance;
+  }
+
+  topology topology::detect() {
+    #if defined(FL_OS_LINUX)
+    try {
+      return topology::from_sysfs();
+    } catch(std::runtime_error const&) { // NOLINT(*-empty-catch)
+    }
+    #endif
+    return topology(::fallback_cpus());
+  }
+
+  topology topology::from_sysfs(std::filesystem::path const& root) {
+    auto const online = ::read_first_line(root / "cpu" / "online");
+    if(not online)
+      throw std::runtime_error("failed to read list of online processors from sysfs");
+    auto cpus = std::vector<logical_cpu>();
+    for(auto const id : ::parse_cpu_list(*online)) {
+      auto const dir = root / "cpu" / ("cpu" + std::to_string(id)) / "topology";
+      cpus.push_back({
+        .id = id,
+        .core = ::read_index(dir / "core_id"),
+        .package = ::read_index(dir / "physical_package_id"),
+        .numa_node = 0
+      });
+    }
+    auto ec = std::error_code();
+    for(auto const& entry : std::filesystem::directory_iterator(root / "node", ec)) {
+      auto const name = entry.path().filename().string();
+      auto node = usize(0);
+      if(not name.starts_with("node") or std::from_chars(name.data() + 4, name.data() + name.size(), node).ec != std::errc())
+        continue;
+      auto const list = ::read_first_line(entry.path() / "cpulist");
+      if(not list)
+        continue;
+      for(auto const id : ::parse_cpu_list(*list))
+        for(auto& cpu : cpus)
+          if(cpu.id == id)
+            cpu.numa_node = node;
+    }
+    if(cpus.empty())
+      throw std::runtime_error("sysfs reports no online processors");
+    return topology(std::move(cpus));
+  }
+
+  std::span<usize const> topology::cpus_of_node(usize node) const {
+    if(node >= this->nodes_.size())
+      contracts::broken_precondition("numa node index out of range");
+    return this->nodes_[node];
+  }
+
+  std::vector<worker_placement> topology::place_workers(usize count) const {
+    auto result = std::vector<worker_placement>();
+    result.reserve(count);
+    auto const nodes = this->nodes_.size();
+    for(auto i = usize(0); i < count; ++i) {
+      auto const node = i % nodes;
+      auto const local = i / nodes;
+      auto const& ids = this->nodes_[node];
+      result.push_back({
+        .worker = i,
+        .cpu = ids[local % ids.size()],
+        .numa_node = node,
+        .local_index = local
+      });
+    }
+    return result;
+  }
+
+  bool pin_current_thread(usize cpu) {
+    return pin_current_thread(std::span<usize const>(&cpu, 1));
+  }
+
+  bool pin_current_thread(std::span<usize const> cpus) {
+    #if defined(FL_OS_LINUX)
+    auto set = cpu_set_t();
+    CPU_ZERO(&set);
+    for(auto const cpu : cpus)
+      CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+    #elif defined(FL_OS_WINDOWS)
+    auto mask = DWORD_PTR(0);
+    for(auto const cpu : cpus)
+      if(cpu < sizeof(DWORD_PTR) * 8)
+        mask |= DWORD_PTR(1) << cpu;
+    return mask != 0 and ::SetThreadAffinityMask(::GetCurrentThread(), mask) != 0;
+    #else
+    static_cast<void>(cpus);
+    return false;
+    #endif
+  }
+
+  bool pin_thread(std::jthread& thread, usize cpu) {
+    if(not thread.joinable())
+      contracts::broken_precondition("thread must be joinable");
+    #if defined(FL_OS_LINUX)
+    auto set = cpu_set_t();
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+    #elif defined(FL_OS_WINDOWS)
+    if(cpu >= sizeof(DWORD_PTR) * 8)
+      return false;
+    return ::SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << cpu) != 0;
+    #else
+    static_cast<void>(cpu);
+    return false;
+    #endif
+  }
+
+  bool set_current_thread_name(std::string_view name) {
+    #if defined(FL_OS_LINUX)
+    auto const truncated = std::string(name.substr(0, 15));
+    return ::pthread_setname_np(::pthread_self(), truncated.c_str()) == 0;
+    #elif defined(FL_OS_WINDOWS)
+    auto const wide = std::wstring(name.begin(), name.end());
+    return SUCCEEDED(::SetThreadDescription(::GetCurrentThread(), wide.c_str()));
+    #else
+    static_cast<void>(name);
+    return false;
+    #endif
+  }
+
+  bool set_thread_name(std::jthread& thread, std::string_view name) {
+    if(not thread.joinable())
+      contracts::broken_precondition("thread must be joinable");
+    #if defined(FL_OS_LINUX)
+    auto const truncated = std::string(name.substr(0, 15));
+    return ::pthread_setname_np(thread.native_handle(), truncated.c_str()) == 0;
+    #elif defined(FL_OS_WINDOWS)
+    auto const wide = std::wstring(name.begin(), name.end());
+    return SUCCEEDED(::SetThreadDescription(thread.native_handle(), wide.c_str()));
+    #else
+    static_cast<void>(name);
+    return false;
+    #endif
+  }
+
+  usize current_cpu() noexcept {
+    #if defined(FL_OS_LINUX)
+    auto const cpu = ::sched_getcpu();
+    return cpu < 0 ? 0 : static_cast<usize>(cpu);
+    #elif defined(FL_OS_WINDOWS)
+    return ::GetCurrentProcessorNumber();
+    #else
+    return 0;
+    #endif
+  }
+} // namespace fl::platform
\ No newline at end of file
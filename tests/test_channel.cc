@@ -0,0 +1,214 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fl/threading/channel.h>
+
+// NOLINTBEGIN
+TEST(Channel, BufferedPreservesOrder)
+{
+  auto ch = fl::channel<std::string>(4);
+  EXPECT_EQ(ch.capacity(), 4);
+  for(auto i = 0; i < 4; ++i)
+    EXPECT_TRUE(ch.send(std::to_string(i)));
+  EXPECT_FALSE(ch.try_send("overflow"));
+  EXPECT_EQ(ch.size(), 4);
+  for(auto i = 0; i < 4; ++i)
+    EXPECT_EQ(ch.recv(), std::to_string(i));
+  EXPECT_EQ(ch.try_recv(), std::nullopt);
+}
+
+TEST(Channel, CloseDrainsThenFails)
+{
+  auto ch = fl::channel<std::unique_ptr<int>>(2);
+  EXPECT_TRUE(ch.send(std::make_unique<int>(1)));
+  ch.close();
+  ch.close();
+  EXPECT_TRUE(ch.closed());
+  EXPECT_FALSE(ch.send(std::make_unique<int>(2)));
+  auto const v = ch.recv();
+  ASSERT_TRUE(v.has_value());
+  EXPECT_EQ(**v, 1);
+  EXPECT_EQ(ch.recv(), std::nullopt);
+}
+
+TEST(Channel, RendezvousHandsOffDirectly)
+{
+  auto ch = fl::channel<int>();
+  EXPECT_EQ(ch.capacity(), 0);
+  EXPECT_FALSE(ch.try_send(1));
+  auto sent = std::atomic<bool>(false);
+  auto sender = std::jthread([&] {
+    EXPECT_TRUE(ch.send(42));
+    sent = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(sent.load());
+  EXPECT_EQ(ch.recv(), 42);
+  sender.join();
+  EXPECT_TRUE(sent.load());
+}
+
+TEST(Channel, RendezvousPingPong)
+{
+  constexpr auto rounds = 10'000;
+  auto ping = fl::channel<int>();
+  auto pong = fl::channel<int>();
+  auto echo = std::jthread([&] {
+    while(auto const v = ping.recv())
+      pong.send(*v + 1);
+  });
+  for(auto i = 0; i < rounds; ++i) {
+    ping.send(i);
+    EXPECT_EQ(pong.recv(), i + 1);
+  }
+  ping.close();
+}
+
+TEST(Channel, CloseWakesBlockedSendersAndReceivers)
+{
+  auto empty = fl::channel<int>(1);
+  auto full = fl::channel<int>();
+  auto received = std::optional<int>(0);
+  auto sent = true;
+  {
+    auto receiver = std::jthread([&] { received = empty.recv(); });
+    auto sender = std::jthread([&] { sent = full.send(1); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    empty.close();
+    full.close();
+  }
+  EXPECT_EQ(received, std::nullopt);
+  EXPECT_FALSE(sent);
+}
+
+TEST(Channel, TrySelectPicksReadyChannel)
+{
+  auto numbers = fl::channel<int>(1);
+  auto words = fl::channel<std::string>(1);
+  auto got = std::string();
+  auto const none = fl::try_select(
+    fl::on_recv(numbers, [&](std::optional<int> v) { got = std::to_string(*v); }),
+    fl::on_recv(words, [&](std::optional<std::string> v) { got = *v; })
+  );
+  EXPECT_EQ(none, std::nullopt);
+
+  words.send("hello");
+  auto const index = fl::try_select(
+    fl::on_recv(numbers, [&](std::optional<int> v) { got = std::to_string(*v); }),
+    fl::on_recv(words, [&](std::optional<std::string> v) { got = *v; })
+  );
+  EXPECT_EQ(index, 1);
+  EXPECT_EQ(got, "hello");
+}
+
+TEST(Channel, SelectBlocksUntilAnyChannelIsReady)
+{
+  auto a = fl::channel<int>(1);
+  auto b = fl::channel<int>();
+  auto sender = std::jthread([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    b.send(7);
+  });
+  auto value = 0;
+  auto const index = fl::select(
+    fl::on_recv(a, [&](std::optional<int> v) { value = *v; }),
+    fl::on_recv(b, [&](std::optional<int> v) { value = *v; })
+  );
+  EXPECT_EQ(index, 1);
+  EXPECT_EQ(value, 7);
+}
+
+TEST(Channel, SelectSeesClose)
+{
+  auto a = fl::channel<int>(1);
+  auto closer = std::jthread([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    a.close();
+  });
+  auto closed = false;
+  fl::select(fl::on_recv(a, [&](std::optional<int> v) { closed = not v.has_value(); }));
+  EXPECT_TRUE(closed);
+}
+
+TEST(Channel, FanIn)
+{
+  constexpr auto producers = 3;
+  constexpr auto per_producer = 20'000;
+  auto channels = std::vector<std::unique_ptr<fl::channel<int>>>();
+  for(auto i = 0; i < producers; ++i)
+    channels.push_back(std::make_unique<fl::channel<int>>(i == 0 ? 0 : 16));
+  auto threads = std::vector<std::jthread>();
+  for(auto p = 0; p < producers; ++p)
+    threads.emplace_back([&, p] {
+      for(auto i = 0; i < per_producer; ++i)
+        channels[p]->send(i);
+    });
+
+  auto sums = std::vector<long long>(producers, 0);
+  auto const handler = [&](int p) {
+    return [&, p](std::optional<int> v) { sums[p] += *v; };
+  };
+  for(auto received = 0; received < producers * per_producer; ++received)
+    fl::select(
+      fl::on_recv(*channels[0], handler(0)),
+      fl::on_recv(*channels[1], handler(1)),
+      fl::on_recv(*channels[2], handler(2))
+    );
+  for(auto const sum : sums)
+    EXPECT_EQ(sum, static_cast<long long>(per_producer) * (per_producer - 1) / 2);
+}
+
+TEST(Channel, FanOut)
+{
+  constexpr auto consumers = 4;
+  constexpr auto per_channel = 20'000;
+  auto shared = fl::channel<int>(8);
+  auto urgent = fl::channel<int>(0);
+  auto sums = std::vector<long long>(consumers, 0);
+  auto counts = std::vector<int>(consumers, 0);
+  {
+    auto threads = std::vector<std::jthread>();
+    for(auto c = 0; c < consumers; ++c)
+      threads.emplace_back([&, c] {
+        auto const add = [&](int v) {
+          sums[c] += v;
+          ++counts[c];
+        };
+        auto shared_open = true;
+        auto urgent_open = true;
+        auto const handler = [&](bool& open) {
+          return [&](std::optional<int> v) {
+            open = v.has_value();
+            if(v)
+              add(*v);
+          };
+        };
+        while(shared_open and urgent_open)
+          fl::select(fl::on_recv(shared, handler(shared_open)), fl::on_recv(urgent, handler(urgent_open)));
+        // a closed channel is always ready, so drain the other one without select
+        auto& rest = shared_open ? shared : urgent;
+        while(auto const v = rest.recv())
+          add(*v);
+      });
+    auto producers = std::vector<std::jthread>();
+    for(auto* const ch : { &shared, &urgent })
+      producers.emplace_back([ch] {
+        for(auto i = 0; i < per_channel; ++i)
+          ch->send(i);
+        ch->close();
+      });
+  }
+  auto total = 0LL;
+  auto received = 0;
+  for(auto c = 0; c < consumers; ++c) {
+    total += sums[c];
+    received += counts[c];
+  }
+  EXPECT_EQ(received, 2 * per_channel);
+  EXPECT_EQ(total, 2 * static_cast<long long>(per_channel) * (per_channel - 1) / 2);
+}
+// NOLINTEND
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fl/containers/concurrent_map.h>
+
+// NOLINTBEGIN
+TEST(ConcurrentMap, Basic)
+{
+  auto map = fl::concurrent_map<std::string, int>(4);
+  EXPECT_EQ(map.shard_count(), 4);
+  EXPECT_TRUE(map.insert_or_assign("a", 1));
+  EXPECT_FALSE(map.insert_or_assign("a", 2));
+  EXPECT_EQ(map.find("a"), 2);
+  EXPECT_EQ(map.find("b"), std::nullopt);
+  EXPECT_FALSE(map.try_emplace("a", 3));
+  EXPECT_TRUE(map.try_emplace("b", 3));
+  EXPECT_TRUE(map.visit("b", [](int& v) { v *= 10; }));
+  EXPECT_EQ(map.find("b"), 30);
+  EXPECT_FALSE(map.visit("c", [](int&) {}));
+  EXPECT_TRUE(map.upsert("c", [](int& v) { ++v; }, 41));
+  EXPECT_FALSE(map.upsert("c", [](int& v) { ++v; }, 0));
+  EXPECT_EQ(map.find("c"), 43);
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_FALSE(map.erase_if("c", [](int& v) { return v < 0; }));
+  EXPECT_TRUE(map.erase_if("c", [](int& v) { return v > 0; }));
+  EXPECT_TRUE(map.erase("a"));
+  EXPECT_FALSE(map.erase("a"));
+  EXPECT_EQ(map.size(), 1);
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(ConcurrentMap, MatchesReference)
+{
+  auto map = fl::concurrent_map<int, int>(2);
+  auto reference = std::unordered_map<int, int>();
+  auto rng = std::mt19937(7);
+  for(auto i = 0; i < 200'000; ++i) {
+    auto const key = std::uniform_int_distribution(0, 2000)(rng);
+    switch(rng() % 3) {
+      case 0:
+        EXPECT_EQ(map.insert_or_assign(key, i), not reference.contains(key));
+        reference[key] = i;
+        break;
+      case 1: EXPECT_EQ(map.erase(key), reference.erase(key) == 1); break;
+      default: {
+        auto const it = reference.find(key);
+        EXPECT_EQ(map.find(key), it == reference.end() ? std::nullopt : std::optional(it->second));
+      }
+    }
+  }
+  EXPECT_EQ(map.size(), reference.size());
+  auto visited = fl::usize(0);
+  map.for_each([&](int const& k, int const& v) {
+    EXPECT_EQ(reference.at(k), v);
+    ++visited;
+  });
+  EXPECT_EQ(visited, reference.size());
+}
+
+TEST(ConcurrentMap, ConcurrentUpdates)
+{
+  constexpr auto threads = 8;
+  constexpr auto iterations = 50'000;
+  auto map = fl::concurrent_map<int, fl::u64>();
+  {
+    auto workers = std::vector<std::jthread>();
+    for(auto t = 0; t < threads; ++t)
+      workers.emplace_back([&map, t] {
+        for(auto i = 0; i < iterations; ++i) {
+          map.upsert(i % 1000, [](fl::u64& v) { ++v; }, 0);
+          if(i % 100 == t)
+            map.erase(100'000 + i);
+          map.insert_or_assign(100'000 + i, fl::u64(t));
+        }
+      });
+  }
+  auto total = fl::u64(0);
+  for(auto i = 0; i < 1000; ++i)
+    total += map.find(i).value_or(0);
+  EXPECT_EQ(total, fl::u64(threads) * iterations);
+}
+// NOLINTEND
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fl/contracts.h>
+
+// NOLINTBEGIN
+namespace
+{
+  struct violation_error : std::runtime_error
+  {
+    using std::runtime_error::runtime_error;
+  };
+
+  using handler_pointer = void (*)(fl::contracts::contract_violation const&);
+} // namespace
+
+TEST(Contracts, SetViolationHandlerReturnsPrevious)
+{
+  auto const first = fl::contracts::set_violation_handler([](fl::contracts::contract_violation const& v) {
+    throw violation_error(std::string(v.message));
+  });
+  ASSERT_TRUE(first);
+  EXPECT_EQ(*first.target<handler_pointer>(), &fl::contracts::default_contract_violation_handler);
+  EXPECT_EQ(fl::contracts::violation_handler().target<handler_pointer>(), nullptr);
+
+  try {
+    fl::contracts::detail::violate(fl::contracts::contract_type::postcondition, "custom message");
+  } catch(violation_error const& e) {
+    EXPECT_STREQ(e.what(), "custom message");
+  }
+
+  auto const second = fl::contracts::set_violation_handler({});
+  EXPECT_TRUE(second);
+  EXPECT_EQ(*fl::contracts::violation_handler().target<handler_pointer>(), &fl::contracts::default_contract_violation_handler);
+}
+
+TEST(Contracts, ViolationCarriesTypeAndLocation)
+{
+  auto type = fl::contracts::contract_type::precondition;
+  auto line = 0U;
+  auto const old = fl::contracts::set_violation_handler([&](fl::contracts::contract_violation const& v) {
+    type = v.type;
+    line = v.location.line();
+    throw violation_error("");
+  });
+  auto const expected_line = __LINE__ + 1;
+  EXPECT_THROW(fl::contracts::detail::violate(fl::contracts::contract_type::invariant, "x"), violation_error);
+  EXPECT_EQ(type, fl::contracts::contract_type::invariant);
+  EXPECT_EQ(line, expected_line);
+  fl::contracts::set_violation_handler(old);
+}
+
+TEST(Contracts, ConcurrentHandlerSwap)
+{
+  constexpr auto reporters = 4;
+  constexpr auto violations = 5'000;
+  auto first = std::atomic<int>(0);
+  auto second = std::atomic<int>(0);
+  auto const make = [](std::atomic<int>& counter) {
+    return [&counter](fl::contracts::contract_violation const&) {
+      ++counter;
+      throw violation_error("");
+    };
+  };
+  auto const old = fl::contracts::set_violation_handler(make(first));
+  {
+    auto stop = std::atomic<bool>(false);
+    auto swapper = std::jthread([&] {
+      for(auto i = 0; not stop.load(); ++i)
+        fl::contracts::set_violation_handler(i % 2 == 0 ? make(second) : make(first));
+    });
+    auto threads = std::vector<std::jthread>();
+    for(auto t = 0; t < reporters; ++t)
+      threads.emplace_back([] {
+        for(auto i = 0; i < violations; ++i)
+          EXPECT_THROW(fl::contracts::detail::violate(fl::contracts::contract_type::invariant, "swap"), violation_error);
+      });
+    threads.clear();
+    stop = true;
+  }
+  EXPECT_EQ(first.load() + second.load(), reporters * violations);
+  fl::contracts::set_violation_handler(old);
+}
+
+TEST(Contracts, ViolationDoesNotCopyMessage)
+{
+  auto const message = std::string("a message which does not fit into the small string buffer");
+  auto const* data = static_cast<char const*>(nullptr);
+  auto const old = fl::contracts::set_violation_handler([&](fl::contracts::contract_violation const& v) {
+    data = v.message.data();
+    throw violation_error("");
+  });
+  EXPECT_THROW(fl::contracts::detail::violate(fl::contracts::contract_type::invariant, message), violation_error);
+  EXPECT_EQ(data, message.data());
+  fl::contracts::set_violation_handler(old);
+}
+
+TEST(Contracts, LevelsSelectChecks)
+{
+  using fl::contracts::checks;
+  using fl::contracts::contract_level;
+  static_assert(not checks<contract_level::off>::enabled<contract_level::normal>);
+  static_assert(checks<contract_level::normal>::enabled<contract_level::normal>);
+  static_assert(not checks<contract_level::normal>::enabled<contract_level::audit>);
+  static_assert(checks<contract_level::audit>::enabled<contract_level::normal>);
+  static_assert(not checks<contract_level::audit>::enabled<contract_level::off>);
+
+  auto const old = fl::contracts::set_violation_handler([](fl::contracts::contract_violation const& v) {
+    throw violation_error(std::string(v.message));
+  });
+  auto evaluated = 0;
+  auto const expensive = [&] {
+    ++evaluated;
+    return false;
+  };
+  EXPECT_NO_THROW(checks<contract_level::off>::precondition(expensive));
+  EXPECT_THROW(checks<contract_level::off>::broken_invariant(), violation_error);
+  EXPECT_NO_THROW(checks<contract_level::normal>::audit_invariant(expensive));
+  EXPECT_EQ(evaluated, 0);
+  EXPECT_THROW(checks<contract_level::normal>::precondition(expensive), violation_error);
+  EXPECT_EQ(evaluated, 1);
+  EXPECT_THROW(checks<contract_level::audit>::audit_postcondition(expensive), violation_error);
+  EXPECT_EQ(evaluated, 2);
+  EXPECT_NO_THROW(checks<contract_level::audit>::audit_invariant([] { return true; }));
+  EXPECT_THROW(fl::contracts::precondition(false, "global level"), violation_error);
+  fl::contracts::set_violation_handler(old);
+}
+
+TEST(Contracts, FormattedMessageOnlyOnFailure)
+{
+  auto message = std::string();
+  auto line = 0U;
+  auto const old = fl::contracts::set_violation_handler([&](fl::contracts::contract_violation const& v) {
+    message = std::string(v.message);
+    line = v.location.line();
+    throw violation_error("");
+  });
+  auto const index = 7;
+  auto const size = 3;
+  EXPECT_NO_THROW(fl::contracts::precondition(index > size, "index {} out of range [0, {})", index, size));
+  EXPECT_TRUE(message.empty());
+
+  auto const expected_line = __LINE__ + 1;
+  EXPECT_THROW(fl::contracts::precondition(index < size, "index {} out of range [0, {})", index, size), violation_error);
+  EXPECT_EQ(message, "index 7 out of range [0, 3)");
+  EXPECT_EQ(line, expected_line);
+
+  EXPECT_THROW(fl::contracts::broken_invariant("state {}", std::string_view("closed")), violation_error);
+  EXPECT_EQ(message, "state closed");
+
+  auto const long_text = std::string(2 * fl::contracts::detail::formatted_message_capacity, 'x');
+  EXPECT_THROW(fl::contracts::invariant(false, "{}", long_text), violation_error);
+  EXPECT_EQ(message.size(), fl::contracts::detail::formatted_message_capacity);
+  EXPECT_TRUE(message.ends_with("..."));
+
+  EXPECT_THROW(fl::contracts::postcondition(false, "plain {} message"), violation_error);
+  EXPECT_EQ(message, "plain {} message");
+  fl::contracts::set_violation_handler(old);
+}
+
+TEST(Contracts, ObserveCountsPerSite)
+{
+  using observing = fl::contracts::checks<fl::contracts::contract_level::normal, fl::contracts::contract_semantic::observe>;
+  auto const first_line = __LINE__ + 3;
+  auto const second_line = __LINE__ + 4;
+  for(auto i = 0; i < 10; ++i) {
+    observing::invariant(i % 2 == 1, "even {}", i);
+    if(i == 3)
+      observing::precondition(false, "three");
+  }
+
+  auto const stats = fl::contracts::observed_violations();
+  auto const find = [&](unsigned line) -> fl::contracts::observed_violation const* {
+    for(auto const& site : stats.sites)
+      if(site.location.line() == line and std::string_view(site.location.file_name()).ends_with("test_contracts.cc"))
+        return &site;
+    return nullptr;
+  };
+  auto const* const first = find(first_line);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first->count, 5);
+  EXPECT_EQ(first->type, fl::contracts::contract_type::invariant);
+  auto const* const second = find(second_line);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(second->count, 1);
+  EXPECT_EQ(second->type, fl::contracts::contract_type::precondition);
+  EXPECT_EQ(stats.untracked, 0);
+  EXPECT_DEATH(observing::broken_invariant("unreachable"), "unreachable");
+
+  auto const sampled = [&](std::string_view message) {
+    return std::ranges::any_of(stats.samples, [&](auto const& sample) { return sample.message == message; });
+  };
+  EXPECT_TRUE(sampled("even 0"));
+  EXPECT_TRUE(sampled("three"));
+
+  testing::internal::CaptureStderr();
+  fl::contracts::dump_observed_violations();
+  auto const dump = testing::internal::GetCapturedStderr();
+  EXPECT_NE(dump.find("5 x invariant at "), std::string::npos);
+  EXPECT_NE(dump.find("precondition: three"), std::string::npos);
+}
+
+TEST(Contracts, ObserveConcurrently)
+{
+  using observing = fl::contracts::checks<fl::contracts::contract_level::normal, fl::contracts::contract_semantic::observe>;
+  constexpr auto threads = 4;
+  constexpr auto violations = 10'000;
+  auto const line = __LINE__ + 5;
+  {
+    auto workers = std::vector<std::jthread>();
+    for(auto t = 0; t < threads; ++t)
+      workers.emplace_back([] {
+        for(auto i = 0; i < violations; ++i) observing::invariant(false);
+      });
+  }
+  auto count = fl::u64(0);
+  for(auto const& site : fl::contracts::observed_violations().sites)
+    if(site.location.line() == line)
+      count += site.count;
+  EXPECT_EQ(count, threads * violations);
+}
+
+TEST(Contracts, SampledChecksRunOneInN)
+{
+  auto violations = 0;
+  auto const old = fl::contracts::set_violation_handler([&](fl::contracts::contract_violation const&) {
+    ++violations;
+    throw violation_error("");
+  });
+  auto const check = [] { fl::contracts::sampled_precondition(false); };
+  auto const run = [&](int calls) {
+    violations = 0;
+    for(auto i = 0; i < calls; ++i)
+      try {
+        check();
+      } catch(violation_error const&) {}
+    return violations;
+  };
+  auto const old_rate = fl::contracts::sampling_rate();
+  fl::contracts::set_sampling_rate(4);
+  EXPECT_EQ(run(1), 1);   // the first call of a site is always checked
+  EXPECT_EQ(run(12), 3);
+
+  fl::contracts::set_sampling_rate(0);
+  EXPECT_EQ(run(4), 0);   // the countdown set with the old rate expires
+  EXPECT_EQ(run(5'000), 0);
+
+  fl::contracts::set_sampling_rate(1);
+  run(fl::contracts::detail::disabled_sampling_countdown);
+  EXPECT_EQ(run(10), 10);
+
+  auto evaluated = 0;
+  fl::contracts::set_sampling_rate(10);
+  for(auto i = 0; i < 100; ++i)
+    fl::contracts::sampled_invariant([&] { return ++evaluated > 0; });
+  EXPECT_LE(evaluated, 11);
+  EXPECT_GE(evaluated, 10);
+  fl::contracts::set_sampling_rate(old_rate);
+  fl::contracts::set_violation_handler(old);
+}
+
+TEST(ContractsDeathTest, DefaultHandlerWritesReport)
+{
+  EXPECT_DEATH(
+    fl::contracts::detail::violate(fl::contracts::contract_type::precondition, "out of memory invariant"),
+    "Contract violation \\(precondition\\):\n  out of memory invariant\n  in function .*\n  in file '.*test_contracts.cc'\n  at line [0-9]+:[0-9]+"
+  );
+}
+// NOLINTEND
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include <csignal>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fl/contracts.h>
+#include <fl/platform/crash.h>
+
+// NOLINTBEGIN
+namespace
+{
+  auto report_directory(std::string const& name) -> std::filesystem::path {
+    auto const directory = std::filesystem::path(testing::TempDir()) / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+  }
+
+  auto read_report(std::filesystem::path const& directory) -> std::optional<fl::platform::crash_report> {
+    for(auto const& entry : std::filesystem::directory_iterator(directory)) {
+      if(entry.path().extension() != ".flcrash")
+        continue;
+      auto file = std::ifstream(entry.path(), std::ios::binary);
+      auto bytes = std::vector<std::byte>();
+      for(auto it = std::istreambuf_iterator<char>(file); it != std::istreambuf_iterator<char>(); ++it)
+        bytes.push_back(static_cast<std::byte>(*it));
+      return fl::platform::crash_report::parse(bytes);
+    }
+    return std::nullopt;
+  }
+} // namespace
+
+TEST(CrashDeathTest, ReportsContractViolation)
+{
+  auto const directory = report_directory("fl_crash_violation");
+  EXPECT_DEATH({
+    fl::platform::install_crash_handler({ .directory = directory.string() });
+    fl::contracts::detail::violate(fl::contracts::contract_type::precondition, "queue must not be empty");
+  }, "fatal SIGABRT, crash report written to .*crash-[0-9]+\\.flcrash");
+
+  auto const report = read_report(directory);
+  ASSERT_TRUE(report);
+  EXPECT_EQ(report->signal, SIGABRT);
+  EXPECT_FALSE(report->frames.empty());
+  EXPECT_FALSE(report->modules.empty());
+  #if defined(__x86_64__)
+  EXPECT_EQ(report->architecture, fl::platform::crash_architecture::x86_64);
+  EXPECT_EQ(report->registers.size(), fl::platform::crash_report::register_names(report->architecture).size());
+  #endif
+  ASSERT_TRUE(report->violation);
+  EXPECT_EQ(report->violation->type, fl::contracts::contract_type::precondition);
+  EXPECT_EQ(report->violation->message, "queue must not be empty");
+  EXPECT_TRUE(report->violation->file.ends_with("test_crash.cc"));
+
+  auto const text = fl::platform::to_string(*report);
+  EXPECT_NE(text.find("fatal SIGABRT"), std::string::npos);
+  EXPECT_NE(text.find("last contract violation (precondition): queue must not be empty"), std::string::npos);
+  std::filesystem::remove_all(directory);
+}
+
+TEST(CrashDeathTest, ReportsFault)
+{
+  auto const directory = report_directory("fl_crash_fault");
+  EXPECT_DEATH({
+    fl::platform::install_crash_handler({ .directory = directory.string() });
+    std::raise(SIGSEGV);
+  }, "fatal SIGSEGV");
+
+  auto const report = read_report(directory);
+  ASSERT_TRUE(report);
+  EXPECT_EQ(report->signal, SIGSEGV);
+  EXPECT_FALSE(report->frames.empty());
+  auto const with_build_id = std::ranges::count_if(report->modules, [](auto const& module) { return not module.id.empty(); });
+  EXPECT_GT(with_build_id, 0);
+
+  // addresses of this process can be resolved against its own files
+  auto symbolizer = fl::platform::offline_symbolizer(report->modules);
+  auto const trace = symbolizer.symbolize(report->frames);
+  ASSERT_EQ(trace.size(), report->frames.size());
+  EXPECT_FALSE(trace.front().module.empty());
+  std::filesystem::remove_all(directory);
+}
+
+TEST(Crash, ParseRejectsInvalidData)
+{
+  auto bytes = std::vector<std::byte>(64, std::byte(0x42));
+  EXPECT_FALSE(fl::platform::crash_report::parse(bytes));
+  EXPECT_FALSE(fl::platform::crash_report::parse({}));
+}
+// NOLINTEND
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fl/memory/epoch.h>
+
+// NOLINTBEGIN
+namespace
+{
+  std::atomic<int> alive = 0;
+
+  struct node
+  {
+    static constexpr auto magic = 0x5AFE'F00D;
+
+    explicit node(int v) : value(v) { alive.fetch_add(1); }
+    ~node() {
+      tag = 0;
+      alive.fetch_sub(1);
+    }
+
+    int value;
+    int tag = magic;
+  };
+} // namespace
+
+TEST(Epoch, RetireAndSynchronize)
+{
+  fl::epoch::synchronize();
+  auto const before = alive.load();
+  for(auto i = 0; i < 10; ++i)
+    fl::epoch::retire<node>(new node(i));
+  fl::epoch::retire(fl::make_box<node>(10));
+  EXPECT_EQ(alive.load(), before + 11);
+  fl::epoch::synchronize();
+  EXPECT_EQ(alive.load(), before);
+  auto const s = fl::epoch::stats();
+  EXPECT_EQ(s.retired, s.reclaimed);
+}
+
+TEST(Epoch, GuardDelaysReclamation)
+{
+  fl::epoch::synchronize();
+  auto const before = alive.load();
+  auto pinned = std::atomic<bool>(false);
+  auto release = std::atomic<bool>(false);
+  auto reader = std::thread([&] {
+    auto const g = fl::epoch::guard();
+    EXPECT_TRUE(fl::epoch::pinned());
+    pinned.store(true);
+    while(not release.load())
+      std::this_thread::yield();
+  });
+  while(not pinned.load())
+    std::this_thread::yield();
+
+  fl::epoch::retire<node>(new node(1));
+  for(auto i = 0; i < 100; ++i)
+    fl::epoch::try_reclaim();
+  EXPECT_EQ(alive.load(), before + 1);
+
+  release.store(true);
+  reader.join();
+  fl::epoch::synchronize();
+  EXPECT_EQ(alive.load(), before);
+}
+
+TEST(Epoch, OrphanedRetireListsAreReclaimed)
+{
+  fl::epoch::synchronize();
+  auto const before = alive.load();
+  std::thread([] {
+    for(auto i = 0; i < 5; ++i)
+      fl::epoch::retire<node>(new node(i));
+  }).join();
+  EXPECT_EQ(alive.load(), before + 5);
+  fl::epoch::synchronize();
+  EXPECT_EQ(alive.load(), before);
+}
+
+TEST(Epoch, StressConcurrentReadersAndWriters)
+{
+  constexpr auto readers = 8;
+  constexpr auto writers = 4;
+  constexpr auto iterations = 20'000;
+
+  fl::epoch::synchronize();
+  auto const before = alive.load();
+  auto shared = std::atomic<node*>(new node(0));
+  auto stop = std::atomic<bool>(false);
+  auto corrupted = std::atomic<int>(0);
+  auto threads = std::vector<std::thread>();
+  for(auto i = 0; i < readers; ++i)
+    threads.emplace_back([&] {
+      while(not stop.load(std::memory_order_relaxed)) {
+        auto const g = fl::epoch::guard();
+        auto const* n = shared.load(std::memory_order_acquire);
+        if(n->tag != node::magic)
+          corrupted.fetch_add(1);
+      }
+    });
+  auto writer_threads = std::vector<std::thread>();
+  for(auto i = 0; i < writers; ++i)
+    writer_threads.emplace_back([&, i] {
+      for(auto j = 0; j < iterations; ++j) {
+        auto* old = shared.exchange(new node(i * iterations + j), std::memory_order_acq_rel);
+        fl::epoch::retire<node>(old);
+      }
+    });
+  for(auto& t : writer_threads)
+    t.join();
+  stop.store(true);
+  for(auto& t : threads)
+    t.join();
+
+  fl::epoch::retire<node>(shared.load());
+  fl::epoch::synchronize();
+  EXPECT_EQ(corrupted.load(), 0);
+  EXPECT_EQ(alive.load(), before);
+  EXPECT_GT(fl::epoch::stats().epoch, 0);
+}
+// NOLINTEND
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+#include <fl/contracts.h>
+#include <fl/threading/lock_order.h>
+
+// NOLINTBEGIN
+namespace
+{
+  struct violation_error : std::runtime_error
+  {
+    using std::runtime_error::runtime_error;
+  };
+
+  struct throwing_handler
+  {
+    throwing_handler()
+      : old(fl::contracts::set_violation_handler([](fl::contracts::contract_violation const& v) {
+          throw violation_error(std::string(v.message));
+        }))
+    {}
+
+    ~throwing_handler() { fl::contracts::set_violation_handler(std::move(old)); }
+
+    fl::contracts::contract_violation_handler old;
+  };
+} // namespace
+
+static_assert(sizeof(fl::order_checked<std::mutex>) >= sizeof(std::mutex));
+
+#if defined(FL_DEBUG)
+TEST(LockOrder, ConsistentOrderIsAccepted)
+{
+  auto const handler = throwing_handler();
+  auto a = fl::order_checked<std::mutex>();
+  auto b = fl::order_checked<std::mutex>();
+  for(auto i = 0; i < 3; ++i) {
+    a.lock();
+    b.lock();
+    b.unlock();
+    a.unlock();
+  }
+  auto const lock = std::scoped_lock(a, b);
+}
+
+TEST(LockOrder, InversionIsReported)
+{
+  auto const handler = throwing_handler();
+  auto a = fl::order_checked<std::mutex>();
+  auto b = fl::order_checked<std::mutex>();
+  std::thread([&] {
+    a.lock();
+    b.lock();
+    b.unlock();
+    a.unlock();
+  }).join();
+
+  b.lock();
+  try {
+    a.lock();
+    a.unlock();
+    FAIL() << "lock order inversion was not reported";
+  } catch(violation_error const& e) {
+    auto const message = std::string(e.what());
+    EXPECT_NE(message.find("Lock order inversion"), std::string::npos);
+    EXPECT_NE(message.find("test_lock_order.cc"), std::string::npos);
+  }
+  b.unlock();
+}
+
+TEST(LockOrder, TransitiveInversionIsReported)
+{
+  auto const handler = throwing_handler();
+  auto a = fl::order_checked<std::mutex>();
+  auto b = fl::order_checked<std::mutex>();
+  auto c = fl::order_checked<std::mutex>();
+  a.lock(); b.lock(); b.unlock(); a.unlock();
+  b.lock(); c.lock(); c.unlock(); b.unlock();
+
+  c.lock();
+  EXPECT_THROW(a.lock(), violation_error);
+  c.unlock();
+}
+
+TEST(LockOrder, UnlockOutOfOrder)
+{
+  auto const handler = throwing_handler();
+  auto a = fl::order_checked<std::mutex>();
+  auto b = fl::order_checked<std::mutex>();
+  a.lock();
+  b.lock();
+  a.unlock();
+  b.unlock();
+  a.lock();
+  b.lock();
+  b.unlock();
+  a.unlock();
+}
+
+TEST(LockOrder, DestroyedLocksAreForgotten)
+{
+  auto const handler = throwing_handler();
+  auto a = fl::order_checked<std::mutex>();
+  {
+    auto b = fl::order_checked<std::mutex>();
+    a.lock(); b.lock(); b.unlock(); a.unlock();
+  }
+  auto c = fl::order_checked<std::mutex>();
+  c.lock();
+  a.lock();
+  a.unlock();
+  c.unlock();
+}
+#endif // FL_DEBUG
+// NOLINTEND
\ No newline at end of file
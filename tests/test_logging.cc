@@ -1,11 +1,79 @@
-#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
 #include <gtest/gtest.h>
-#include <floppy/logging.h>
+#include <fl/logging.h>
+#include <spdlog/sinks/ostream_sink.h>
+#include <spdlog/spdlog.h>
 
-TEST(Logging, Simple)
+// NOLINTBEGIN
+namespace
+{
+  namespace log = fl::log;
+
+  struct captured
+  {
+    std::vector<std::string> messages;
+    std::vector<log::level> levels;
+    std::vector<std::chrono::system_clock::time_point> times;
+    std::vector<std::string> decoded;
+    std::vector<fl::u64> suppressed;
+    std::vector<std::vector<std::pair<std::string, log::field_value>>> fields;
+    std::deque<std::string> strings;
+    bool ordered = true;
+
+    auto sink() -> log::sink {
+      return [this](std::span<log::record const> records) {
+        for(auto i = std::size_t(0); i < records.size(); ++i) {
+          this->messages.emplace_back(records[i].message);
+          this->levels.push_back(records[i].severity);
+          this->times.push_back(records[i].time);
+          this->suppressed.push_back(records[i].suppressed);
+          auto& fields = this->fields.emplace_back();
+          log::visit_fields(records[i], [&](std::string_view key, log::field_value const& value) {
+            auto copy = value;
+            if(auto const* text = std::get_if<std::string_view>(&value))
+              copy = this->strings.emplace_back(*text);
+            fields.emplace_back(key, copy);
+          });
+          auto message = std::array<char, log::max_message_size>();
+          auto const& site = *records[i].site;
+          this->decoded.emplace_back(message.data(), site.decode(site.format, records[i].arguments, message));
+          if(i > 0 and records[i].time < records[i - 1].time)
+            this->ordered = false;
+        }
+      };
+    }
+  };
+
+  struct logging_test : testing::Test
+  {
+    captured output;
+
+    void SetUp() override {
+      log::set_sink(this->output.sink());
+      log::set_level(log::level::trace);
+    }
+
+    void TearDown() override {
+      log::stop_async();
+      log::set_sink({});
+      log::set_level(log::level::info);
+    }
+  };
+} // namespace
+
+TEST_F(logging_test, Simple)
 {
-  namespace log = floppy::log;
-  spdlog::set_level(spdlog::level::trace);
   auto str = std::string_view("Floppy");
   log::log(log::level::trace, "Hello, {}!", str);
   log::log(log::level::debug, "Hello, {}!", str);
@@ -17,4 +85,271 @@ TEST(Logging, Simple)
   log::info("Hello, {}!", str);
   log::debug("Hello, {}!", str);
   log::trace("Hello, {}!", str);
-}
\ No newline at end of file
+  auto const levels = { log::level::trace, log::level::debug, log::level::info, log::level::warn, log::level::err };
+  auto const compiled_in = 2 * std::ranges::count_if(levels, [](auto l) { return l >= log::compiled_level; });
+  ASSERT_EQ(output.messages.size(), compiled_in);
+  EXPECT_EQ(output.messages.front(), "Hello, Floppy!");
+  EXPECT_EQ(std::ranges::count(output.levels, log::level::err), 2);
+
+  log::set_level(log::level::warn);
+  log::info("filtered");
+  log::critical("kept {}", 1);
+  EXPECT_EQ(output.messages.back(), "kept 1");
+  EXPECT_EQ(output.messages.size(), compiled_in + 1);
+
+  log::info("{}", std::string(2 * log::max_message_size, 'x'));
+  EXPECT_EQ(output.messages.size(), compiled_in + 1);
+  log::warn("{}{}", std::string(2 * log::max_message_size, 'x'), 1);
+  EXPECT_EQ(output.messages.back().size(), log::max_argument_size - 2 * sizeof(fl::u32) + 1);
+  EXPECT_TRUE(output.messages.back().ends_with("...1"));
+  log::warn("{:>300}", 1);
+  EXPECT_EQ(output.messages.back().size(), log::max_message_size);
+  EXPECT_TRUE(output.messages.back().ends_with("..."));
+}
+
+TEST_F(logging_test, AsyncMergesThreadsByTime)
+{
+  constexpr auto threads = 4;
+  constexpr auto records = 2'000;
+  auto const before = log::statistics();
+  log::start_async({ .capacity = 256 });
+  {
+    auto workers = std::vector<std::jthread>();
+    for(auto t = 0; t < threads; ++t)
+      workers.emplace_back([t] {
+        for(auto i = 0; i < records; ++i)
+          log::info("thread {} record {}", t, i);
+      });
+  }
+  log::flush();
+  log::stop_async();
+  auto const after = log::statistics();
+  EXPECT_EQ(output.messages.size(), threads * records);
+  EXPECT_EQ(after.written - before.written, threads * records);
+  EXPECT_EQ(after.dropped_newest, before.dropped_newest);
+  EXPECT_EQ(after.dropped_oldest, before.dropped_oldest);
+  EXPECT_TRUE(output.ordered);
+}
+
+TEST_F(logging_test, DeferredFormattingCopiesArguments)
+{
+  log::start_async({ .flush_interval = std::chrono::hours(1) });
+  {
+    auto name = std::string("temporary");
+    char const* missing = nullptr;
+    log::info("{} {} {} {:.2f} {} {}", name, "literal", std::string_view("view"), 2.5, missing, 'c');
+  }
+  log::warn("no arguments");
+  log::flush();
+  ASSERT_EQ(output.messages.size(), 2);
+  EXPECT_EQ(output.messages[0], "temporary literal view 2.50  c");
+  EXPECT_EQ(output.messages[1], "no arguments");
+  EXPECT_EQ(output.decoded, output.messages);
+}
+
+TEST_F(logging_test, LongStringsAreShortened)
+{
+  auto const text = std::string(2 * log::max_argument_size, 'x');
+  log::info("{}|{}|{}", text, 42, text);
+  ASSERT_EQ(output.messages.size(), 1);
+  // the first string gets all space left by the fixed-size arguments
+  EXPECT_EQ(output.messages.front().size(), log::max_argument_size - 2 * sizeof(fl::u32) - sizeof(int) + 4);
+  EXPECT_TRUE(output.messages.front().ends_with("...|42|"));
+}
+
+TEST_F(logging_test, LazyArgumentsAreEvaluatedOnlyIfLogged)
+{
+  auto calls = 0;
+  auto const lazy = [&] { ++calls; return std::string("expensive"); };
+  log::set_level(log::level::info);
+  log::debug("{}", lazy);
+  log::log(log::level::debug, "{}", lazy);
+  EXPECT_EQ(calls, 0);
+  EXPECT_TRUE(output.messages.empty());
+
+  log::info("{} {}", lazy, [] { return 42; });
+  EXPECT_EQ(calls, 1);
+  ASSERT_EQ(output.messages.size(), 1);
+  EXPECT_EQ(output.messages.front(), "expensive 42");
+}
+
+TEST_F(logging_test, CallsBelowCompiledLevelAreRemoved)
+{
+  auto calls = 0;
+  log::trace("{}", [&] { return ++calls; });
+  if constexpr(log::compiled_level > log::level::trace) {
+    EXPECT_EQ(calls, 0);
+    EXPECT_TRUE(output.messages.empty());
+  } else {
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(output.messages.size(), 1);
+  }
+}
+
+TEST_F(logging_test, EveryNthCallIsLogged)
+{
+  for(auto i = 0; i < 10; ++i)
+    log::warn_every(4, "tick {}", i);
+  ASSERT_EQ(output.messages.size(), 3);
+  EXPECT_EQ(output.messages[0], "tick 0");
+  EXPECT_EQ(output.messages[1], "tick 4 [3 suppressed]");
+  EXPECT_EQ(output.messages[2], "tick 8 [3 suppressed]");
+  EXPECT_EQ(output.suppressed, (std::vector<fl::u64> { 0, 3, 3 }));
+}
+
+TEST_F(logging_test, EveryNthCallIsLoggedAcrossThreads)
+{
+  constexpr auto threads = 4;
+  constexpr auto calls = 10'000;
+  log::start_async({ .capacity = 256 });
+  {
+    auto workers = std::vector<std::jthread>();
+    for(auto t = 0; t < threads; ++t)
+      workers.emplace_back([] {
+        for(auto i = 0; i < calls; ++i)
+          log::log_every(log::level::info, 100, "hot path");
+      });
+  }
+  log::stop_async();
+  EXPECT_EQ(output.messages.size(), threads * calls / 100);
+}
+
+TEST_F(logging_test, OnceLogsFirstCall)
+{
+  auto evaluated = 0;
+  for(auto i = 0; i < 3; ++i)
+    log::once(log::level::warn, "deprecated option {}", [&] { return ++evaluated; });
+  ASSERT_EQ(output.messages.size(), 1);
+  EXPECT_EQ(output.messages.front(), "deprecated option 1");
+  EXPECT_EQ(evaluated, 1);
+}
+
+TEST_F(logging_test, RateLimitsBursts)
+{
+  constexpr auto calls = 1'000;
+  auto const fail = [] { log::info_rate(10, "request failed"); };
+  for(auto i = 0; i < calls; ++i)
+    fail();
+  auto const logged = output.messages.size();
+  EXPECT_GE(logged, 10);
+  EXPECT_LE(logged, 11);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  fail();
+  ASSERT_EQ(output.messages.size(), logged + 1);
+  EXPECT_EQ(output.suppressed.back(), calls - logged);
+  EXPECT_TRUE(output.messages.back().ends_with(" suppressed]"));
+}
+
+TEST_F(logging_test, StructuredFieldsFollowFormatArguments)
+{
+  enum class status : fl::u8 { ok = 3 };
+  log::start_async({ .flush_interval = std::chrono::hours(1) });
+  {
+    auto const path = std::string("/api/items");
+    log::info(
+      "request {} done",
+      7,
+      fl::kv("latency_us", 42),
+      fl::kv("bytes", fl::u64(512)),
+      fl::kv("path", path),
+      fl::kv("cached", true),
+      fl::kv("ratio", 0.5),
+      fl::kv("status", status::ok)
+    );
+  }
+  log::info("no fields");
+  log::flush();
+  ASSERT_EQ(output.messages.size(), 2);
+  EXPECT_EQ(output.messages[0], "request 7 done");
+  auto const& fields = output.fields[0];
+  ASSERT_EQ(fields.size(), 6);
+  EXPECT_EQ(fields[0], std::pair(std::string("latency_us"), log::field_value(fl::i64(42))));
+  EXPECT_EQ(fields[1], std::pair(std::string("bytes"), log::field_value(fl::u64(512))));
+  EXPECT_EQ(fields[2], std::pair(std::string("path"), log::field_value(std::string_view("/api/items"))));
+  EXPECT_EQ(fields[3], std::pair(std::string("cached"), log::field_value(true)));
+  EXPECT_EQ(fields[4], std::pair(std::string("ratio"), log::field_value(0.5)));
+  EXPECT_EQ(fields[5], std::pair(std::string("status"), log::field_value(fl::u64(3))));
+  EXPECT_TRUE(output.fields[1].empty());
+}
+
+TEST_F(logging_test, JsonLinesSinkWritesFields)
+{
+  auto* const file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+  log::set_sink(log::json_lines_sink(file));
+  log::info("request \"{}\" done", "quoted\n", fl::kv("latency_us", 42), fl::kv("ok", false), fl::kv("path", "/x"));
+  log::warn("plain");
+
+  std::rewind(file);
+  auto text = std::string(4'096, '\0');
+  text.resize(std::fread(text.data(), 1, text.size(), file));
+  std::fclose(file);
+  auto const first = text.substr(0, text.find('\n'));
+  EXPECT_TRUE(first.starts_with(R"({"time":)"));
+  EXPECT_NE(first.find(R"("level":"info")"), std::string::npos);
+  EXPECT_NE(first.find(R"("message":"request \"quoted\n\" done","latency_us":42,"ok":false,"path":"/x"})"), std::string::npos);
+  EXPECT_NE(text.find(R"("level":"warn")"), std::string::npos);
+  EXPECT_EQ(std::ranges::count(text, '\n'), 2);
+}
+
+TEST_F(logging_test, DefaultSinkAppendsFields)
+{
+  auto stream = std::ostringstream();
+  auto const previous = spdlog::default_logger();
+  auto const logger = std::make_shared<spdlog::logger>("test", std::make_shared<spdlog::sinks::ostream_sink_st>(stream));
+  logger->set_pattern("%v");
+  spdlog::set_default_logger(logger);
+  log::set_sink({});
+  log::info("request done", fl::kv("latency_us", 42), fl::kv("path", "/x"));
+  spdlog::set_default_logger(previous);
+  EXPECT_EQ(stream.str(), "request done latency_us=42 path=/x\n");
+}
+
+TEST_F(logging_test, FlushWritesRecordsOfThisThread)
+{
+  log::start_async({ .flush_interval = std::chrono::hours(1) });
+  log::info("first");
+  log::flush();
+  ASSERT_EQ(output.messages.size(), 1);
+  EXPECT_EQ(output.messages.front(), "first");
+}
+
+TEST_F(logging_test, OverflowDropNewest)
+{
+  auto const before = log::statistics();
+  log::start_async({ .capacity = 4, .overflow = log::overflow_policy::drop_newest, .flush_interval = std::chrono::hours(1) });
+  for(auto i = 0; i < 100; ++i)
+    log::info("record {}", i);
+  log::stop_async();
+  ASSERT_EQ(output.messages.size(), 4);
+  EXPECT_EQ(output.messages.front(), "record 0");
+  EXPECT_EQ(output.messages.back(), "record 3");
+  EXPECT_EQ(log::statistics().dropped_newest - before.dropped_newest, 96);
+}
+
+TEST_F(logging_test, OverflowDropOldest)
+{
+  auto const before = log::statistics();
+  log::start_async({ .capacity = 4, .overflow = log::overflow_policy::drop_oldest, .flush_interval = std::chrono::hours(1) });
+  for(auto i = 0; i < 100; ++i)
+    log::info("record {}", i);
+  log::stop_async();
+  ASSERT_EQ(output.messages.size(), 4);
+  EXPECT_EQ(output.messages.front(), "record 96");
+  EXPECT_EQ(output.messages.back(), "record 99");
+  EXPECT_EQ(log::statistics().dropped_oldest - before.dropped_oldest, 96);
+}
+
+TEST_F(logging_test, OverflowBlockLosesNothing)
+{
+  auto const before = log::statistics();
+  log::start_async({ .capacity = 4, .overflow = log::overflow_policy::block, .flush_interval = std::chrono::hours(1) });
+  for(auto i = 0; i < 1'000; ++i)
+    log::info("record {}", i);
+  log::stop_async();
+  ASSERT_EQ(output.messages.size(), 1'000);
+  EXPECT_EQ(output.messages.back(), "record 999");
+  EXPECT_GT(log::statistics().blocked, before.blocked);
+}
+// NOLINTEND
\ No newline at end of file
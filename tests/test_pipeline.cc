@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fl/threading/pipeline.h>
+
+// NOLINTBEGIN
+namespace
+{
+  auto counter(int count) {
+    return [i = 0, count]() mutable -> std::optional<int> {
+      if(i == count)
+        return std::nullopt;
+      return i++;
+    };
+  }
+} // namespace
+
+TEST(Pipeline, OrderedParallelStages)
+{
+  constexpr auto count = 10'000;
+  auto output = std::vector<std::string>();
+  auto p = fl::pipeline::from(counter(count), { .name = "source" })
+    .then([](int v) {
+      if(v % 7 == 0)
+        std::this_thread::yield();
+      return v * 2;
+    }, { .name = "double", .concurrency = 4, .ordered = true, .queue_capacity = 16 })
+    .then([](int v) -> std::optional<int> {
+      if(v % 3 == 0)
+        return std::nullopt;
+      return v;
+    }, { .name = "filter", .concurrency = 3, .ordered = true })
+    .then([](int v) { return std::to_string(v); }, { .name = "format", .concurrency = 2, .ordered = true })
+    .to([&](std::string&& s) { output.push_back(std::move(s)); }, { .name = "sink", .ordered = true });
+  p.run();
+
+  auto expected = std::vector<std::string>();
+  for(auto i = 0; i < count; ++i)
+    if((i * 2) % 3 != 0)
+      expected.push_back(std::to_string(i * 2));
+  EXPECT_EQ(output, expected);
+
+  auto const stats = p.statistics();
+  ASSERT_EQ(stats.size(), 5);
+  EXPECT_EQ(stats[0].name, "source");
+  EXPECT_EQ(stats[0].processed, count);
+  EXPECT_EQ(stats[1].name, "double");
+  EXPECT_EQ(stats[1].concurrency, 4);
+  EXPECT_EQ(stats[1].queue_capacity, 16);
+  EXPECT_EQ(stats[1].processed, count);
+  EXPECT_EQ(stats[2].processed, count);
+  EXPECT_EQ(stats[3].processed, expected.size());
+  EXPECT_EQ(stats[4].processed, expected.size());
+  for(auto const& s : stats) {
+    EXPECT_EQ(s.queue_depth, 0);
+    EXPECT_GT(s.throughput, 0.0);
+  }
+}
+
+TEST(Pipeline, UnorderedParallelSink)
+{
+  constexpr auto count = 20'000;
+  auto sum = std::atomic<long long>(0);
+  auto p = fl::pipeline::from(counter(count))
+    .then([](int v) { return static_cast<long long>(v); }, { .concurrency = 3 })
+    .to([&](long long v) { sum += v; }, { .concurrency = 2 });
+  p.run();
+  EXPECT_EQ(sum.load(), static_cast<long long>(count) * (count - 1) / 2);
+}
+
+TEST(Pipeline, Backpressure)
+{
+  constexpr auto count = 200;
+  auto max_in_flight = 0;
+  auto produced = std::atomic<int>(0);
+  auto consumed = std::atomic<int>(0);
+  auto p = fl::pipeline::from([&, source = counter(count)]() mutable {
+      max_in_flight = std::max(max_in_flight, produced.load() - consumed.load());
+      ++produced;
+      return source();
+    }, { .name = "source" })
+    .to([&](int) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      ++consumed;
+    }, { .name = "slow sink", .queue_capacity = 8 });
+  p.run();
+  EXPECT_EQ(consumed.load(), count);
+  // queue capacity, plus one item being consumed and one being pushed
+  EXPECT_LE(max_in_flight, 8 + 2);
+  auto const stats = p.statistics();
+  EXPECT_GT(stats[0].stalled, stats[0].busy);
+  EXPECT_GT(stats[1].busy, std::chrono::milliseconds(count / 10));
+}
+
+TEST(Pipeline, SlowHeadItemBoundsOrderedStage)
+{
+  constexpr auto count = 2'000;
+  auto produced = std::atomic<int>(0);
+  auto produced_while_stuck = 0;
+  auto output = std::vector<int>();
+  auto p = fl::pipeline::from([&, source = counter(count)]() mutable {
+      ++produced;
+      return source();
+    }, { .name = "source" })
+    .then([&](int v) {
+      if(v == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        produced_while_stuck = produced.load();
+      }
+      return v;
+    }, { .name = "ordered", .concurrency = 4, .ordered = true, .queue_capacity = 16 })
+    .to([&](int v) { output.push_back(v); }, { .name = "sink", .queue_capacity = 16 });
+  p.run();
+  ASSERT_EQ(output.size(), count);
+  EXPECT_TRUE(std::ranges::is_sorted(output));
+  // input queue and reorder window of the ordered stage, items held by the three waiting workers
+  // and one item being pushed by the source
+  EXPECT_LE(produced_while_stuck, 16 + 16 + 3 + 1);
+}
+
+TEST(Pipeline, CancelWhileOrderedStageIsBlockedDownstream)
+{
+  auto consumed = std::atomic<int>(0);
+  auto p = fl::pipeline::from([i = 0]() mutable -> std::optional<int> { return i++; })
+    .then([](int v) { return v; }, { .concurrency = 4, .ordered = true, .queue_capacity = 4 })
+    .to([&](int) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      ++consumed;
+    }, { .queue_capacity = 2 });
+  p.start();
+  while(consumed.load() < 2)
+    std::this_thread::yield();
+  // the ordered stage is now blocked pushing into the full queue of the sink
+  p.cancel();
+  p.wait();
+  EXPECT_LT(consumed.load(), 10);
+}
+
+TEST(Pipeline, ExceptionWhileOrderedStageIsBlockedDownstream)
+{
+  auto consumed = 0;
+  auto p = fl::pipeline::from([i = 0]() mutable -> std::optional<int> { return i++; })
+    .then([](int v) { return v; }, { .concurrency = 4, .ordered = true, .queue_capacity = 4 })
+    .to([&](int) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      if(++consumed == 3)
+        throw std::runtime_error("slow sink failed");
+    }, { .queue_capacity = 2 });
+  EXPECT_THROW(p.run(), std::runtime_error);
+  EXPECT_EQ(consumed, 3);
+}
+
+TEST(Pipeline, ExceptionCancelsAndPropagates)
+{
+  auto consumed = std::atomic<int>(0);
+  auto p = fl::pipeline::from(counter(1'000'000))
+    .then([](int v) {
+      if(v == 100)
+        throw std::runtime_error("bad item");
+      return v;
+    }, { .concurrency = 2 })
+    .to([&](int) { ++consumed; });
+  EXPECT_THROW(p.run(), std::runtime_error);
+  EXPECT_LT(consumed.load(), 1'000'000);
+}
+
+TEST(Pipeline, CancelStopsInfiniteSource)
+{
+  auto consumed = std::atomic<int>(0);
+  auto p = fl::pipeline::from([]() -> std::optional<int> { return 1; })
+    .to([&](int v) { consumed += v; });
+  p.start();
+  while(consumed.load() < 1000)
+    std::this_thread::yield();
+  p.cancel();
+  p.wait();
+  EXPECT_GE(consumed.load(), 1000);
+}
+// NOLINTEND
\ No newline at end of file
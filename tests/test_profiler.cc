@@ -0,0 +1,69 @@
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include <fl/profiler.h>
+
+// NOLINTBEGIN
+namespace
+{
+  [[gnu::noinline]] auto burn_cpu(std::chrono::milliseconds duration) -> double {
+    auto volatile sum = 0.0;
+    auto const until = std::chrono::steady_clock::now() + duration;
+    while(std::chrono::steady_clock::now() < until)
+      for(auto i = 0; i < 1'000; ++i)
+        sum = sum + i * 0.5;
+    return sum;
+  }
+} // namespace
+
+TEST(Profiler, RecordsFoldedStacks)
+{
+  auto profiler = fl::profiler({ .frequency = 1'000 });
+  EXPECT_FALSE(profiler.running());
+  profiler.start();
+  EXPECT_TRUE(profiler.running());
+  burn_cpu(std::chrono::milliseconds(300));
+  profiler.stop();
+  EXPECT_FALSE(profiler.running());
+  EXPECT_GT(profiler.samples(), 10);
+  EXPECT_EQ(profiler.dropped(), 0);
+
+  auto const folded = profiler.folded();
+  auto lines = std::istringstream(folded);
+  auto line = std::string();
+  auto total = fl::u64(0);
+  while(std::getline(lines, line)) {
+    auto const space = line.rfind(' ');
+    ASSERT_NE(space, std::string::npos) << line;
+    total += std::stoull(line.substr(space + 1));
+  }
+  EXPECT_EQ(total, profiler.samples());
+  #if defined(FL_FRAME_POINTERS)
+  EXPECT_NE(folded.find("burn_cpu"), std::string::npos) << folded;
+  #endif
+}
+
+TEST(Profiler, OnlyOneRunsAtATime)
+{
+  auto first = fl::profiler();
+  auto second = fl::profiler();
+  first.start();
+  EXPECT_THROW(second.start(), std::runtime_error);
+  first.stop();
+  EXPECT_NO_THROW(second.start());
+  second.stop();
+  EXPECT_EQ(first.folded(), "");
+}
+
+TEST(Profiler, CountsDroppedSamples)
+{
+  auto profiler = fl::profiler({ .frequency = 1'000, .max_threads = 1, .buffer_size = 8 });
+  profiler.start();
+  burn_cpu(std::chrono::milliseconds(200));
+  profiler.stop();
+  EXPECT_GT(profiler.dropped(), 0);
+  EXPECT_LE(profiler.samples(), 8);
+}
+// NOLINTEND
\ No newline at end of file
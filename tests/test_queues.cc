@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fl/threading/blocking_queue.h>
+#include <fl/threading/mpmc_queue.h>
+#include <fl/threading/spsc_queue.h>
+
+// NOLINTBEGIN
+TEST(SpscQueue, PushPop)
+{
+  auto queue = fl::spsc_queue<std::string>(3);
+  EXPECT_EQ(queue.capacity(), 4);
+  EXPECT_TRUE(queue.empty());
+  for(auto i = 0; i < 4; ++i)
+    EXPECT_TRUE(queue.try_push(std::to_string(i)));
+  EXPECT_FALSE(queue.try_push("overflow"));
+  EXPECT_EQ(queue.size(), 4);
+  for(auto i = 0; i < 4; ++i)
+    EXPECT_EQ(queue.try_pop(), std::to_string(i));
+  EXPECT_EQ(queue.try_pop(), std::nullopt);
+}
+
+TEST(SpscQueue, Batch)
+{
+  auto queue = fl::spsc_queue<std::unique_ptr<int>>(8);
+  auto values = std::vector<std::unique_ptr<int>>();
+  for(auto i = 0; i < 10; ++i)
+    values.push_back(std::make_unique<int>(i));
+  EXPECT_EQ(queue.try_push_n(values), 8);
+  EXPECT_EQ(values[0], nullptr);
+  EXPECT_NE(values[8], nullptr);
+
+  auto out = std::vector<std::unique_ptr<int>>();
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(out), 5), 5);
+  EXPECT_EQ(queue.try_push_n(std::span(values).subspan(8)), 2);
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(out), 100), 5);
+  ASSERT_EQ(out.size(), 10);
+  for(auto i = 0; i < 10; ++i)
+    EXPECT_EQ(*out[i], i);
+}
+
+TEST(SpscQueue, DestroysRemainingElements)
+{
+  auto const value = std::make_shared<int>(42);
+  {
+    auto queue = fl::spsc_queue<std::shared_ptr<int>>(4);
+    queue.try_push(value);
+    queue.try_push(value);
+    EXPECT_EQ(value.use_count(), 3);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(SpscQueue, Concurrent)
+{
+  constexpr auto count = 200'000;
+  auto queue = fl::spsc_queue<int>(64);
+  auto producer = std::jthread([&] {
+    for(auto i = 0; i < count; ++i)
+      while(not queue.try_push(i))
+        std::this_thread::yield();
+  });
+  for(auto expected = 0; expected < count;) {
+    if(auto const v = queue.try_pop()) {
+      ASSERT_EQ(*v, expected);
+      ++expected;
+    } else
+      std::this_thread::yield();
+  }
+}
+
+TEST(MpmcQueue, PushPop)
+{
+  auto queue = fl::mpmc_queue<std::string>(2);
+  EXPECT_TRUE(queue.try_push("a"));
+  EXPECT_TRUE(queue.try_emplace(3, 'b'));
+  EXPECT_FALSE(queue.try_push("c"));
+  EXPECT_EQ(queue.try_pop(), "a");
+  EXPECT_TRUE(queue.try_push("c"));
+  EXPECT_EQ(queue.try_pop(), "bbb");
+  EXPECT_EQ(queue.try_pop(), "c");
+  EXPECT_EQ(queue.try_pop(), std::nullopt);
+}
+
+TEST(MpmcQueue, Batch)
+{
+  auto queue = fl::mpmc_queue<int>(4);
+  auto values = std::vector { 1, 2, 3, 4, 5, 6 };
+  EXPECT_EQ(queue.try_push_n(values), 4);
+  auto out = std::vector<int>();
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(out), 3), 3);
+  EXPECT_EQ(queue.try_push_n(std::span(values).subspan(4)), 2);
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(out), 10), 3);
+  EXPECT_EQ(out, values);
+}
+
+TEST(MpmcQueue, Concurrent)
+{
+  constexpr auto producers = 4;
+  constexpr auto consumers = 4;
+  constexpr auto per_producer = 50'000;
+  auto queue = fl::mpmc_queue<int>(128);
+  auto sum = std::atomic<long long>(0);
+  auto received = std::atomic<int>(0);
+  {
+    auto threads = std::vector<std::jthread>();
+    for(auto p = 0; p < producers; ++p)
+      threads.emplace_back([&, p] {
+        auto batch = std::vector<int>();
+        for(auto i = 0; i < per_producer; ++i) {
+          auto const value = p * per_producer + i;
+          if(i % 2 == 0) {
+            while(not queue.try_push(value))
+              std::this_thread::yield();
+          } else {
+            batch.push_back(value);
+            if(batch.size() == 8 or i == per_producer - 1) {
+              auto pending = std::span(batch);
+              while(not pending.empty()) {
+                pending = pending.subspan(queue.try_push_n(pending));
+                std::this_thread::yield();
+              }
+              batch.clear();
+            }
+          }
+        }
+      });
+    for(auto c = 0; c < consumers; ++c)
+      threads.emplace_back([&, c] {
+        auto out = std::vector<int>();
+        while(received.load() < producers * per_producer) {
+          out.clear();
+          if(c % 2 == 0)
+            queue.try_pop_n(std::back_inserter(out), 16);
+          else if(auto const v = queue.try_pop())
+            out.push_back(*v);
+          auto const count = out.size();
+          if(count == 0) {
+            std::this_thread::yield();
+            continue;
+          }
+          sum += std::accumulate(out.begin(), out.end(), 0LL);
+          received += static_cast<int>(count);
+        }
+      });
+  }
+  constexpr auto total = static_cast<long long>(producers) * per_producer;
+  EXPECT_EQ(received.load(), total);
+  EXPECT_EQ(sum.load(), total * (total - 1) / 2);
+}
+
+TEST(BlockingQueue, CloseDrains)
+{
+  auto queue = fl::blocking_mpmc_queue<int>(4);
+  EXPECT_TRUE(queue.push(1));
+  EXPECT_TRUE(queue.push(2));
+  queue.close();
+  EXPECT_FALSE(queue.push(3));
+  EXPECT_EQ(queue.pop(), 1);
+  EXPECT_EQ(queue.pop(), 2);
+  EXPECT_EQ(queue.pop(), std::nullopt);
+}
+
+TEST(BlockingQueue, CloseWakesBlockedConsumers)
+{
+  auto queue = fl::blocking_mpmc_queue<int>(4);
+  auto results = std::vector<std::optional<int>>(3, 0);
+  {
+    auto threads = std::vector<std::jthread>();
+    for(auto i = 0; i < 3; ++i)
+      threads.emplace_back([&, i] { results[i] = queue.pop(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.close();
+  }
+  for(auto const& r : results)
+    EXPECT_EQ(r, std::nullopt);
+}
+
+TEST(BlockingQueue, ProducerBlocksWhileFull)
+{
+  constexpr auto count = 100'000;
+  auto queue = fl::blocking_spsc_queue<int>(2);
+  auto producer = std::jthread([&] {
+    auto batch = std::vector<int>();
+    for(auto i = 0; i < count; ++i) {
+      if(i % 3 == 0)
+        batch.push_back(i);
+      else {
+        if(not batch.empty()) {
+          ASSERT_EQ(queue.push_n(batch), batch.size());
+        }
+        batch.clear();
+        ASSERT_TRUE(queue.push(i));
+      }
+    }
+    queue.push_n(batch);
+    queue.close();
+  });
+  auto expected = 0;
+  auto out = std::vector<int>();
+  while(true) {
+    out.clear();
+    if(queue.pop_n(std::back_inserter(out), 3) == 0)
+      break;
+    for(auto const v : out)
+      ASSERT_EQ(v, expected++);
+  }
+  EXPECT_EQ(expected, count);
+}
+
+TEST(BlockingQueue, ManyToMany)
+{
+  constexpr auto threads = 4;
+  constexpr auto per_thread = 20'000;
+  auto queue = fl::blocking_mpmc_queue<int>(16);
+  auto sum = std::atomic<long long>(0);
+  {
+    auto consumers = std::vector<std::jthread>();
+    for(auto c = 0; c < threads; ++c)
+      consumers.emplace_back([&] {
+        while(auto const v = queue.pop())
+          sum += *v;
+      });
+    {
+      auto producers = std::vector<std::jthread>();
+      for(auto p = 0; p < threads; ++p)
+        producers.emplace_back([&, p] {
+          for(auto i = 0; i < per_thread; ++i)
+            queue.push(p * per_thread + i);
+        });
+    }
+    queue.close();
+  }
+  constexpr auto total = static_cast<long long>(threads) * per_thread;
+  EXPECT_EQ(sum.load(), total * (total - 1) / 2);
+}
+// NOLINTEND
\ No newline at end of file
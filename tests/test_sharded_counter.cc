@@ -0,0 +1,48 @@
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fl/threading/sharded_counter.h>
+
+// NOLINTBEGIN
+TEST(ShardedCounter, SingleThread)
+{
+  auto counter = fl::sharded_counter(3);
+  EXPECT_EQ(counter.slots(), 4);
+  counter.increment();
+  counter.add(41);
+  EXPECT_EQ(counter.value(), 42);
+  EXPECT_EQ(counter.exchange_zero(), 42);
+  EXPECT_EQ(counter.value(), 0);
+}
+
+TEST(ShardedCounter, Gauge)
+{
+  auto gauge = fl::sharded_gauge();
+  gauge.increment();
+  gauge.increment();
+  gauge.decrement();
+  gauge.sub(5);
+  EXPECT_EQ(gauge.value(), -4);
+}
+
+TEST(ShardedCounter, ConcurrentIncrements)
+{
+  constexpr auto threads = 16;
+  constexpr auto iterations = 100'000;
+  auto counter = fl::sharded_counter(4);
+  auto gauge = fl::sharded_gauge(4);
+  {
+    auto workers = std::vector<std::jthread>();
+    for(auto t = 0; t < threads; ++t)
+      workers.emplace_back([&] {
+        for(auto i = 0; i < iterations; ++i) {
+          counter.increment();
+          gauge.increment();
+          gauge.decrement();
+        }
+      });
+  }
+  EXPECT_EQ(counter.value(), fl::u64(threads) * iterations);
+  EXPECT_EQ(gauge.value(), 0);
+}
+// NOLINTEND
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include <string>
+#include <tuple>
+#include <vector>
+#include <dlfcn.h>
+#include <gtest/gtest.h>
+#include <fl/contracts.h>
+#include <fl/platform/stacktrace.h>
+
+// NOLINTBEGIN
+namespace
+{
+  [[gnu::noinline]] auto capture_nested(int depth) -> fl::platform::raw_stacktrace {
+    if(depth == 0)
+      return fl::platform::raw_stacktrace::capture();
+    auto result = capture_nested(depth - 1);
+    asm volatile("" ::: "memory"); // prevent tail calls
+    return result;
+  }
+} // namespace
+
+TEST(Stacktrace, CaptureReturnsCallerFrames)
+{
+  auto const shallow = fl::platform::raw_stacktrace::capture();
+  auto const deep = capture_nested(8);
+  ASSERT_FALSE(shallow.empty());
+  EXPECT_GE(deep.size(), shallow.size() + 8);
+  EXPECT_LE(deep.size(), fl::platform::raw_stacktrace::capacity);
+
+  auto const skipped = fl::platform::raw_stacktrace::capture(1);
+  EXPECT_EQ(skipped.size() + 1, shallow.size());
+}
+
+TEST(Stacktrace, ModuleMapFindsBuildId)
+{
+  auto const map = fl::platform::module_map::capture();
+  ASSERT_FALSE(map.modules().empty());
+  auto const trace = fl::platform::raw_stacktrace::capture();
+  auto const* const module = map.find(trace.frames().front());
+  ASSERT_NE(module, nullptr);
+  EXPECT_FALSE(module->path.empty());
+  EXPECT_TRUE(module->contains(trace.frames().front()));
+  EXPECT_LT(module->file_address(trace.frames().front()), trace.frames().front() + 1);
+  EXPECT_EQ(map.find(0), nullptr);
+
+  if(not module->id.empty()) {
+    auto const parsed = fl::platform::build_id::parse(module->id.to_string());
+    ASSERT_TRUE(parsed.has_value());
+    EXPECT_EQ(*parsed, module->id);
+  }
+}
+
+TEST(Stacktrace, BuildIdParse)
+{
+  auto const id = fl::platform::build_id::parse("00ff10Ab");
+  ASSERT_TRUE(id.has_value());
+  EXPECT_EQ(id->size, 4);
+  EXPECT_EQ(id->to_string(), "00ff10ab");
+  EXPECT_FALSE(fl::platform::build_id::parse("abc").has_value());
+  EXPECT_FALSE(fl::platform::build_id::parse("zz").has_value());
+  EXPECT_FALSE(fl::platform::build_id::parse("").has_value());
+}
+
+TEST(Stacktrace, SymbolizeKeepsAddresses)
+{
+  auto const trace = capture_nested(2);
+  auto const symbolized = fl::platform::symbolize_async(trace).get();
+  ASSERT_EQ(symbolized.size(), trace.size());
+  for(auto i = std::size_t(0); i < trace.size(); ++i)
+    EXPECT_EQ(symbolized[i].address, trace.frames()[i]);
+  EXPECT_NE(fl::platform::to_string(symbolized).find("#0 "), std::string::npos);
+}
+
+TEST(Stacktrace, SymbolizerCachesAddresses)
+{
+  auto symbolizer = fl::platform::symbolizer();
+  auto const trace = capture_nested(3);
+  auto const first = symbolizer.symbolize(trace);
+  auto const after_first = symbolizer.statistics();
+  EXPECT_EQ(after_first.hits + after_first.misses, trace.size());
+  EXPECT_GT(after_first.misses, 0);
+
+  auto const second = symbolizer.symbolize(trace);
+  auto const after_second = symbolizer.statistics();
+  EXPECT_EQ(after_second.misses, after_first.misses);
+  EXPECT_EQ(after_second.hits, after_first.hits + trace.size());
+  ASSERT_EQ(first.size(), second.size());
+  for(auto i = std::size_t(0); i < first.size(); ++i) {
+    EXPECT_EQ(first[i].address, second[i].address);
+    EXPECT_EQ(first[i].function, second[i].function);
+    EXPECT_EQ(first[i].line, second[i].line);
+  }
+}
+
+TEST(Stacktrace, SymbolizerWarmUpAndBound)
+{
+  auto symbolizer = fl::platform::symbolizer(64);
+  auto const trace = capture_nested(2);
+  symbolizer.warm_up(trace.frames());
+  auto const warmed = symbolizer.statistics();
+  std::ignore = symbolizer.symbolize(trace);
+  EXPECT_EQ(symbolizer.statistics().misses, warmed.misses);
+
+  auto addresses = std::vector<fl::uptr>();
+  for(auto i = 0; i < 1000; ++i)
+    addresses.push_back(trace.frames().front() + static_cast<fl::uptr>(i));
+  symbolizer.warm_up(addresses);
+  EXPECT_LE(symbolizer.statistics().size, 64);
+  EXPECT_EQ(symbolizer.statistics().capacity, 64);
+}
+
+TEST(Stacktrace, SymbolizerRefreshesOnDlopen)
+{
+  auto symbolizer = fl::platform::symbolizer();
+  auto const trace = capture_nested(1);
+  std::ignore = symbolizer.symbolize(trace);
+  auto* const handle = ::dlopen("libresolv.so.2", RTLD_NOW | RTLD_LOCAL);
+  if(handle == nullptr)
+    GTEST_SKIP() << "no library to load";
+  std::ignore = symbolizer.symbolize(trace);
+  EXPECT_GE(symbolizer.statistics().refreshes, 1);
+  ::dlclose(handle);
+}
+
+TEST(Stacktrace, SymbolizeOfflineKeepsRecordOrder)
+{
+  auto const trace = capture_nested(3);
+  auto const records = fl::platform::module_addresses(trace, fl::platform::module_map::capture());
+  ASSERT_EQ(records.size(), trace.size());
+  EXPECT_FALSE(records.front().path.empty());
+  EXPECT_LT(records.front().address, trace.frames().front() + 1);
+
+  // interleave records of different modules, with duplicates
+  auto shuffled = std::vector<fl::platform::module_address>(records.rbegin(), records.rend());
+  shuffled.insert(shuffled.end(), records.begin(), records.end());
+  shuffled.push_back({ .address = 0x1234 });
+  auto const symbolized = fl::platform::symbolize_offline(shuffled);
+  ASSERT_EQ(symbolized.size(), shuffled.size());
+  for(auto i = std::size_t(0); i < shuffled.size(); ++i)
+    EXPECT_EQ(symbolized[i].address, shuffled[i].address);
+  EXPECT_EQ(symbolized[records.size()].module, records.front().path);
+  EXPECT_TRUE(symbolized.back().module.empty());
+}
+
+TEST(Stacktrace, ContractViolationCarriesFrames)
+{
+  auto frames = std::size_t(0);
+  auto const old = fl::contracts::set_violation_handler([&](fl::contracts::contract_violation const& v) {
+    frames = v.frames.size();
+    throw std::runtime_error("");
+  });
+  EXPECT_THROW(fl::contracts::detail::violate(fl::contracts::contract_type::invariant, "x"), std::runtime_error);
+  EXPECT_GT(frames, 1);
+  fl::contracts::set_violation_handler(old);
+}
+// NOLINTEND
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fl/threading/timer_wheel.h>
+
+// NOLINTBEGIN
+TEST(TimerWheel, FiresAfterDelay)
+{
+  auto wheel = fl::timer_wheel<>();
+  auto fired = 0;
+  wheel.schedule(10, [&fired] { ++fired; });
+  EXPECT_EQ(wheel.advance(9), 0);
+  EXPECT_EQ(fired, 0);
+  EXPECT_EQ(wheel.tick(), 1);
+  EXPECT_EQ(fired, 1);
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheel, Cancel)
+{
+  auto wheel = fl::timer_wheel<>();
+  auto fired = 0;
+  auto const id = wheel.schedule(300, [&fired] { ++fired; });
+  EXPECT_TRUE(wheel.pending(id));
+  EXPECT_TRUE(wheel.cancel(id));
+  EXPECT_FALSE(wheel.cancel(id));
+  wheel.advance(1000);
+  EXPECT_EQ(fired, 0);
+
+  // stale handle must not cancel a timer that reused the node
+  auto const reused = wheel.schedule(5, [&fired] { ++fired; });
+  EXPECT_EQ(reused.index, id.index);
+  EXPECT_FALSE(wheel.cancel(id));
+  wheel.advance(5);
+  EXPECT_EQ(fired, 1);
+}
+
+TEST(TimerWheel, MatchesReferenceAcrossLevels)
+{
+  auto wheel = fl::timer_wheel<>(10'000);
+  auto rng = std::mt19937_64(42);
+  auto expected = std::vector<fl::u64>();
+  auto actual = std::vector<std::pair<fl::u64, fl::u64>>();
+  for(auto i = 0; i < 5000; ++i) {
+    auto const delay = std::uniform_int_distribution<fl::u64>(1, i % 10 == 0 ? 200'000 : 1'000)(rng);
+    expected.push_back(delay);
+    wheel.schedule(delay, [&actual, &wheel, delay] { actual.emplace_back(delay, wheel.now()); });
+  }
+  wheel.advance(200'001);
+  ASSERT_EQ(actual.size(), expected.size());
+  for(auto const& [delay, fired_at] : actual)
+    EXPECT_EQ(delay, fired_at);
+}
+
+TEST(TimerWheel, FarFutureTimer)
+{
+  auto wheel = fl::timer_wheel<>();
+  auto fired = false;
+  auto const id = wheel.schedule(fl::u64(1) << 40U, [&fired] { fired = true; });
+  wheel.advance(1'000'000);
+  EXPECT_FALSE(fired);
+  EXPECT_TRUE(wheel.pending(id));
+}
+
+TEST(TimerWheel, CallbackCanReschedule)
+{
+  auto wheel = fl::timer_wheel<>();
+  auto count = 0;
+  auto self = std::function<void()>();
+  self = [&] {
+    if(++count < 5)
+      wheel.schedule(3, [&self] { self(); });
+  };
+  wheel.schedule(3, [&self] { self(); });
+  wheel.advance(100);
+  EXPECT_EQ(count, 5);
+}
+
+TEST(TimerWheel, ConcurrentFrontEnd)
+{
+  auto executed = std::atomic<int>(0);
+  auto handed = std::atomic<int>(0);
+  {
+    auto timers = fl::concurrent_timer_wheel<>(
+      std::chrono::microseconds(200),
+      [&handed](fl::concurrent_timer_wheel<>::callback_type&& callback) {
+        handed.fetch_add(1);
+        callback();
+      }
+    );
+    auto threads = std::vector<std::jthread>();
+    for(auto t = 0; t < 4; ++t)
+      threads.emplace_back([&] {
+        for(auto i = 0; i < 250; ++i) {
+          auto const id = timers.schedule(std::chrono::milliseconds(1 + i % 5), [&executed] { executed.fetch_add(1); });
+          if(i % 2 == 1)
+            timers.cancel(id);
+        }
+      });
+    threads.clear();
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while(executed.load() < 500 and std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(executed.load(), 500);
+  EXPECT_EQ(handed.load(), 500);
+}
+
+TEST(TimerWheel, ConcurrentNegativeDelayFiresImmediately)
+{
+  auto executed = std::atomic<int>(0);
+  auto timers = fl::concurrent_timer_wheel<>(
+    std::chrono::milliseconds(1),
+    [](fl::concurrent_timer_wheel<>::callback_type&& callback) { callback(); }
+  );
+  timers.schedule(-std::chrono::seconds(1), [&executed] { executed.fetch_add(1); });
+  timers.schedule(std::chrono::nanoseconds::min(), [&executed] { executed.fetch_add(1); });
+  auto const never = timers.schedule(std::chrono::nanoseconds::max(), [&executed] { executed.fetch_add(1); });
+  auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while(executed.load() < 2 and std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_EQ(executed.load(), 2);
+  EXPECT_TRUE(timers.cancel(never));
+}
+// NOLINTEND
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+#include <gtest/gtest.h>
+#include <fl/platform/topology.h>
+
+// NOLINTBEGIN
+namespace
+{
+  namespace fs = std::filesystem;
+
+  void write(fs::path const& path, std::string_view content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path) << content << '\n';
+  }
+
+  /// Two packages, two cores per package, two hyper-threads per core. Package is the parity of the CPU
+  /// id, so siblings are CPUs 0 and 2, 4 and 6, 1 and 3, 5 and 7. Node 1 is listed as node2 in sysfs.
+  auto make_fake_sysfs() -> fs::path {
+    auto const root = fs::temp_directory_path() / "floppy-test-sysfs";
+    fs::remove_all(root);
+    write(root / "cpu" / "online", "0-7");
+    for(auto cpu = 0; cpu < 8; ++cpu) {
+      auto const dir = root / "cpu" / ("cpu" + std::to_string(cpu)) / "topology";
+      write(dir / "core_id", std::to_string(cpu / 4));
+      write(dir / "physical_package_id", std::to_string(cpu % 2));
+    }
+    write(root / "node" / "node0" / "cpulist", "0,2,4,6");
+    write(root / "node" / "node2" / "cpulist", "1,3,5,7");
+    return root;
+  }
+} // namespace
+
+TEST(Topology, FromSysfs)
+{
+  auto const topo = fl::platform::topology::from_sysfs(make_fake_sysfs());
+  EXPECT_EQ(topo.cpus().size(), 8);
+  EXPECT_EQ(topo.packages(), 2);
+  EXPECT_EQ(topo.cores(), 4);
+  EXPECT_EQ(topo.numa_nodes(), 2);
+  EXPECT_EQ(topo.cpus()[5].numa_node, 1);
+  EXPECT_EQ(topo.cpus()[5].package, 1);
+
+  // distinct cores come before hyper-threading siblings, even siblings with lower ids
+  auto const node0 = topo.cpus_of_node(0);
+  ASSERT_EQ(node0.size(), 4);
+  EXPECT_EQ(node0[0], 0);
+  EXPECT_EQ(node0[1], 4);
+  EXPECT_EQ(node0[2], 2);
+  EXPECT_EQ(node0[3], 6);
+}
+
+TEST(Topology, PlaceWorkers)
+{
+  auto const topo = fl::platform::topology::from_sysfs(make_fake_sysfs());
+  auto const workers = topo.place_workers(6);
+  ASSERT_EQ(workers.size(), 6);
+  EXPECT_EQ(workers[0].numa_node, 0);
+  EXPECT_EQ(workers[1].numa_node, 1);
+  EXPECT_EQ(workers[4].numa_node, 0);
+  EXPECT_EQ(workers[4].local_index, 2);
+  auto cpus = std::set<fl::usize>();
+  for(auto const& w : workers) {
+    EXPECT_EQ(topo.cpus()[w.cpu].numa_node, w.numa_node);
+    cpus.insert(w.cpu);
+  }
+  EXPECT_EQ(cpus.size(), 6);
+}
+
+TEST(Topology, MissingSysfsThrows)
+{
+  EXPECT_THROW(static_cast<void>(fl::platform::topology::from_sysfs("/nonexistent")), std::runtime_error);
+}
+
+TEST(Topology, CurrentMachine)
+{
+  auto const& topo = fl::platform::topology::current();
+  EXPECT_GE(topo.cpus().size(), 1);
+  EXPECT_GE(topo.numa_nodes(), 1);
+}
+
+TEST(Topology, PinAndName)
+{
+  auto const& topo = fl::platform::topology::current();
+  auto const cpu = topo.cpus().front().id;
+  auto done = std::atomic<bool>(false);
+  auto t = std::jthread([cpu, &done] {
+    EXPECT_TRUE(fl::platform::set_current_thread_name("floppy-worker-with-long-name"));
+    if(fl::platform::pin_current_thread(cpu)) {
+      EXPECT_EQ(fl::platform::current_cpu(), cpu);
+    }
+    while(not done.load())
+      std::this_thread::yield();
+  });
+  EXPECT_TRUE(fl::platform::set_thread_name(t, "floppy-worker"));
+  static_cast<void>(fl::platform::pin_thread(t, cpu));
+  done.store(true);
+}
+// NOLINTEND
\ No newline at end of file